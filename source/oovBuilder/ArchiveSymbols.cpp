@@ -0,0 +1,261 @@
+/*
+ * ArchiveSymbols.cpp
+ *
+ *  \copyright 2016 DCBlaha.  Distributed under the GPL.
+ */
+
+#include "ArchiveSymbols.h"
+#include <string.h>
+#include <stdlib.h>     // For strtoul
+#include <stdint.h>
+
+
+/// Reads the values of an ELF file, where the byte order and the sizes of
+/// some values depend on the ELF class.
+class ElfReader
+    {
+    public:
+        ElfReader(unsigned char const *data, size_t size):
+            mData(data), mSize(size), mBigEndian(false), m64(false),
+            mValid(true)
+            {}
+        bool init();
+        bool isValid() const
+            { return mValid; }
+        void setInvalid()
+            { mValid = false; }
+        bool is64() const
+            { return m64; }
+        /// Read an unsigned value. If the value is outside of the file, this
+        /// returns 0 and the reader is no longer valid.
+        uint64_t read(size_t offset, size_t numBytes);
+        /// Read a value that is 4 bytes for ELF32, and 8 bytes for ELF64.
+        uint64_t readAddr(size_t offset)
+            { return read(offset, m64 ? 8 : 4); }
+        /// Get a null terminated string. Returns nullptr if the string is not
+        /// in the file.
+        char const *getString(uint64_t offset, uint64_t endOffset);
+
+    private:
+        unsigned char const *mData;
+        size_t mSize;
+        bool mBigEndian;
+        bool m64;
+        bool mValid;
+    };
+
+bool ElfReader::init()
+    {
+    enum ElfIdent { EI_Class=4, EI_Data=5, EI_NumIdent=16 };
+    mValid = (mSize >= EI_NumIdent && memcmp(mData, "\x7F" "ELF", 4) == 0);
+    if(mValid)
+        {
+        m64 = (mData[EI_Class] == 2);
+        mBigEndian = (mData[EI_Data] == 2);
+        mValid = ((mData[EI_Class] == 1 || mData[EI_Class] == 2) &&
+            (mData[EI_Data] == 1 || mData[EI_Data] == 2));
+        }
+    return mValid;
+    }
+
+uint64_t ElfReader::read(size_t offset, size_t numBytes)
+    {
+    uint64_t val = 0;
+    if(offset <= mSize && numBytes <= mSize - offset)
+        {
+        for(size_t i=0; i<numBytes; i++)
+            {
+            size_t byteIndex = mBigEndian ? i : numBytes-1-i;
+            val = (val << 8) | mData[offset + byteIndex];
+            }
+        }
+    else
+        {
+        mValid = false;
+        }
+    return val;
+    }
+
+char const *ElfReader::getString(uint64_t offset, uint64_t endOffset)
+    {
+    char const *str = nullptr;
+    if(endOffset <= mSize && offset < endOffset)
+        {
+        char const *start = reinterpret_cast<char const *>(mData) + offset;
+        // The string must be terminated within the string table.
+        if(memchr(start, '\0', static_cast<size_t>(endOffset - offset)))
+            {
+            str = start;
+            }
+        }
+    return str;
+    }
+
+bool ArchiveSymbols::readElf(unsigned char const *data, size_t size)
+    {
+    enum SectionTypes { SHT_SymTab=2, SHT_DynSym=11 };
+    enum SectionIndices { SHN_Undef=0, SHN_Common=0xFFF2 };
+    enum SymbolBindings { STB_Global=1 };
+    enum SymbolTypes { STT_Section=3, STT_File=4 };
+
+    ElfReader elf(data, size);
+    if(elf.init())
+        {
+        bool is64 = elf.is64();
+        uint64_t shOff = elf.readAddr(is64 ? 0x28 : 0x20);
+        uint64_t shEntSize = elf.read(is64 ? 0x3A : 0x2E, 2);
+        uint64_t shNum = elf.read(is64 ? 0x3C : 0x30, 2);
+        // The section header offsets that are used.
+        size_t const shTypeOff = 4;
+        size_t const shOffsetOff = is64 ? 24 : 16;
+        size_t const shSizeOff = is64 ? 32 : 20;
+        size_t const shLinkOff = is64 ? 40 : 24;
+        size_t const shInfoOff = is64 ? 44 : 28;
+        size_t const shEntSizeOff = is64 ? 56 : 36;
+        if(shNum == 0 && shOff != 0)
+            {
+            // Extended numbering keeps the number of sections in the first
+            // section header.
+            shNum = elf.readAddr(static_cast<size_t>(shOff) + shSizeOff);
+            }
+        // Use the full symbol table, or the dynamic symbol table if the file
+        // is stripped.
+        uint64_t symSection = 0;
+        for(uint64_t i=0; i<shNum && elf.isValid(); i++)
+            {
+            size_t sh = static_cast<size_t>(shOff + i * shEntSize);
+            uint64_t type = elf.read(sh + shTypeOff, 4);
+            if(type == SHT_SymTab || (type == SHT_DynSym && symSection == 0))
+                {
+                symSection = i;
+                }
+            }
+        if(symSection != 0 && elf.isValid())
+            {
+            size_t sh = static_cast<size_t>(shOff + symSection * shEntSize);
+            uint64_t symOff = elf.readAddr(sh + shOffsetOff);
+            uint64_t symSize = elf.readAddr(sh + shSizeOff);
+            uint64_t strSection = elf.read(sh + shLinkOff, 4);
+            // Local symbols are always before the first global symbol.
+            uint64_t firstGlobal = elf.read(sh + shInfoOff, 4);
+            uint64_t symEntSize = elf.readAddr(sh + shEntSizeOff);
+
+            size_t strSh = static_cast<size_t>(shOff + strSection * shEntSize);
+            uint64_t strOff = elf.readAddr(strSh + shOffsetOff);
+            uint64_t strEnd = strOff + elf.readAddr(strSh + shSizeOff);
+            if(strSection >= shNum || symEntSize == 0)
+                {
+                elf.setInvalid();
+                }
+            uint64_t numSyms = elf.isValid() ? symSize / symEntSize : 0;
+            for(uint64_t i=firstGlobal; i<numSyms && elf.isValid(); i++)
+                {
+                size_t sym = static_cast<size_t>(symOff + i * symEntSize);
+                uint64_t nameOff = elf.read(sym, 4);
+                uint64_t info = elf.read(sym + (is64 ? 4 : 12), 1);
+                uint64_t shIndex = elf.read(sym + (is64 ? 6 : 14), 2);
+                uint64_t bind = info >> 4;
+                uint64_t type = info & 0xF;
+                // Weak symbols are not used to find dependencies between
+                // libraries, since they can be defined in many libraries.
+                if(bind == STB_Global && type != STT_Section && type != STT_File &&
+                    shIndex != SHN_Common)
+                    {
+                    char const *name = elf.getString(strOff + nameOff, strEnd);
+                    if(name && name[0] != '\0')
+                        {
+                        if(shIndex == SHN_Undef)
+                            {
+                            mUndefinedSymbols.push_back(name);
+                            }
+                        else
+                            {
+                            mDefinedSymbols.push_back(name);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    return elf.isValid();
+    }
+
+bool ArchiveSymbols::readArchive(unsigned char const *data, size_t size)
+    {
+    // Each member header is:
+    //    name[16] date[12] uid[6] gid[6] mode[8] size[10] magic[2]
+    size_t const headerSize = 60;
+    size_t const nameSize = 16;
+    size_t const sizeOffset = 48;
+    size_t const sizeSize = 10;
+    bool success = true;
+    size_t pos = 8;         // Skip "!<arch>\n"
+    while(pos + headerSize <= size && success)
+        {
+        char const *header = reinterpret_cast<char const *>(data + pos);
+        char sizeStr[sizeSize+1];
+        memcpy(sizeStr, header + sizeOffset, sizeSize);
+        sizeStr[sizeSize] = '\0';
+        size_t memberSize = strtoul(sizeStr, nullptr, 10);
+        size_t memberPos = pos + headerSize;
+        success = (memcmp(header + 58, "`\n", 2) == 0 &&
+            memberSize <= size - memberPos);
+        if(success)
+            {
+            // BSD archives put long names at the start of the member data.
+            if(memcmp(header, "#1/", 3) == 0)
+                {
+                char nameLenStr[nameSize];
+                memcpy(nameLenStr, header + 3, nameSize-3);
+                nameLenStr[nameSize-3] = '\0';
+                size_t nameLen = strtoul(nameLenStr, nullptr, 10);
+                success = (nameLen <= memberSize);
+                if(success)
+                    {
+                    memberPos += nameLen;
+                    memberSize -= nameLen;
+                    }
+                }
+            // The GNU symbol tables are named "/" and "/SYM64/", and the long
+            // name table is named "//". Other names that start with '/' are
+            // objects with long names.
+            bool objectMember = !((header[0] == '/' && (header[1] == ' ' ||
+                header[1] == '/' || memcmp(header, "/SYM64/", 7) == 0)) ||
+                memcmp(header, "__.SYMDEF", 9) == 0);
+            if(success && objectMember)
+                {
+                success = readElf(data + memberPos, memberSize);
+                }
+            }
+        // Members are aligned on even byte boundaries.
+        pos = memberPos + memberSize + ((memberPos + memberSize) & 1);
+        }
+    return success;
+    }
+
+bool ArchiveSymbols::read(OovStringRef const libFilePath)
+    {
+    mDefinedSymbols.clear();
+    mUndefinedSymbols.clear();
+    MappedFile file;
+    bool success = file.open(libFilePath);
+    if(success)
+        {
+        unsigned char const *data = file.getData();
+        size_t size = file.getSize();
+        if(size >= 8 && memcmp(data, "!<arch>\n", 8) == 0)
+            {
+            success = readArchive(data, size);
+            }
+        else
+            {
+            success = readElf(data, size);
+            }
+        }
+    if(!success)
+        {
+        mDefinedSymbols.clear();
+        mUndefinedSymbols.clear();
+        }
+    return success;
+    }
@@ -0,0 +1,37 @@
+/*
+ * ArchiveSymbols.h
+ *
+ *  \copyright 2016 DCBlaha.  Distributed under the GPL.
+ */
+
+#ifndef ARCHIVESYMBOLS_H_
+#define ARCHIVESYMBOLS_H_
+
+#include "File.h"
+
+/// This reads the global symbols of the object files in an ar archive (static
+/// library), or of a single ELF file, without running an external tool such
+/// as nm.
+class ArchiveSymbols
+    {
+    public:
+        /// Global symbols that are defined by the library.  This is
+        /// the same as "T", "D", "B" and "R" symbols from nm.
+        OovStringVec mDefinedSymbols;
+        /// Global symbols that are used but not defined by an object.
+        /// This is the same as "U" symbols from nm.
+        OovStringVec mUndefinedSymbols;
+
+        /// Read the symbols from a library.
+        /// Returns false if the file is not an ar archive of ELF objects or an
+        /// ELF file, such as a COFF library, a thin archive, or an archive of
+        /// LLVM bitcode. Then an external tool must be used.
+        /// @param libFilePath The library to read.
+        bool read(OovStringRef const libFilePath);
+
+    private:
+        bool readArchive(unsigned char const *data, size_t size);
+        bool readElf(unsigned char const *data, size_t size);
+    };
+
+#endif /* ARCHIVESYMBOLS_H_ */
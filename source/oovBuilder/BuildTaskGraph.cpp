@@ -0,0 +1,104 @@
+/*
+ * BuildTaskGraph.cpp
+ *
+ *  \copyright 2016 DCBlaha.  Distributed under the GPL.
+ */
+
+#include "BuildTaskGraph.h"
+
+
+BuildTaskGraph::TaskId BuildTaskGraph::addGraphTask(BuildTaskPrepare const &prepare)
+    {
+    mTasks.push_back(GraphTask(prepare));
+    return mTasks.size()-1;
+    }
+
+void BuildTaskGraph::addDependency(TaskId task, TaskId dependsOnTask)
+    {
+    mTasks[dependsOnTask].mDependents.push_back(task);
+    mTasks[task].mNumWaitingDeps++;
+    }
+
+BuildTaskGraph::TaskId BuildTaskGraph::addGroupTask(
+        std::vector<TaskId> const &dependsOnTasks)
+    {
+    TaskId groupId = addGraphTask([]{ return BuildTaskWork(); });
+    for(auto const &dep : dependsOnTasks)
+        {
+        addDependency(groupId, dep);
+        }
+    return groupId;
+    }
+
+bool BuildTaskGraph::run(size_t numThreads)
+    {
+    mNumDoneTasks = 0;
+    mAllSucceeded = true;
+    mReadyTasks.clear();
+    for(size_t i=0; i<mTasks.size(); i++)
+        {
+        if(mTasks[i].mNumWaitingDeps == 0)
+            {
+            mReadyTasks.push_back(i);
+            }
+        }
+    setupQueue(numThreads);
+    std::unique_lock<std::mutex> lock(mGraphMutex);
+    while(mNumDoneTasks < mTasks.size())
+        {
+        while(mReadyTasks.empty() && mNumDoneTasks < mTasks.size())
+            {
+            mTaskDoneSignal.wait(lock);
+            }
+        if(!mReadyTasks.empty())
+            {
+            TaskId taskId = mReadyTasks.front();
+            mReadyTasks.pop_front();
+            lock.unlock();
+            // The prepare and the push are done without the lock so that
+            // worker threads can complete tasks.
+            BuildTaskWork work = mTasks[taskId].mPrepare();
+            if(work)
+                {
+                mTasks[taskId].mWork = work;
+                addTask(taskId);
+                }
+            else
+                {
+                taskDone(taskId, true);
+                }
+            lock.lock();
+            }
+        }
+    lock.unlock();
+    waitForCompletion();
+    return mAllSucceeded;
+    }
+
+bool BuildTaskGraph::processItem(TaskId const &taskId)
+    {
+    bool success = mTasks[taskId].mWork();
+    taskDone(taskId, success);
+    return true;
+    }
+
+void BuildTaskGraph::taskDone(TaskId taskId, bool success)
+    {
+    std::unique_lock<std::mutex> lock(mGraphMutex);
+    if(!success)
+        {
+        mAllSucceeded = false;
+        }
+    // Dependents go to the front so that they are started before tasks
+    // that were ready at the start.
+    for(auto const &dependent : mTasks[taskId].mDependents)
+        {
+        if(--mTasks[dependent].mNumWaitingDeps == 0)
+            {
+            mReadyTasks.push_front(dependent);
+            }
+        }
+    mNumDoneTasks++;
+    lock.unlock();
+    mTaskDoneSignal.notify_one();
+    }
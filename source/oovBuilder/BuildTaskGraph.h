@@ -0,0 +1,87 @@
+/*
+ * BuildTaskGraph.h
+ *
+ *  \copyright 2016 DCBlaha.  Distributed under the GPL.
+ */
+
+#ifndef BUILDTASKGRAPH_H_
+#define BUILDTASKGRAPH_H_
+
+#include "OovThreadedWaitQueue.h"
+#include <functional>
+#include <deque>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+
+/// The work for a build task that is run by a worker thread.
+/// The return indicates success.
+typedef std::function<bool()> BuildTaskWork;
+
+/// Prepares a build task. This is only called after all tasks that the task
+/// depends on are complete, and it is called on the thread that called
+/// BuildTaskGraph::run(), so it may use data that is not thread safe. This
+/// returns the work for a worker thread, or an empty function if there is
+/// nothing to do, such as when the output file is not old.
+typedef std::function<BuildTaskWork()> BuildTaskPrepare;
+
+/// This schedules build tasks using the dependencies between the tasks
+/// instead of building in phases. For example, a library can be built
+/// as soon as its objects are compiled, even if other objects are still
+/// being compiled.
+///
+/// Tasks that become ready because their dependencies completed are
+/// started before tasks that had no dependencies so that links are not
+/// delayed until all compiles are done.
+class BuildTaskGraph:public ThreadedWorkWaitQueue<size_t, BuildTaskGraph>
+    {
+    public:
+        typedef size_t TaskId;
+        BuildTaskGraph():
+            mNumDoneTasks(0), mAllSucceeded(true)
+            {}
+
+        /// Add a task to the graph. Tasks cannot be added while running.
+        /// @param prepare The function to prepare the task.
+        TaskId addGraphTask(BuildTaskPrepare const &prepare);
+
+        /// Indicate that a task cannot be started until another task is done.
+        /// @param task The task that must wait.
+        /// @param dependsOnTask The task that must be done first.
+        void addDependency(TaskId task, TaskId dependsOnTask);
+
+        /// Add a task that does no work, but is done after all of the
+        /// tasks that it depends on are done.
+        TaskId addGroupTask(std::vector<TaskId> const &dependsOnTasks);
+
+        /// Runs all tasks and waits for them to complete.
+        /// @param numThreads The number of worker threads.
+        /// Returns false if the work of any task failed.
+        bool run(size_t numThreads);
+
+        /// Called by ThreadedWorkWaitQueue
+        bool processItem(TaskId const &taskId);
+
+    private:
+        struct GraphTask
+            {
+            GraphTask(BuildTaskPrepare const &prepare):
+                mPrepare(prepare), mNumWaitingDeps(0)
+                {}
+            BuildTaskPrepare mPrepare;
+            BuildTaskWork mWork;
+            std::vector<TaskId> mDependents;
+            size_t mNumWaitingDeps;
+            };
+        std::vector<GraphTask> mTasks;
+        /// Tasks that have all dependencies complete, but are not prepared.
+        std::deque<TaskId> mReadyTasks;
+        size_t mNumDoneTasks;
+        bool mAllSucceeded;
+        std::mutex mGraphMutex;
+        std::condition_variable mTaskDoneSignal;
+
+        void taskDone(TaskId taskId, bool success);
+    };
+
+#endif /* BUILDTASKGRAPH_H_ */
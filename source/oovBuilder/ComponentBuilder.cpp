@@ -204,82 +204,96 @@ IndexedStringSet ComponentBuilder::getComponentPackageLinkArgs(OovStringRef cons
     return linkArgs;
     }
 
-class LibTaskListener:public TaskQueueListener
-    {
-    public:
-        OovStringVec const &getBuiltLibs() const
-            { return mBuiltLibs; }
-    private:
-        OovStringVec mBuiltLibs;
-        virtual void extraProcessing(bool success, OovStringRef const outFile,
-                OovStringRef const /*stdOutFn*/, ProcessArgs const & /*item*/) override;
-    };
-
-void LibTaskListener::extraProcessing(bool success, OovStringRef const outFile,
-    OovStringRef const /*stdOutFn*/, ProcessArgs const & /*item*/)
+void ComponentBuilder::processSourceForComponents(eProcessModes pm)
     {
-    if(success)
-        mBuiltLibs.push_back(outFile);
+    BuildTaskGraph graph;
+    ComponentTasks compTasks;
+    addSourceTasks(pm, graph, compTasks);
+    graph.run(getNumHardwareThreads());
     }
 
-void ComponentBuilder::processSourceForComponents(eProcessModes pm)
+void ComponentBuilder::addSourceTasks(eProcessModes pm, BuildTaskGraph &graph,
+        ComponentTasks &compTasks)
     {
     ScannedComponentInfo const &scannedInfoFile =
         mComponentFinder.getScannedComponentInfo();
     ComponentTypesFile const &compTypes =
         mComponentFinder.getComponentTypesFile();
     OovStringVec compNames = scannedInfoFile.getComponentNames();
-    if(compNames.size() > 0)
+    for(const auto &name : compNames)
         {
-        setupQueue(getNumHardwareThreads());
-        for(const auto &name : compNames)
+        eCompTypes compType = compTypes.getComponentType(name);
+        if(compType != CT_Unknown && compType != CT_JavaJarLib &&
+            compType != CT_JavaJarProg)
             {
-            OovStringSet compileArgs = getComponentPackageCompileArgs(name);
-            eCompTypes compType = compTypes.getComponentType(name);
-            if(compType != CT_Unknown && compType != CT_JavaJarLib &&
-                compType != CT_JavaJarProg)
+            OovStringVec cppSources = scannedInfoFile.getComponentFiles(
+                compTypes, ScannedComponentInfo::CFT_CppSource, name);
+            if(pm == PM_CovInstr)
                 {
-                OovStringVec cppSources = scannedInfoFile.getComponentFiles(
-                    compTypes, ScannedComponentInfo::CFT_CppSource, name);
-                if(pm == PM_CovInstr)
-                    {
-                    OovStringVec includes = scannedInfoFile.getComponentFiles(
-                        compTypes, ScannedComponentInfo::CFT_CppInclude, name);
-                    cppSources.insert(cppSources.end(), includes.begin(), includes.end());
-                    }
+                OovStringVec includes = scannedInfoFile.getComponentFiles(
+                    compTypes, ScannedComponentInfo::CFT_CppInclude, name);
+                cppSources.insert(cppSources.end(), includes.begin(), includes.end());
+                }
 
-                for(const auto &src : cppSources)
+            OovStringSet compileArgs = getComponentPackageCompileArgs(name);
+            for(const auto &src : cppSources)
+                {
+                compTasks[name].push_back(graph.addGraphTask(
+                    [this, pm, src, compileArgs]()
                     {
-                    FilePath absSrc;
-                    absSrc.getAbsolutePath(src, FP_File);
-                    OovStringVec orderedCompIncRoots = mComponentFinder.getFileIncludeDirs(src);
-                    OovStringVec orderedIncDirs =
-                        mIncDirMap.getOrderedIncludeDirsForSourceFile(absSrc,
-                        orderedCompIncRoots);
-                    /// @todo - this could be optimized to not check file times of external files.
-                    /// @todo - more optimization could use the times in the incdeps file.
-                    std::set<IncludedPath> incFilesSet;
-                    mIncDirMap.getNestedIncludeFilesUsedBySourceFile(absSrc,
-                        incFilesSet);
-                    OovStringVec incFiles;
-                    for(auto const &file : incFilesSet)
+                    return prepareWork([this, pm, &src, &compileArgs]()
                         {
-                        incFiles.push_back(file.getFullPath());
-                        }
-                    processCppSourceFile(pm, src, orderedIncDirs, incFiles, compileArgs);
-                    }
+                        FilePath absSrc;
+                        absSrc.getAbsolutePath(src, FP_File);
+                        OovStringVec orderedCompIncRoots = mComponentFinder.getFileIncludeDirs(src);
+                        OovStringVec orderedIncDirs =
+                            IncDirDependencyMapReader::getOrderedIncludeDirs(
+                            mIncDirClosure.getNestedIncludeDirs(absSrc),
+                            orderedCompIncRoots);
+                        processCppSourceFile(pm, src, absSrc, orderedIncDirs,
+                            compileArgs);
+                        });
+                    }));
                 }
-            if(compType == CT_JavaJarLib || compType == CT_JavaJarProg)
+            }
+        if(compType == CT_JavaJarLib || compType == CT_JavaJarProg)
+            {
+            OovStringVec javaSources = scannedInfoFile.getComponentFiles(
+                compTypes, ScannedComponentInfo::CFT_JavaSource, name);
+            compTasks[name].push_back(graph.addGraphTask([this, pm, name, javaSources]()
                 {
-                OovStringVec javaSources = scannedInfoFile.getComponentFiles(
-                    compTypes, ScannedComponentInfo::CFT_JavaSource, name);
-                processJavaSourceFiles(pm, name, javaSources /*, compileArgs*/);
-                }
+                return prepareWork([this, pm, &name, &javaSources]()
+                    { processJavaSourceFiles(pm, name, javaSources /*, compileArgs*/); });
+                }));
             }
-        waitForCompletion();
         }
     }
 
+BuildTaskWork ComponentBuilder::prepareWork(std::function<void()> const &makeTask)
+    {
+    mPreparedWork = BuildTaskWork();
+    makeTask();
+    BuildTaskWork work = mPreparedWork;
+    mPreparedWork = BuildTaskWork();
+    return work;
+    }
+
+void ComponentBuilder::addBuildTask(ProcessArgs const &item)
+    {
+    mPreparedWork = [this, item]() { return runTask(item); };
+    }
+
+OovStringVec const &ComponentBuilder::getProjectLibFileNames()
+    {
+    if(!mProjectLibFileNamesRead)
+        {
+        mObjSymbols.appendOrderedLibFileNames("ProjLibs", getSymbolBasePath(),
+                mProjectLibFileNames);
+        mProjectLibFileNamesRead = true;
+        }
+    return mProjectLibFileNames;
+    }
+
 void ComponentBuilder::generateDependencies()
     {
     ComponentTypesFile const &compTypesFile = getComponentTypesFile();
@@ -342,104 +356,189 @@ void ComponentBuilder::generateDependencies()
 // C:\Program Files\GTK+-Bundle-3.6.1\lib       (contains glib, gmodule stuff on Windows)
 void ComponentBuilder::buildComponents()
     {
-    ScannedComponentInfo const &scannedInfoFile =
-        mComponentFinder.getScannedComponentInfo();
     ComponentTypesFile const &compTypesFile =
             mComponentFinder.getComponentTypesFile();
     OovStringVec compNames = compTypesFile.getDefinedComponentNames();
 
     sVerboseDump.logProgress("Generating package dependencies");
     generateDependencies();
-    sVerboseDump.logProgress("Compile objects");
-    // Compile all objects.
-    processSourceForComponents(PM_Build);
-    sVerboseDump.logProgress("Build libraries");
 
-    // Build all project libraries
-    OovStringVec builtLibFileNames;
+    // This uses the task queue to make symbols, so it must be done before
+    // the build graph is run.
+    sVerboseDump.logProgress("Order external package libraries");
+    for(const auto &name : compNames)
+        {
+        makeOrderedPackageLibs(name);
+        }
+
+    // The objects, libraries, and programs are built in dependency order
+    // instead of in phases, so that a library is built as soon as its
+    // objects are compiled, and so on.
+    sVerboseDump.logProgress("Build components");
+    BuildTaskGraph graph;
+    ComponentTasks compTasks;
+    addSourceTasks(PM_Build, graph, compTasks);
+    addLinkTasks(graph, compTasks);
+    graph.run(getNumHardwareThreads());
+    sVerboseDump.logProgress("Done building");
+    }
+
+void ComponentBuilder::addLinkTasks(BuildTaskGraph &graph,
+        ComponentTasks const &compTasks)
+    {
+    ScannedComponentInfo const &scannedInfoFile =
+        mComponentFinder.getScannedComponentInfo();
+    ComponentTypesFile const &compTypesFile =
+            mComponentFinder.getComponentTypesFile();
+    OovStringVec compNames = compTypesFile.getDefinedComponentNames();
+    static std::vector<BuildTaskGraph::TaskId> const noTasks;
+    auto getCompTasks = [&compTasks](OovString const &name) ->
+        std::vector<BuildTaskGraph::TaskId> const &
+        {
+        auto const &iter = compTasks.find(name);
+        return((iter != compTasks.end()) ? iter->second : noTasks);
+        };
+
+    // Each project library depends only on its own objects.
     OovStringVec allLibFileNames;
-    if(compNames.size() > 0)
+    std::vector<BuildTaskGraph::TaskId> libTasks;
+    mProjectLibsBuilt = false;
+    for(const auto &name : compNames)
         {
-        LibTaskListener libListener;
-        setTaskListener(&libListener);
-        setupQueue(getNumHardwareThreads());
-        for(const auto &name : compNames)
+        if(compTypesFile.getComponentType(name) == CT_StaticLib)
             {
-            if(compTypesFile.getComponentType(name) == CT_StaticLib)
+            OovStringVec sources = scannedInfoFile.getComponentFiles(
+                compTypesFile, ScannedComponentInfo::CFT_CppSource, name);
+            for(size_t i=0; i<sources.size(); i++)
+                {
+                sources[i] = makeOutputObjectFileName(sources[i]);
+                }
+            if(sources.size() > 0)
                 {
-                OovStringVec sources = scannedInfoFile.getComponentFiles(
-                    compTypesFile, ScannedComponentInfo::CFT_CppSource, name);
-                for(size_t i=0; i<sources.size(); i++)
+                allLibFileNames.push_back(makeLibFn(name));
+                BuildTaskGraph::TaskId libTask = graph.addGraphTask(
+                    [this, name, sources]() -> BuildTaskWork
                     {
-                    sources[i] = makeOutputObjectFileName(sources[i]);
-                    }
-                if(sources.size() > 0)
+                    BuildTaskWork work = prepareWork([this, &name, &sources]()
+                        { makeLib(name, sources); });
+                    if(work)
+                        {
+                        work = [this, work]()
+                            {
+                            bool success = work();
+                            if(success)
+                                {
+                                mProjectLibsBuilt = true;
+                                }
+                            return success;
+                            };
+                        }
+                    return work;
+                    });
+                for(auto const &objTask : getCompTasks(name))
                     {
-                    allLibFileNames.push_back(makeLibFn(name));
-                    makeLib(name, sources);
+                    graph.addDependency(libTask, objTask);
                     }
+                libTasks.push_back(libTask);
                 }
             }
-        waitForCompletion();
-        builtLibFileNames = libListener.getBuiltLibs();
-        setTaskListener(nullptr);
-
-        if(builtLibFileNames.size() > 0)
-           {
-           makeLibSymbols("ProjLibs", allLibFileNames);
-           }
         }
 
-
-    // Build programs
-    OovStringVec projectLibFileNames;
-    mObjSymbols.appendOrderedLibFileNames("ProjLibs", getSymbolBasePath(),
-            projectLibFileNames);
-    if(compNames.size() > 0)
+    // The project library order is needed by all programs, and requires
+    // all project libraries.
+    BuildTaskGraph::TaskId projLibsTask = graph.addGraphTask(
+        [this, allLibFileNames]() -> BuildTaskWork
         {
-        sVerboseDump.logProgress("Order external package libraries");
-
-        for(const auto &name : compNames)
+        BuildTaskWork work;
+        if(mProjectLibsBuilt)
             {
-            makeOrderedPackageLibs(name);
+            work = [this, allLibFileNames]()
+                {
+                makeLibSymbols("ProjLibs", allLibFileNames);
+                return true;
+                };
             }
+        return work;
+        });
+    for(auto const &libTask : libTasks)
+        {
+        graph.addDependency(projLibsTask, libTask);
+        }
 
-        sVerboseDump.logProgress("Build programs ");
-
-        setupQueue(getNumHardwareThreads());
-        for(const auto &name : compNames)
+    // Each program depends on its own objects and the project libraries.
+    for(const auto &name : compNames)
+        {
+        auto type = compTypesFile.getComponentType(name);
+        if(type == CT_Program || type == CT_SharedLib)
             {
-            OovStringVec externalLibDirs;       // not in library search order, eliminate dups.
-            IndexedStringVec externalOrderedPackageLibNames;
-            auto type = compTypesFile.getComponentType(name);
-            if(type == CT_Program || type == CT_SharedLib)
+            BuildTaskGraph::TaskId exeTask = graph.addGraphTask([this, name, type]()
                 {
-                appendOrderedPackageLibs(name, externalLibDirs,
-                        externalOrderedPackageLibNames);
-                IndexedStringSet compPkgLinkArgs = getComponentPackageLinkArgs(name,
-                        compTypesFile);
-
-                OovStringVec sources = scannedInfoFile.getComponentFiles(
-                    compTypesFile, ScannedComponentInfo::CFT_CppSource, name);
-                makeExe(name, sources, projectLibFileNames,
-                        externalLibDirs, externalOrderedPackageLibNames,
-                        compPkgLinkArgs, type == CT_SharedLib);
+                return prepareWork([this, &name, type]()
+                    {
+                    ComponentTypesFile const &compTypes =
+                        mComponentFinder.getComponentTypesFile();
+                    OovStringVec externalLibDirs;       // not in library search order, eliminate dups.
+                    IndexedStringVec externalOrderedPackageLibNames;
+                    appendOrderedPackageLibs(name, externalLibDirs,
+                            externalOrderedPackageLibNames);
+                    IndexedStringSet compPkgLinkArgs = getComponentPackageLinkArgs(name,
+                            compTypes);
+
+                    OovStringVec sources = mComponentFinder.getScannedComponentInfo().
+                        getComponentFiles(compTypes,
+                        ScannedComponentInfo::CFT_CppSource, name);
+                    makeExe(name, sources, getProjectLibFileNames(),
+                            externalLibDirs, externalOrderedPackageLibNames,
+                            compPkgLinkArgs, type == CT_SharedLib);
+                    });
+                });
+            graph.addDependency(exeTask, projLibsTask);
+            for(auto const &objTask : getCompTasks(name))
+                {
+                graph.addDependency(exeTask, objTask);
                 }
             }
-        for(const auto &name : compNames)
+        }
+
+    // Each jar depends on its own classes, and a program jar also depends
+    // on all jar libraries.
+    std::vector<BuildTaskGraph::TaskId> jarLibTasks;
+    std::vector<BuildTaskGraph::TaskId> jarProgTasks;
+    for(const auto &name : compNames)
+        {
+        auto type = compTypesFile.getComponentType(name);
+        if(type == CT_JavaJarLib || type == CT_JavaJarProg)
             {
-            auto type = compTypesFile.getComponentType(name);
-            if(type == CT_JavaJarLib || type == CT_JavaJarProg)
+            bool prog = (type == CT_JavaJarProg);
+            OovStringVec sources = scannedInfoFile.getComponentFiles(
+                compTypesFile, ScannedComponentInfo::CFT_JavaSource, name);
+            BuildTaskGraph::TaskId jarTask = graph.addGraphTask(
+                [this, name, sources, prog]()
+                {
+                return prepareWork([this, &name, &sources, prog]()
+                    { makeJar(name, sources, prog); });
+                });
+            for(auto const &classTask : getCompTasks(name))
+                {
+                graph.addDependency(jarTask, classTask);
+                }
+            if(prog)
                 {
-                bool prog = (type == CT_JavaJarProg);
-                OovStringVec sources = scannedInfoFile.getComponentFiles(
-                    compTypesFile, ScannedComponentInfo::CFT_JavaSource, name);
-                makeJar(name, sources, prog);
+                jarProgTasks.push_back(jarTask);
+                }
+            else
+                {
+                jarLibTasks.push_back(jarTask);
                 }
             }
-        waitForCompletion();
         }
-    sVerboseDump.logProgress("Done building");
+    for(auto const &progTask : jarProgTasks)
+        {
+        for(auto const &libTask : jarLibTasks)
+            {
+            graph.addDependency(progTask, libTask);
+            }
+        }
     }
 
 
@@ -506,7 +605,7 @@ bool ComponentTaskQueue::runProcess(OovStringRef const procPath,
     return status.ok() && success;
     }
 
-bool ComponentTaskQueue::processItem(ProcessArgs const &item)
+bool ComponentTaskQueue::runTask(ProcessArgs const &item)
     {
     char const *stdOutFn = item.mStdOutFn.length() ? item.mStdOutFn.getStr() : nullptr;
     char const *workingDir = nullptr;
@@ -514,10 +613,18 @@ bool ComponentTaskQueue::processItem(ProcessArgs const &item)
         {
         workingDir = item.mWorkingDir.getStr();
         }
-    bool success = runProcess(item.mProcess, item.mOutputFile,
+    return runProcess(item.mProcess, item.mOutputFile,
         item.mChildArgs, mListenerStdMutex, stdOutFn, workingDir);
+    }
+
+bool ComponentTaskQueue::processItem(ProcessArgs const &item)
+    {
+    bool success = runTask(item);
     if(mListener)
+        {
+        char const *stdOutFn = item.mStdOutFn.length() ? item.mStdOutFn.getStr() : nullptr;
         mListener->extraProcessing(success, item.mOutputFile, stdOutFn, item);
+        }
     return success;
     }
 
@@ -530,7 +637,7 @@ OovString ComponentBuilder::makeOutputObjectFileName(OovStringRef const srcFile)
     }
 
 void ComponentBuilder::processCppSourceFile(eProcessModes pm, OovStringRef const srcFile,
-        OovStringVec const &incDirs, OovStringVec const &incFiles,
+        OovStringRef const absSrcFile, OovStringVec const &incDirs,
         OovStringSet const &externPkgCompileArgs)
     {
     bool processFile = isCppSource(srcFile);
@@ -540,8 +647,7 @@ void ComponentBuilder::processCppSourceFile(eProcessModes pm, OovStringRef const
         }
     if(processFile)
         {
-        static size_t BadIndex = static_cast<size_t>(-1);
-        size_t incFileOlderIndex = BadIndex;
+        OovString newerIncFile;
         OovString outFileName;
         if(pm == PM_CovInstr)
             {
@@ -552,8 +658,9 @@ void ComponentBuilder::processCppSourceFile(eProcessModes pm, OovStringRef const
             outFileName = makeOutputObjectFileName(srcFile);
             }
         OovStatus status(true, SC_File);
+        /// @todo - this could be optimized to not check file times of external files.
         if(FileStat::isOutputOld(outFileName, srcFile, status) ||
-                FileStat::isOutputOld(outFileName, incFiles, status, &incFileOlderIndex))
+                mIncDirClosure.isOutputOld(outFileName, absSrcFile, newerIncFile))
             {
             OovString ownerComp = getComponentTypesFile().getComponentNameOwner(srcFile);
             mComponentFinder.setCompConfig(ownerComp);
@@ -584,9 +691,9 @@ void ComponentBuilder::processCppSourceFile(eProcessModes pm, OovStringRef const
             ca.addArg(outFileName);
 
             sVerboseDump.logProcess(srcFile, ca.getArgv(), static_cast<int>(ca.getArgc()));
-            addTask(ProcessArgs(procPath, outFileName, ca));
-            if(incFileOlderIndex != BadIndex)
-                sVerboseDump.logOutputOld(incFiles[static_cast<size_t>(incFileOlderIndex)]);
+            addBuildTask(ProcessArgs(procPath, outFileName, ca));
+            if(newerIncFile.length() > 0)
+                sVerboseDump.logOutputOld(newerIncFile);
             }
         }
     }
@@ -696,7 +803,7 @@ void ComponentBuilder::processJavaSourceFiles(eProcessModes pm,
             OovString str = "classes for ";
             str += compName;
             sVerboseDump.logProcess(srcFileListFn, ca.getArgv(), static_cast<int>(ca.getArgc()));
-            addTask(ProcessArgs(procPath, str, ca));
+            addBuildTask(ProcessArgs(procPath, str, ca));
             }
 //        if(incFileOlderIndex != BadIndex)
 //            sVerboseDump.logOutputOld(incFiles[static_cast<size_t>(incFileOlderIndex)]);
@@ -743,7 +850,7 @@ void ComponentBuilder::makeLib(OovStringRef const libPath,
             ca.addArg(objName);
             }
         sVerboseDump.logProcess(outFileName, ca.getArgv(), static_cast<int>(ca.getArgc()));
-        addTask(ProcessArgs(procPath, outFileName, ca));
+        addBuildTask(ProcessArgs(procPath, outFileName, ca));
         }
     }
 
@@ -867,7 +974,7 @@ void ComponentBuilder::makeExe(OovStringRef const compName,
             ca.addArg(arg);
             }
         sVerboseDump.logProcess(outFileName, ca.getArgv(), ca.getArgc());
-        addTask(ProcessArgs(procPath, outFileName, ca));
+        addBuildTask(ProcessArgs(procPath, outFileName, ca));
         }
     }
 
@@ -954,7 +1061,7 @@ void ComponentBuilder::makeJar(OovStringRef const compName,
         OovString intDirName = ComponentTypesFile::getComponentDir(
             mIntermediatePath, compName);
         procArgs.mWorkingDir = intDirName;
-        addTask(procArgs);
+        addBuildTask(procArgs);
         }
     if(status.needReport())
         {
@@ -12,6 +12,8 @@
 #include "ObjSymbols.h"
 #include "OovThreadedWaitQueue.h"
 #include "IncludeMap.h"
+#include "BuildTaskGraph.h"
+#include <atomic>
 
 
 class ComponentPkgDeps
@@ -64,6 +66,9 @@ class ComponentTaskQueue:public ThreadedWorkWaitQueue<ProcessArgs, ComponentTask
         // Called by ThreadedWorkQueue
         bool processItem(ProcessArgs const &item);
 
+        /// Runs the process for the item without calling the task listener.
+        bool runTask(ProcessArgs const &item);
+
         /// @param outFile - used only to make an output directory, and display error.
         static bool runProcess(OovStringRef const procPath, OovStringRef const outFile,
             const OovProcessChildArgs &args, InProcMutex &mutex,
@@ -80,7 +85,9 @@ class ComponentBuilder:public ComponentTaskQueue
     {
     public:
         ComponentBuilder(ComponentFinder &compFinder):
-            mComponentFinder(compFinder)
+            mComponentFinder(compFinder), mIncDirClosure(mIncDirMap),
+            mProjectLibsBuilt(false),
+            mProjectLibFileNamesRead(false)
             {}
         void build(eProcessModes mode,
             OovStringRef const incDepsFilePath, OovStringRef const buildDirClass);
@@ -92,20 +99,48 @@ class ComponentBuilder:public ComponentTaskQueue
         ComponentFinder &mComponentFinder;
         ObjSymbols mObjSymbols;
         IncDirDependencyMapReader mIncDirMap;
+        /// The nested include files of the source files that are built.
+        IncDirDependencyClosure mIncDirClosure;
         /// A map of all packages required to build each component.
         ComponentPkgDeps mComponentPkgDeps;
+        /// The work for the build task that is being prepared.
+        BuildTaskWork mPreparedWork;
+        /// Set when any project library was rebuilt.
+        std::atomic_bool mProjectLibsBuilt;
+        bool mProjectLibFileNamesRead;
+        OovStringVec mProjectLibFileNames;
+
+        /// The build tasks for each component.
+        typedef std::map<OovString, std::vector<BuildTaskGraph::TaskId>> ComponentTasks;
 
         const ComponentTypesFile &getComponentTypesFile() const
             { return mComponentFinder.getComponentTypesFile(); }
         void buildComponents();
         void processSourceForComponents(eProcessModes pm);
+        /// Adds a build task for every C++ source file and every java component.
+        /// @param pm The build mode.
+        /// @param graph The graph to add the tasks to.
+        /// @param compTasks The tasks that were added for each component.
+        void addSourceTasks(eProcessModes pm, BuildTaskGraph &graph,
+                ComponentTasks &compTasks);
+        /// Adds the library, program and jar tasks for the components.
+        void addLinkTasks(BuildTaskGraph &graph, ComponentTasks const &compTasks);
+        /// Calls a function that may add a build task, and returns the work
+        /// for the task.
+        BuildTaskWork prepareWork(std::function<void()> const &makeTask);
+        /// Saves the process arguments as the work for the task that is being
+        /// prepared.
+        void addBuildTask(ProcessArgs const &item);
+        /// Get the ordered project libraries. This can only be called after
+        /// the project library symbols are made.
+        OovStringVec const &getProjectLibFileNames();
         /// Saves a map of all packages required to build each component.
         /// Goes through all non-unknown components in the project and searches
         /// the include paths to see if any came from any of the packages. The
         /// map that is saved is mComponentPkgDeps.
         void generateDependencies();
         void processCppSourceFile(eProcessModes pm, OovStringRef const srcFile,
-            const OovStringVec &incDirs, const OovStringVec &incFiles,
+            OovStringRef const absSrcFile, const OovStringVec &incDirs,
             const OovStringSet &externPkgCompileArgs);
 
         /// This uses the javac program to create class files from java files.
@@ -0,0 +1,141 @@
+/*
+ * FileDependencyOrder.cpp
+ *
+ *  \copyright 2016 DCBlaha.  Distributed under the GPL.
+ */
+
+#include "FileDependencyOrder.h"
+#include <algorithm>
+
+static const size_t NoIndex = static_cast<size_t>(-1);
+
+/// This finds the groups of files that depend on each other (the strongly
+/// connected components), using Tarjan's algorithm.
+class FileDependencyGroups
+    {
+    public:
+        FileDependencyGroups(size_t numFiles, FileDependencies const &fileDeps);
+        /// The group index of each file.
+        std::vector<size_t> mFileGroups;
+        /// The files in each group.
+        std::vector<FileIndices> mGroupFiles;
+
+    private:
+        FileDependencies const &mFileDeps;
+        std::vector<size_t> mVisitIndices;
+        std::vector<size_t> mLowLinks;
+        std::vector<bool> mOnStack;
+        FileIndices mVisitStack;
+        size_t mNextVisitIndex;
+        /// This is recursive.
+        void visitFile(size_t fileIndex);
+    };
+
+FileDependencyGroups::FileDependencyGroups(size_t numFiles,
+        FileDependencies const &fileDeps):
+    mFileGroups(numFiles, NoIndex), mFileDeps(fileDeps),
+    mVisitIndices(numFiles, NoIndex), mLowLinks(numFiles, 0),
+    mOnStack(numFiles, false), mNextVisitIndex(0)
+    {
+    for(size_t i=0; i<numFiles; i++)
+        {
+        if(mVisitIndices[i] == NoIndex)
+            {
+            visitFile(i);
+            }
+        }
+    }
+
+void FileDependencyGroups::visitFile(size_t fileIndex)
+    {
+    mVisitIndices[fileIndex] = mNextVisitIndex;
+    mLowLinks[fileIndex] = mNextVisitIndex;
+    mNextVisitIndex++;
+    mVisitStack.push_back(fileIndex);
+    mOnStack[fileIndex] = true;
+    auto const &iter = mFileDeps.find(fileIndex);
+    if(iter != mFileDeps.end())
+        {
+        for(auto const &supplier : (*iter).second)
+            {
+            if(mVisitIndices[supplier] == NoIndex)
+                {
+                visitFile(supplier);
+                mLowLinks[fileIndex] = std::min(mLowLinks[fileIndex],
+                    mLowLinks[supplier]);
+                }
+            else if(mOnStack[supplier])
+                {
+                mLowLinks[fileIndex] = std::min(mLowLinks[fileIndex],
+                    mVisitIndices[supplier]);
+                }
+            }
+        }
+    if(mLowLinks[fileIndex] == mVisitIndices[fileIndex])
+        {
+        size_t groupIndex = mGroupFiles.size();
+        mGroupFiles.push_back(FileIndices());
+        size_t member;
+        do
+            {
+            member = mVisitStack.back();
+            mVisitStack.pop_back();
+            mOnStack[member] = false;
+            mFileGroups[member] = groupIndex;
+            mGroupFiles[groupIndex].push_back(member);
+            } while(member != fileIndex);
+        }
+    }
+
+void orderDependencies(size_t numFiles, const FileDependencies &fileDependencies,
+        FileIndices &orderedDependencies)
+    {
+    FileDependencyGroups groups(numFiles, fileDependencies);
+    size_t numGroups = groups.mGroupFiles.size();
+    // The number of groups that each group depends on, and the groups that
+    // depend on each group.
+    std::vector<size_t> numSupplierGroups(numGroups, 0);
+    std::vector<FileIndices> clientGroups(numGroups);
+    for(auto const &dep : fileDependencies)
+        {
+        size_t clientGroup = groups.mFileGroups[dep.first];
+        for(auto const &supplier : dep.second)
+            {
+            size_t supplierGroup = groups.mFileGroups[supplier];
+            if(supplierGroup != clientGroup)
+                {
+                clientGroups[supplierGroup].push_back(clientGroup);
+                numSupplierGroups[clientGroup]++;
+                }
+            }
+        }
+    // The groups that are ready are sorted by the lowest file index in the group.
+    std::set<std::pair<size_t, size_t>> readyGroups;
+    std::vector<size_t> groupKeys(numGroups);
+    for(size_t groupIndex=0; groupIndex<numGroups; groupIndex++)
+        {
+        FileIndices &groupFiles = groups.mGroupFiles[groupIndex];
+        std::sort(groupFiles.begin(), groupFiles.end());
+        groupKeys[groupIndex] = groupFiles[0];
+        if(numSupplierGroups[groupIndex] == 0)
+            {
+            readyGroups.insert(std::make_pair(groupKeys[groupIndex], groupIndex));
+            }
+        }
+    FileIndices reverseOrder;
+    while(!readyGroups.empty())
+        {
+        size_t groupIndex = (*readyGroups.begin()).second;
+        readyGroups.erase(readyGroups.begin());
+        FileIndices const &groupFiles = groups.mGroupFiles[groupIndex];
+        reverseOrder.insert(reverseOrder.end(), groupFiles.begin(), groupFiles.end());
+        for(auto const &clientGroup : clientGroups[groupIndex])
+            {
+            if(--numSupplierGroups[clientGroup] == 0)
+                {
+                readyGroups.insert(std::make_pair(groupKeys[clientGroup], clientGroup));
+                }
+            }
+        }
+    orderedDependencies.assign(reverseOrder.rbegin(), reverseOrder.rend());
+    }
@@ -0,0 +1,37 @@
+/*
+ * FileDependencyOrder.h
+ *
+ *  \copyright 2016 DCBlaha.  Distributed under the GPL.
+ */
+
+#ifndef FILEDEPENDENCYORDER_H_
+#define FILEDEPENDENCYORDER_H_
+
+#include <map>
+#include <set>
+#include <vector>
+#include <stddef.h>
+
+typedef std::vector<size_t> FileIndices;
+
+// The first is the client file index, and the second is a container of supplier file indices.
+class FileDependencies:public std::map<size_t, std::set<size_t> >
+    {
+    public:
+        void addDependency(size_t clientIndex, size_t supplierIndex)
+            { (*this)[clientIndex].insert(supplierIndex); }
+    };
+
+/// The files are ordered so that a client file is before the files that it
+/// depends on. Files that depend on each other are kept together as a group.
+/// When there is a choice, the groups that only depend on files that are
+/// already ordered are taken by the lowest file index, and then the whole
+/// order is reversed, so that the order is stable for the same files.
+/// @param numFiles The number of files. All dependencies must use file
+///     indices that are less than this.
+/// @param fileDependencies The suppliers of each client file.
+/// @param orderedDependencies The returned order of the file indices.
+void orderDependencies(size_t numFiles, FileDependencies const &fileDependencies,
+        FileIndices &orderedDependencies);
+
+#endif /* FILEDEPENDENCYORDER_H_ */
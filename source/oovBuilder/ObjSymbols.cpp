@@ -9,113 +9,225 @@
 #include <string>
 #include <stdio.h>
 #include <algorithm>
+#include <unordered_map>
 #include "OovProcess.h"
 #include "ComponentBuilder.h"
+#include "ArchiveSymbols.h"
+#include "FileDependencyOrder.h"
 #include "OovError.h"
 
-class FileSymbol
-    {
-    public:
-        FileSymbol(OovStringRef const symbolName, unsigned int len,
-            size_t fileIndex):
-            mSymbolName(symbolName, len), mFileIndex(fileIndex)
-            {}
-        static const size_t NoFileIndex = static_cast<size_t>(-1);
-        // For sorting and searching
-        bool operator<(const FileSymbol &rh) const
-            { return(mSymbolName < rh.mSymbolName); }
-        OovString mSymbolName;
-        size_t mFileIndex;
-    };
 
-// The first is the client file index, and the second is a container of supplier file indices.
-class FileDependencies:public std::map<size_t, std::set<size_t> >
+/// The symbol files that are written from the symbols read by ArchiveSymbols
+/// start with a comment line that contains the size and time of the library.
+/// This is used to check if the symbol file is up to date.
+static char const LibSymbolCacheComment = '#';
+
+static OovString getLibSymbolCacheHeader(OovStringRef const libFilePath)
     {
-    public:
-        void addDependency(size_t clientIndex, size_t supplierIndex);
-        // Check if the file index passed in is dependent on any other files.
-        bool dependentOnAny(size_t fileIndex) const;
-        // Remove all references to the file index.
-        void removeValue(size_t fileIndex);
+    OovString header;
+    struct OovStat32 libStat;
+    if(OovStatFunc(libFilePath, &libStat) == 0)
+        {
+        char buf[100];
+        snprintf(buf, sizeof(buf), "%coovBuilder size %llu time %llu",
+            LibSymbolCacheComment,
+            static_cast<unsigned long long>(libStat.st_size),
+            static_cast<unsigned long long>(libStat.st_mtime));
+        header = buf;
+        }
+    return header;
+    }
 
-    private:
-        // Remove a client if there are no suppliers
-        bool removeEmptyClient();
-    };
+static bool isLibSymbolCacheValid(OovStringRef const symFileName,
+        OovString const &cacheHeader)
+    {
+    bool valid = false;
+    File file;
+    OovStatus status = file.open(symFileName, "r");
+    if(status.ok())
+        {
+        char buf[100];
+        if(file.getString(buf, sizeof(buf), status))
+            {
+            OovString line = buf;
+            valid = (cacheHeader.length() > 0 && line == cacheHeader + '\n');
+            }
+        }
+    // The symbol file does not exist if the library was not read before.
+    status.clearError();
+    return valid;
+    }
 
-void FileDependencies::addDependency(size_t clientIndex, size_t supplierIndex)
+static void writeLibSymbolCache(OovStringRef const symFileName,
+        OovString const &cacheHeader, ArchiveSymbols const &symbols)
     {
-    auto iter = find(clientIndex);
-    if(iter == end())
+    File file;
+    OovStatus status = file.open(symFileName, "w");
+    if(status.ok())
         {
-        std::set<size_t> suppliers;
-        suppliers.insert(supplierIndex);
-        insert(std::pair<size_t, std::set<size_t> >(clientIndex, suppliers));
+        OovString str = cacheHeader;
+        str += '\n';
+        for(auto const &sym : symbols.mDefinedSymbols)
+            {
+            str += "T ";
+            str += sym;
+            str += '\n';
+            }
+        for(auto const &sym : symbols.mUndefinedSymbols)
+            {
+            str += "U ";
+            str += sym;
+            str += '\n';
+            }
+        status = file.putString(str);
         }
-    else
+    if(status.needReport())
         {
-        iter->second.insert(supplierIndex);
+        OovString errStr = "Unable to write symbol file: ";
+        errStr += symFileName;
+        status.report(ET_Error, errStr);
         }
     }
 
-bool FileDependencies::dependentOnAny(size_t clientIndex) const
+// If the object symbol tool fails, the cache only has the header, so it must
+// be removed to run the tool again on the next build.
+static void deleteLibSymbolCache(OovStringRef const symFileName)
     {
-    return(find(clientIndex) != end());
+    OovStatus status = FileDelete(symFileName);
+    if(status.needReport())
+        {
+        OovString errStr = "Unable to delete symbol file: ";
+        errStr += symFileName;
+        status.report(ET_Error, errStr);
+        }
     }
 
-void FileDependencies::removeValue(size_t fileIndex)
+
+/// The symbols are interned so that each symbol name is only stored once for
+/// the defined and undefined symbols, and resolving a symbol is a single
+/// hash lookup.
+class FileSymbols
     {
-    for(auto &dep : *this)
+    public:
+        static const size_t NoFileIndex = static_cast<size_t>(-1);
+        /// The symbols read from a single file. This is filled without
+        /// locking, and then added to the clump symbols all at once.
+        typedef ArchiveSymbols FileSymbolNames;
+        void add(FileSymbolNames const &names, size_t fileIndex);
+        /// Add a dependency from every file with an undefined symbol to the
+        /// file that defines the symbol.
+        void resolveUndefinedSymbols(FileDependencies &fileDeps) const;
+        bool writeDefinedSymbols(OovStringRef const symFileName) const;
+        bool writeUndefinedSymbols(OovStringRef const symFileName) const;
+
+    private:
+        struct SymbolFiles
+            {
+            SymbolFiles():
+                mDefinedFileIndex(NoFileIndex)
+                {}
+            /// If more than one file defines the symbol, the first is kept.
+            size_t mDefinedFileIndex;
+            std::vector<size_t> mUndefinedFileIndices;
+            };
+        std::unordered_map<std::string, SymbolFiles> mSymbols;
+        SymbolFiles &getSymbol(std::string const &symbolName)
+            { return mSymbols[symbolName]; }
+        typedef std::pair<std::string const *, size_t> SymbolFileIndex;
+        bool writeSymbols(OovStringRef const symFileName,
+            std::vector<SymbolFileIndex> &symbols) const;
+    };
+
+void FileSymbols::add(FileSymbolNames const &names, size_t fileIndex)
+    {
+    for(auto const &name : names.mDefinedSymbols)
         {
-        dep.second.erase(fileIndex);
+        SymbolFiles &sym = getSymbol(name);
+        if(sym.mDefinedFileIndex == NoFileIndex)
+            {
+            sym.mDefinedFileIndex = fileIndex;
+            }
         }
-    while(removeEmptyClient())
+    for(auto const &name : names.mUndefinedSymbols)
         {
+        std::vector<size_t> &undefIndices = getSymbol(name).mUndefinedFileIndices;
+        // Many objects in a library can use the same symbol.
+        if(undefIndices.size() == 0 || undefIndices.back() != fileIndex)
+            {
+            undefIndices.push_back(fileIndex);
+            }
         }
     }
 
-bool FileDependencies::removeEmptyClient()
+void FileSymbols::resolveUndefinedSymbols(FileDependencies &fileDeps) const
     {
-    bool removed = false;
-    for(auto dep=begin(); dep != end(); dep++)
+    for(auto const &sym : mSymbols)
         {
-        if((*dep).second.size() == 0)
+        size_t defIndex = sym.second.mDefinedFileIndex;
+        if(defIndex != NoFileIndex)
             {
-            erase(dep);
-            removed = true;
-            break;
+            for(auto const &undefIndex : sym.second.mUndefinedFileIndices)
+                {
+                // The file indices can be the same if one library has
+                // an object file where it is defined, and another object
+                // file where it is not defined.
+                if(undefIndex != defIndex)
+                    {
+                    fileDeps.addDependency(undefIndex, defIndex);
+                    }
+                }
             }
         }
-    return removed;
     }
 
+bool FileSymbols::writeDefinedSymbols(OovStringRef const symFileName) const
+    {
+    std::vector<SymbolFileIndex> symbols;
+    for(auto const &sym : mSymbols)
+        {
+        if(sym.second.mDefinedFileIndex != NoFileIndex)
+            {
+            symbols.push_back(SymbolFileIndex(&sym.first,
+                sym.second.mDefinedFileIndex));
+            }
+        }
+    return writeSymbols(symFileName, symbols);
+    }
 
-class FileSymbols:public std::set<FileSymbol>
+bool FileSymbols::writeUndefinedSymbols(OovStringRef const symFileName) const
     {
-    public:
-        void add(OovStringRef const symbolName, unsigned int len,
-            size_t fileIndex)
-            { insert(FileSymbol(symbolName, len, fileIndex)); }
-        std::set<FileSymbol>::iterator findName(OovStringRef const symbolName)
+    std::vector<SymbolFileIndex> symbols;
+    for(auto const &sym : mSymbols)
+        {
+        if(sym.second.mDefinedFileIndex == NoFileIndex)
             {
-            FileSymbol fs(symbolName, std::string(symbolName).length(), FileSymbol::NoFileIndex);
-            return find(fs);
+            for(auto const &undefIndex : sym.second.mUndefinedFileIndices)
+                {
+                symbols.push_back(SymbolFileIndex(&sym.first, undefIndex));
+                }
             }
-        bool writeSymbols(OovStringRef const symFileName);
-    };
+        }
+    return writeSymbols(symFileName, symbols);
+    }
 
-bool FileSymbols::writeSymbols(OovStringRef const symFileName)
+bool FileSymbols::writeSymbols(OovStringRef const symFileName,
+        std::vector<SymbolFileIndex> &symbols) const
     {
-    bool success = false;
+    std::sort(symbols.begin(), symbols.end(),
+        [](SymbolFileIndex const &sym1, SymbolFileIndex const &sym2)
+        {
+        return(*sym1.first < *sym2.first ||
+            (*sym1.first == *sym2.first && sym1.second < sym2.second));
+        });
     File file;
     OovStatus status = file.open(symFileName, "w");
     if(status.ok())
         {
-        for(const auto &symbol : *this)
+        for(const auto &symbol : symbols)
             {
-            OovString str = symbol.mSymbolName;
+            OovString str = *symbol.first;
             str += ' ';
-            str.appendInt(static_cast<int>(symbol.mFileIndex));
+            str.appendInt(static_cast<int>(symbol.second));
             str += '\n';
             status = file.putString(str);
             if(!status.ok())
@@ -130,7 +242,7 @@ bool FileSymbols::writeSymbols(OovStringRef const symFileName)
         errStr += symFileName;
         status.report(ET_Error, errStr);
         }
-    return(success);
+    return(status.ok());
     }
 
 
@@ -162,14 +274,6 @@ OovStatusReturn FileList::writeFile(File const &file) const
     }
 
 
-class FileIndices:public std::vector<size_t>
-    {
-    public:
-        void removeValue(size_t val);
-        iterator findValue(size_t val);
-    };
-
-
 class ClumpSymbols
     {
     public:
@@ -178,42 +282,22 @@ class ClumpSymbols
         // D global data object
         // T global function object
         bool addSymbols(OovStringRef const libFilePath, OovStringRef const outFileName);
+        /// Add the symbols that were read directly from the library.
+        void addSymbols(OovStringRef const libFilePath,
+                FileSymbols::FileSymbolNames const &names);
         void writeClumpFiles(OovStringRef const clumpName,
                 OovStringRef const outPath);
     private:
-        FileSymbols mDefinedSymbols;
-        FileSymbols mUndefinedSymbols;
+        FileSymbols mSymbols;
         FileDependencies mFileDependencies;
         FileList mFileIndices;
         FileIndices mOrderedDependencies;
         std::mutex mDataMutex;
-        void resolveUndefinedSymbols();
-        bool readRawSymbolFile(OovStringRef const outRawFileName, size_t fileIndex);
+        bool readRawSymbolFile(OovStringRef const outRawFileName,
+            FileSymbols::FileSymbolNames &names);
     };
 
 
-void FileIndices::removeValue(size_t val)
-    {
-    const auto &pos = findValue(val);
-    if(pos != end())
-        erase(pos);
-    }
-
-std::vector<size_t>::iterator FileIndices::findValue(size_t val)
-    {
-    iterator retiter = end();
-    for(iterator iter=begin(); iter!=end(); ++iter)
-        {
-        if(val == (*iter))
-            {
-            retiter = iter;
-            break;
-            }
-        }
-    return(retiter);
-    }
-
-
 // The .dep file is the master file. The filenames are listed first starting
 // with "f:". The are listed in order, so the first file is file index 0.
 // Then the "o:" indicates the order that the files should be linked.
@@ -266,44 +350,8 @@ static bool writeDepFileInfo(OovStringRef const symFileName, const FileList &fil
     return(status.ok());
     }
 
-static void orderDependencies(size_t numFiles, const FileDependencies &fileDependencies,
-        FileIndices &orderedDependencies)
-    {
-    FileDependencies fileDeps = fileDependencies;
-    FileIndices origFiles;
-    for(size_t i=0; i<numFiles; i++)
-        {
-        origFiles.push_back(i);
-        }
-    // Go through all libraries
-    for(size_t totaliter=0; totaliter<numFiles; totaliter++)
-        {
-        if(origFiles.size() == 0)
-            break;
-        // If any library is not dependent on any others, then remove it
-        // as a client or provider for all libraries.
-        for(size_t i=0; i<origFiles.size(); i++)
-            {
-            size_t fileIndex = origFiles[i];
-            if(!fileDeps.dependentOnAny(fileIndex))
-                {
-                orderedDependencies.insert(orderedDependencies.begin()+0, fileIndex);
-                origFiles.removeValue(fileIndex);
-                fileDeps.removeValue(fileIndex);
-                break;
-                }
-            }
-        }
-    // If there were any left over, there were circular dependencies.
-    for(size_t i=0; i<origFiles.size(); i++)
-        {
-        size_t fileIndex = origFiles[i];
-        orderedDependencies.insert(orderedDependencies.begin()+0, fileIndex);
-        }
-    }
-
 bool ClumpSymbols::readRawSymbolFile(OovStringRef const outRawFileName,
-    size_t fileIndex)
+    FileSymbols::FileSymbolNames &names)
     {
     File inFile;
     OovStatus status = inFile.open(outRawFileName, "r");
@@ -312,26 +360,41 @@ bool ClumpSymbols::readRawSymbolFile(OovStringRef const outRawFileName,
         char buf[2000];
         while(inFile.getString(buf, sizeof(buf), status))
             {
+            // The lines from nm are "[value] type name", and the lines of the
+            // symbol cache are "type name".
+            char const *fields[3];
+            size_t fieldLens[3];
+            size_t numFields = 0;
             char const *p = buf;
-            while(isspace(*p) || isxdigit(*p))
-                p++;
-            char symTypeChar = *p;
-
-            p++;
-            while(isspace(*p))
-                p++;
-            char const *endP = p;
-            while(!isspace(*endP))
-                endP++;
-            if(symTypeChar == 'D' || symTypeChar == 'T')
+            while(*p && numFields < 3)
                 {
-                std::unique_lock<std::mutex> lock(mDataMutex);
-                mDefinedSymbols.add(p, static_cast<size_t>(endP-p), fileIndex);
+                while(isspace(*p))
+                    p++;
+                char const *endP = p;
+                while(*endP && !isspace(*endP))
+                    endP++;
+                if(endP != p)
+                    {
+                    fields[numFields] = p;
+                    fieldLens[numFields] = static_cast<size_t>(endP-p);
+                    numFields++;
+                    }
+                p = endP;
                 }
-            else if(symTypeChar == 'U')
+            if(buf[0] != LibSymbolCacheComment && numFields >= 2)
                 {
-                std::unique_lock<std::mutex> lock(mDataMutex);
-                mUndefinedSymbols.add(p, static_cast<size_t>(endP-p), fileIndex);
+                size_t typeField = numFields - 2;
+                char symTypeChar = (fieldLens[typeField] == 1) ?
+                    *fields[typeField] : '\0';
+                std::string name(fields[typeField+1], fieldLens[typeField+1]);
+                if(symTypeChar == 'D' || symTypeChar == 'T')
+                    {
+                    names.mDefinedSymbols.push_back(name);
+                    }
+                else if(symTypeChar == 'U')
+                    {
+                    names.mUndefinedSymbols.push_back(name);
+                    }
                 }
             }
         }
@@ -344,38 +407,32 @@ bool ClumpSymbols::readRawSymbolFile(OovStringRef const outRawFileName,
     return status.ok();
     }
 
-void ClumpSymbols::resolveUndefinedSymbols()
+bool ClumpSymbols::addSymbols(OovStringRef const libFilePath, OovStringRef const outRawFileName)
     {
-    for(const auto &sym : mDefinedSymbols)
-        {
-        auto pos = mUndefinedSymbols.findName(sym.mSymbolName);
-        if(pos != mUndefinedSymbols.end())
-            {
-            // The file indices can be the same if one library has
-            // an object file where it is defined, and another object
-            // file where it is not defined.
-            if((*pos).mFileIndex != sym.mFileIndex)
-                {
-                mFileDependencies.addDependency((*pos).mFileIndex, sym.mFileIndex);
-                }
-            mUndefinedSymbols.erase(pos);
-            }
-        }
+    // The symbols are read without a lock, so that many files can be read
+    // at the same time.
+    FileSymbols::FileSymbolNames names;
+    bool success = readRawSymbolFile(outRawFileName, names);
+    std::unique_lock<std::mutex> lock(mDataMutex);
+    size_t fileIndex = mFileIndices.size();
+    mFileIndices.push_back(libFilePath);
+    mSymbols.add(names, fileIndex);
+    return success;
     }
 
-bool ClumpSymbols::addSymbols(OovStringRef const libFilePath, OovStringRef const outRawFileName)
+void ClumpSymbols::addSymbols(OovStringRef const libFilePath,
+        FileSymbols::FileSymbolNames const &names)
     {
-        {
-        std::unique_lock<std::mutex> lock(mDataMutex);
-        mFileIndices.push_back(libFilePath);
-        }
-    return readRawSymbolFile(outRawFileName, mFileIndices.size()-1);
+    std::unique_lock<std::mutex> lock(mDataMutex);
+    size_t fileIndex = mFileIndices.size();
+    mFileIndices.push_back(libFilePath);
+    mSymbols.add(names, fileIndex);
     }
 
 void ClumpSymbols::writeClumpFiles(OovStringRef const clumpName,
         OovStringRef const outPath)
     {
-    resolveUndefinedSymbols();
+    mSymbols.resolveUndefinedSymbols(mFileDependencies);
     orderDependencies(mFileIndices.size(), mFileDependencies, mOrderedDependencies);
 
     OovString defSymFileName = outPath;
@@ -392,8 +449,8 @@ void ClumpSymbols::writeClumpFiles(OovStringRef const clumpName,
     depSymFileName += "LibSym-";
     depSymFileName += clumpName;
     depSymFileName += "-Dep.txt";
-    mDefinedSymbols.writeSymbols(defSymFileName);
-    mUndefinedSymbols.writeSymbols(undefSymFileName);
+    mSymbols.writeDefinedSymbols(defSymFileName);
+    mSymbols.writeUndefinedSymbols(undefSymFileName);
     writeDepFileInfo(depSymFileName, mFileIndices, mFileDependencies,
             mOrderedDependencies);
     }
@@ -417,6 +474,10 @@ void ObjTaskListener::extraProcessing(bool success, OovStringRef const /*outFile
         {
         mClumpSymbols.addSymbols(item.mLibFilePath, stdOutFn);
         }
+    else
+        {
+        deleteLibSymbolCache(stdOutFn);
+        }
     }
 
 bool ObjSymbols::makeObjectSymbols(OovStringVec const &libFiles,
@@ -429,12 +490,17 @@ bool ObjSymbols::makeObjectSymbols(OovStringVec const &libFiles,
                 OovString const &libSymFileName,
                 OovString const &libFilePath, bool genSymbolFile):
             mLibFileName(libFileName), mLibFilePath(libFilePath),
-            mLibSymFileName(libSymFileName), mGenSymbolFile(genSymbolFile)
+            mLibSymFileName(libSymFileName), mGenSymbolFile(genSymbolFile),
+            mSymbolsRead(false)
             {}
         OovString mLibFileName;
         OovString mLibFilePath;
         OovString mLibSymFileName;
         bool mGenSymbolFile;
+        /// Set if the symbols were read directly from the library instead of
+        /// running the object symbol tool.
+        bool mSymbolsRead;
+        ArchiveSymbols mSymbols;
         };
     bool generatedSymbols = false;
     std::vector<LibFileNames> libFileNames;
@@ -461,17 +527,33 @@ bool ObjSymbols::makeObjectSymbols(OovStringVec const &libFiles,
             std::string libFileName = // std::string(outLibPath) +
                 libName + ".a";
 */
-            if(FileStat::isOutputOld(outSymRawFileName, libFilePath, status))
+            OovString cacheHeader = getLibSymbolCacheHeader(libFilePath);
+            LibFileNames libFn(libFilePath, outSymRawFileName, libFilePath, false);
+            if(!isLibSymbolCacheValid(outSymRawFileName, cacheHeader))
                 {
-                libFileNames.push_back(LibFileNames(libFilePath, outSymRawFileName,
-                        libFilePath, true));
-                generatedSymbols = true;
+                // Reading the library directly is much faster than running
+                // the object symbol tool, but only works for ELF libraries.
+                libFn.mSymbolsRead = libFn.mSymbols.read(libFilePath);
+                if(libFn.mSymbolsRead)
+                    {
+                    writeLibSymbolCache(outSymRawFileName, cacheHeader,
+                        libFn.mSymbols);
+                    }
+                else
+                    {
+                    // The object symbol tool appends its output after the
+                    // header, so that the cache is also used for libraries
+                    // that cannot be read directly.
+                    writeLibSymbolCache(outSymRawFileName, cacheHeader,
+                        libFn.mSymbols);
+                    libFn.mGenSymbolFile = true;
+                    }
+                if(libFn.mSymbolsRead || libFn.mGenSymbolFile)
+                    {
+                    generatedSymbols = true;
+                    }
                 }
-            else
-                {
-                libFileNames.push_back(LibFileNames(libFilePath, outSymRawFileName,
-                        libFilePath, false));
-                }
+            libFileNames.push_back(std::move(libFn));
             }
         if(!status.ok())
             {
@@ -507,8 +589,14 @@ bool ObjSymbols::makeObjectSymbols(OovStringVec const &libFiles,
                     outRawFileName, ca, mListenerStdMutex, outRawFileName);
                 if(success)
                     clumpSymbols.addSymbols(libFilePath, outRawFileName);
+                else
+                    deleteLibSymbolCache(outRawFileName);
 #endif
                 }
+            else if(libFn.mSymbolsRead)
+                {
+                clumpSymbols.addSymbols(libFn.mLibFilePath, libFn.mSymbols);
+                }
             else
                 {
                 clumpSymbols.addSymbols(libFn.mLibFilePath,
@@ -26,6 +26,7 @@
 #include "Project.h"
 #include "Packages.h"
 #include "Coverage.h"
+#include "IncludeMap.h"
 #include "OovError.h"
 #include <stdio.h>
 
@@ -399,6 +400,13 @@ void OovBuilder::analyze(BuildConfigWriter &cfg,
             {
             status.report(ET_Error, "Unable to create analysis path");
             }
+        // The parsers write include dependencies to journals, so put them all
+        // into the single include map file for the readers.
+        status = compactIncDepsJournals(cfg.getIncDepsFilePath());
+        if(status.needReport())
+            {
+            status.report(ET_Error, "Unable to compact include map journals");
+            }
         }
     }
 
@@ -6,20 +6,55 @@
 #include "srcFileParser.h"
 #include "Project.h"
 #include "FilePath.h"
+#include "DirList.h"
 #include "OovProcess.h"
 #include "ComponentFinder.h"
 #include <stdio.h>
 #include <algorithm>
+#include <stdlib.h>         // For atoi
+#include <string.h>         // For strlen
+
+static OovString getCppParserCommand()
+    {
+    FilePath path(Project::getBinDirectory(), FP_Dir);
+    path.appendFile("oovCppParser");
+    return FilePathMakeExeFilename(path);
+    }
+
+// The parsers delete their precompiled headers when they exit, but the
+// files are left if a parser crashes or is killed. This is called before
+// any parsers are started, so all of the files are old.
+static void deleteOldPrecompiledHeaders(OovStringRef const analysisDir)
+    {
+    FilePath pchPath(analysisDir, FP_Dir);
+    pchPath.appendFile(PrecompiledHeaderFilePrefix "*");
+    std::vector<std::string> files;
+    // The analysis directory does not exist before the first analysis.
+    OovStatus status = getDirListMatch(pchPath, files);
+    status.clearError();
+    for(size_t i=0; i<files.size() && status.ok(); i++)
+        {
+        status = FileDelete(files[i]);
+        }
+    if(status.needReport())
+        {
+        status.report(ET_Error, "Unable to delete old precompiled headers");
+        }
+    }
 
 bool srcFileParser::analyzeSrcFiles(OovStringRef const srcRootDir,
         OovStringRef const analysisDir)
     {
     mSrcRootDir = srcRootDir;
     mAnalysisDir = analysisDir;
+    deleteOldPrecompiledHeaders(analysisDir);
+
+    mCppParserPath = getCppParserCommand();
 
 #define MULTIPLE_THREADS 1
 #if(MULTIPLE_THREADS)
-    // This requires that the oovaide-incdeps file can be updated by multiple processes.
+    // Each parser process writes a separate oovaide-incdeps journal, which
+    // is compacted by oovBuilder after all files are analyzed.
     setupQueue(getNumHardwareThreads());
 #else
     setupQueue(1);
@@ -27,9 +62,208 @@ bool srcFileParser::analyzeSrcFiles(OovStringRef const srcRootDir,
     mExcludeDirs = mComponentFinder.getProjectBuildArgs().getProjectExcludeDirs();
     OovStatus status = recurseDirs(srcRootDir);
     waitForCompletion();
+    stopServers();
     return status.ok();
     }
 
+// Use a parser server for each worker thread instead of a parser process for
+// each source file.
+#define CPP_PARSER_SERVER 1
+
+CppParserServer::~CppParserServer()
+    {
+    stop();
+    }
+
+bool CppParserServer::start(OovStringRef const procPath)
+    {
+    char const *argv[] = { procPath.getStr(), CppParserServerArg, nullptr };
+    bool success = mPipeProcess.createProcess(procPath, argv, false);
+    mProcessExited = !success;
+    if(success)
+        {
+        mListenThread = std::thread(listenThreadProc, this);
+        }
+    return success;
+    }
+
+void CppParserServer::listenThreadProc(CppParserServer *server)
+    {
+    int exitCode;
+    server->mPipeProcess.childProcessListen(*server, exitCode);
+    }
+
+bool CppParserServer::parse(CppChildArgs const &item,
+        OovProcessListener &listener, int &exitCode)
+    {
+    OovString argStr;
+    char const * const *argv = item.getArgv();
+    for(size_t i=1; i<item.getArgc(); i++)
+        {
+        if(i > 1)
+            {
+            argStr += '\t';
+            }
+        argStr += argv[i];
+        }
+    argStr += '\n';
+
+    std::unique_lock<std::mutex> lock(mJobMutex);
+    mJobListener = &listener;
+    mStdOutDone = false;
+    mStdErrDone = false;
+    lock.unlock();
+    mPipeProcess.childProcessSend(argStr);
+
+    lock.lock();
+    while(!isJobDone() && !mProcessExited)
+        {
+        mJobDoneSignal.wait(lock);
+        }
+    mJobListener = nullptr;
+    exitCode = mJobExitCode;
+    return isJobDone();
+    }
+
+void CppParserServer::stop()
+    {
+    if(isRunning())
+        {
+        // An empty line tells the parser to exit.
+        mPipeProcess.childProcessSend("\n");
+        }
+    if(mListenThread.joinable())
+        {
+        mListenThread.join();
+        }
+    mPipeProcess.childProcessClose();
+    }
+
+void CppParserServer::sendJobOutput(char const *out, size_t len, bool stdErr)
+    {
+    if(mJobListener && len > 0)
+        {
+        if(stdErr)
+            {
+            mJobListener->onStdErr(out, len);
+            }
+        else
+            {
+            mJobListener->onStdOut(out, len);
+            }
+        }
+    }
+
+// Sends the complete lines before the done string to the job listener.
+// Returns true if the done line was found, and removes the done line and
+// the output before it from the buffer.
+bool CppParserServer::takeJobOutput(OovString &buf, bool stdErr,
+        OovString &doneLine)
+    {
+    bool done = false;
+    size_t donePos = buf.find(CppParserServerDoneStr);
+    size_t endPos = std::string::npos;
+    if(donePos != std::string::npos)
+        {
+        endPos = buf.find('\n', donePos);
+        }
+    if(endPos != std::string::npos)
+        {
+        sendJobOutput(buf.getStr(), donePos, stdErr);
+        doneLine.assign(buf, donePos, endPos-donePos);
+        buf.erase(0, endPos+1);
+        done = true;
+        }
+    else if(donePos == std::string::npos)
+        {
+        // Keep the last partial line since it may be the start of the
+        // done string.
+        size_t lineEndPos = buf.rfind('\n');
+        if(lineEndPos != std::string::npos)
+            {
+            sendJobOutput(buf.getStr(), lineEndPos+1, stdErr);
+            buf.erase(0, lineEndPos+1);
+            }
+        }
+    return done;
+    }
+
+void CppParserServer::onStdOut(OovStringRef const out, size_t len)
+    {
+    std::unique_lock<std::mutex> lock(mJobMutex);
+    mStdOutBuf.append(out.getStr(), len);
+    OovString doneLine;
+    if(takeJobOutput(mStdOutBuf, false, doneLine))
+        {
+        mJobExitCode = atoi(&doneLine[strlen(CppParserServerDoneStr)]);
+        mStdOutDone = true;
+        lock.unlock();
+        mJobDoneSignal.notify_one();
+        }
+    }
+
+void CppParserServer::onStdErr(OovStringRef const out, size_t len)
+    {
+    std::unique_lock<std::mutex> lock(mJobMutex);
+    mStdErrBuf.append(out.getStr(), len);
+    OovString doneLine;
+    if(takeJobOutput(mStdErrBuf, true, doneLine))
+        {
+        mStdErrDone = true;
+        lock.unlock();
+        mJobDoneSignal.notify_one();
+        }
+    }
+
+void CppParserServer::processComplete()
+    {
+    std::unique_lock<std::mutex> lock(mJobMutex);
+    sendJobOutput(mStdOutBuf.getStr(), mStdOutBuf.length(), false);
+    sendJobOutput(mStdErrBuf.getStr(), mStdErrBuf.length(), true);
+    mStdOutBuf.clear();
+    mStdErrBuf.clear();
+    mProcessExited = true;
+    lock.unlock();
+    mJobDoneSignal.notify_one();
+    }
+
+bool srcFileParser::parseWithServer(CppChildArgs const &item,
+        OovProcessListener &listener, int &exitCode)
+    {
+    std::unique_ptr<CppParserServer> server;
+    {
+    std::lock_guard<std::mutex> lock(mIdleServersMutex);
+    if(mIdleServers.size() > 0)
+        {
+        server = std::move(mIdleServers.back());
+        mIdleServers.pop_back();
+        }
+    }
+    if(!server)
+        {
+        server.reset(new CppParserServer());
+        server->start(mCppParserPath);
+        }
+    bool success = server->isRunning() && server->parse(item, listener, exitCode);
+    // If the parser stopped, the next source file will start a new server.
+    if(server->isRunning())
+        {
+        std::lock_guard<std::mutex> lock(mIdleServersMutex);
+        mIdleServers.push_back(std::move(server));
+        }
+    return success;
+    }
+
+void srcFileParser::stopServers()
+    {
+    std::lock_guard<std::mutex> lock(mIdleServersMutex);
+    for(auto &server : mIdleServers)
+        {
+        server->stop();
+        }
+    mIdleServers.clear();
+    }
+
 VerboseDumper sVerboseDump;
 
 void VerboseDumper::open(OovStringRef const outPath)
@@ -138,11 +372,7 @@ static void getAnalysisToolCommand(FilePath const &filePath,
         }
     else
         {
-        OovString command;
-        FilePath path(Project::getBinDirectory(), FP_Dir);
-        path.appendFile("oovCppParser");
-        command = FilePathMakeExeFilename(path);
-        args.addArg(command);
+        args.addArg(getCppParserCommand());
         }
     }
 
@@ -234,8 +464,18 @@ bool srcFileParser::processItem(CppChildArgs const &item)
     printf("%s", processStr.getStr());
     fflush(stdout);
     listener.setProcessIdStr(processStr);
-    bool success = pipeProc.spawn(item.getArgv()[0], item.getArgv(),
+    bool success;
+#if(CPP_PARSER_SERVER)
+    if(mCppParserPath == item.getArgv()[0])
+        {
+        success = parseWithServer(item, listener, exitCode);
+        }
+    else
+#endif
+        {
+        success = pipeProc.spawn(item.getArgv()[0], item.getArgv(),
             listener, exitCode);
+        }
     if(!success || exitCode != 0)
         {
         OovString tempStr;
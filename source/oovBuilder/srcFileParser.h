@@ -7,6 +7,10 @@
 #include "ComponentFinder.h"
 #include <map>
 #include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 #include "Debug.h"
 #include "OovThreadedWaitQueue.h"
 
@@ -24,6 +28,61 @@ class VerboseDumper
 extern VerboseDumper sVerboseDump;
 
 
+/// A long running oovCppParser that is sent the arguments for one source
+/// file at a time through standard input. This prevents starting a process
+/// and creating a clang index for every source file.
+class CppParserServer:public OovProcessListener
+    {
+    public:
+        CppParserServer():
+            mJobListener(nullptr), mStdOutDone(false), mStdErrDone(false),
+            mJobExitCode(0), mProcessExited(true)
+            {}
+        virtual ~CppParserServer();
+        /// Starts the parser process.
+        /// @param procPath The path to oovCppParser.
+        bool start(OovStringRef const procPath);
+        /// Returns true if the parser process is still running.
+        bool isRunning() const
+            { return !mProcessExited; }
+        /// Sends the arguments for one source file to the parser and waits
+        /// until the parser is done with the file.
+        /// @param item The arguments. The first argument (the process path)
+        ///     is not sent.
+        /// @param listener The listener for output from the parser.
+        /// @param exitCode The exit code for the source file.
+        /// Returns false if the parser process stopped during parsing.
+        bool parse(CppChildArgs const &item, OovProcessListener &listener,
+                int &exitCode);
+        /// Tells the parser to exit and waits for it.
+        void stop();
+
+    private:
+        OovPipeProcess mPipeProcess;
+        std::thread mListenThread;
+        std::mutex mJobMutex;
+        std::condition_variable mJobDoneSignal;
+        OovProcessListener *mJobListener;
+        OovString mStdOutBuf;
+        OovString mStdErrBuf;
+        /// The job is done when the done string is received on both
+        /// standard output and standard error, so that all of the errors
+        /// for a source file are sent to the listener for that file.
+        bool mStdOutDone;
+        bool mStdErrDone;
+        int mJobExitCode;
+        bool mProcessExited;
+
+        virtual void onStdOut(OovStringRef const out, size_t len) override;
+        virtual void onStdErr(OovStringRef const out, size_t len) override;
+        virtual void processComplete() override;
+        bool isJobDone() const
+            { return(mStdOutDone && mStdErrDone); }
+        void sendJobOutput(char const *out, size_t len, bool stdErr);
+        bool takeJobOutput(OovString &buf, bool stdErr, OovString &doneLine);
+        static void listenThreadProc(CppParserServer *server);
+    };
+
 /// Recursively finds source files, and parses the source file
 /// for static information, and saves into analysis files.
 class srcFileParser:public dirRecurser, public ThreadedWorkWaitQueue<CppChildArgs, srcFileParser>
@@ -45,7 +104,15 @@ private:
     char const * mAnalysisDir;
     OovStringVec mExcludeDirs;
     ComponentFinder &mComponentFinder;
+    OovString mCppParserPath;
+    /// Parser servers that are not in use by a worker thread. There is at
+    /// most one server for each worker thread.
+    std::vector<std::unique_ptr<CppParserServer>> mIdleServers;
+    std::mutex mIdleServersMutex;
 
     virtual bool processFile(OovStringRef const filePath) override;
+    bool parseWithServer(CppChildArgs const &item,
+            OovProcessListener &listener, int &exitCode);
+    void stopServers();
 };
 
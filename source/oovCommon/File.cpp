@@ -11,6 +11,7 @@
 #include <fcntl.h>
 #ifdef __linux__
 #include <sys/file.h>   // for flock
+#include <sys/mman.h>   // for mmap
 #else
 #include <share.h>
 #include <io.h>         // For _sopen_s - in Windows, mingw-builds is required.
@@ -218,3 +219,69 @@ eOpenStatus SharedFile::open(OovStringRef const fn, eOpenModes mode,
         }
     return status;
     }
+
+bool MappedFile::open(OovStringRef const fn)
+    {
+    close();
+#ifdef __linux__
+    int fd = ::open(fn, O_RDONLY);
+    bool success = (fd != -1);
+    if(success)
+        {
+        struct stat fileStat;
+        success = (fstat(fd, &fileStat) == 0);
+        if(success && fileStat.st_size > 0)
+            {
+            void *data = mmap(nullptr, static_cast<size_t>(fileStat.st_size),
+                PROT_READ, MAP_PRIVATE, fd, 0);
+            success = (data != MAP_FAILED);
+            if(success)
+                {
+                mData = static_cast<unsigned char const *>(data);
+                mSize = static_cast<size_t>(fileStat.st_size);
+                }
+            }
+        // The mapping stays valid after the file is closed.
+        ::close(fd);
+        }
+#else
+    File file;
+    OovStatus status = file.open(fn, "rb");
+    if(status.ok())
+        {
+        int size;
+        status = file.getFileSize(size);
+        if(status.ok() && size > 0)
+            {
+            mBuffer.resize(static_cast<size_t>(size));
+            size_t readSize = fread(&mBuffer[0], 1, mBuffer.size(), file.getFp());
+            if(readSize == mBuffer.size())
+                {
+                mData = &mBuffer[0];
+                mSize = mBuffer.size();
+                }
+            else
+                {
+                status.set(false, SC_File);
+                }
+            }
+        }
+    bool success = status.ok();
+    status.clearError();
+#endif
+    return success;
+    }
+
+void MappedFile::close()
+    {
+#ifdef __linux__
+    if(mData)
+        {
+        munmap(const_cast<unsigned char *>(mData), mSize);
+        }
+#else
+    mBuffer.clear();
+#endif
+    mData = nullptr;
+    mSize = 0;
+    }
@@ -12,6 +12,7 @@
 #include "OovError.h"
 #include <stdio.h>
 #include <sys/stat.h>
+#include <vector>
 #define __NO_MINGW_LFS 1
 
 
@@ -210,4 +211,30 @@ class SharedFile: public BaseSimpleFile
                 eOpenEndings oe=OE_Text);
     };
 
+/// This is a read only view of a whole file. On Linux the file is memory
+/// mapped, and on other systems, the file is read into memory.
+class MappedFile
+    {
+    public:
+        MappedFile():
+            mData(nullptr), mSize(0)
+            {}
+        ~MappedFile()
+            { close(); }
+        /// Returns false if the file could not be opened or mapped.
+        bool open(OovStringRef const fn);
+        void close();
+        unsigned char const *getData() const
+            { return mData; }
+        size_t getSize() const
+            { return mSize; }
+
+    private:
+        unsigned char const *mData;
+        size_t mSize;
+#ifndef __linux__
+        std::vector<unsigned char> mBuffer;
+#endif
+    };
+
 #endif /* FILE_H_ */
@@ -9,7 +9,10 @@
 #include "Components.h"         // For isHeader
 #include "Debug.h"
 #include "OovError.h"
+#include "DirList.h"
 #include <algorithm>
+#include <limits>
+#include <limits.h>     // For INT_MAX
 
 OovStatusReturn IncDirDependencyMapReader::read(OovStringRef const fn)
     {
@@ -20,6 +23,11 @@ OovStatusReturn IncDirDependencyMapReader::read(OovStringRef const fn)
         {
         status = readFile();
         }
+    if(status.ok())
+        {
+        OovStringVec journalFns;
+        status = mergeIncDepsJournals(*this, journalFns);
+        }
     if(status.needReport())
         {
         OovString str = "Unable to read include map: ";
@@ -29,6 +37,130 @@ OovStatusReturn IncDirDependencyMapReader::read(OovStringRef const fn)
     return status;
     }
 
+OovString getIncDepsJournalFilename(OovStringRef const incDepsFn,
+    OovStringRef const journalId)
+    {
+    FilePath fn(incDepsFn, FP_File);
+    fn.discardExtension();
+    // The wildcard match only allows an asterisk at the end of the name,
+    // so the journal files do not have an extension.
+    fn += "-journal-";
+    fn += journalId;
+    return fn;
+    }
+
+/// The changed time is the first value of the included information.
+static int getIncDepsChangedTime(OovStringRef const incInfoStr)
+    {
+    OovString incInfo = incInfoStr;
+    int changedTime = 0;
+    size_t pos = incInfo.find(';');
+    if(pos != std::string::npos)
+        {
+        OovString timeStr = incInfo.substr(0, pos);
+        if(!timeStr.getInt(0, INT_MAX, changedTime))
+            {
+            changedTime = 0;
+            }
+        }
+    return changedTime;
+    }
+
+static OovStatusReturn mergeIncDepsJournal(OovStringRef const journalFn,
+        NameValueFile &incDepsMap)
+    {
+    SharedFile file;
+    OovStatus status(true, SC_File);
+    eOpenStatus openStat = file.open(journalFn, M_ReadShared);
+    if(openStat == OS_Opened)
+        {
+        std::string buf(file.getSize(), 0);
+        int actualSize;
+        status = file.read(&buf[0], static_cast<int>(buf.size()), actualSize);
+        if(status.ok())
+            {
+            buf.resize(static_cast<size_t>(actualSize));
+            // Discard any partial line that is still being written.
+            size_t endPos = buf.rfind('\n');
+            if(endPos != std::string::npos)
+                {
+                buf.resize(endPos+1);
+                }
+            else
+                {
+                buf.clear();
+                }
+            // A journal is only appended by a single process, so later
+            // lines in the journal replace earlier lines.
+            NameValueRecord journal;
+            journal.insertBufToMap(buf);
+            for(auto const &nameVal : journal.getNameValues())
+                {
+                OovString origVal = incDepsMap.getValue(nameVal.first);
+                if(origVal.length() == 0 ||
+                    getIncDepsChangedTime(nameVal.second) >=
+                    getIncDepsChangedTime(origVal))
+                    {
+                    incDepsMap.setNameValue(nameVal.first, nameVal.second);
+                    }
+                }
+            }
+        }
+    else if(openStat != OS_NoFile)
+        {
+        status.set(false, SC_File);
+        }
+    return status;
+    }
+
+OovStatusReturn mergeIncDepsJournals(NameValueFile &incDepsMap,
+    OovStringVec &journalFns)
+    {
+    OovStatus status(true, SC_File);
+    std::vector<std::string> fns;
+    OovStatus dirStatus = getDirListMatch(getIncDepsJournalFilename(
+        incDepsMap.getFilename(), "*"), fns);
+    // It is ok if the directory is not present, since then there are no
+    // journals.
+    dirStatus.clearError();
+    for(auto const &fn : fns)
+        {
+        status = mergeIncDepsJournal(fn, incDepsMap);
+        if(!status.ok())
+            {
+            break;
+            }
+        journalFns.push_back(fn);
+        }
+    return status;
+    }
+
+OovStatusReturn compactIncDepsJournals(OovStringRef const incDepsFn)
+    {
+    NameValueFile incDepsMap(incDepsFn);
+    OovStringVec journalFns;
+    OovStatus status(true, SC_File);
+        {
+        SharedFile file;
+        status = incDepsMap.writeFileExclusiveReadUpdate(file);
+        if(status.ok())
+            {
+            status = mergeIncDepsJournals(incDepsMap, journalFns);
+            }
+        if(status.ok() && journalFns.size() > 0)
+            {
+            status = incDepsMap.writeFileExclusive(file);
+            }
+        }
+    // The journals are only deleted after the include map file has all of
+    // their values.
+    for(size_t i=0; i<journalFns.size() && status.ok(); i++)
+        {
+        status = FileDelete(journalFns[i]);
+        }
+    return status;
+    }
+
 void discardDirs(OovStringVec &paths)
     {
     for(auto &fn : paths)
@@ -340,11 +472,16 @@ class DirInfo
 OovStringVec IncDirDependencyMapReader::getOrderedIncludeDirsForSourceFile(OovStringRef const absSrcName,
         OovStringVec const &orderedIncRoots) const
     {
+    return getOrderedIncludeDirs(getNestedIncludeDirsUsedBySourceFile(absSrcName),
+        orderedIncRoots);
+    }
+
+OovStringVec IncDirDependencyMapReader::getOrderedIncludeDirs(
+        OovStringVec const &unorderedIncDirs, OovStringVec const &orderedIncRoots)
+    {
     OovStringVec incDirs;
     // put directories in search path order.
     std::vector<DirInfo> unorderedDirInfo;
-    std::vector<OovString> unorderedIncDirs =
-            getNestedIncludeDirsUsedBySourceFile(absSrcName);
     unorderedDirInfo.resize(unorderedIncDirs.size());
     // Go through all directories and for each, find the longest root directory that matches.
     for(size_t incDirI = 0; incDirI < unorderedIncDirs.size(); incDirI++)
@@ -386,3 +523,194 @@ OovStringVec IncDirDependencyMapReader::getOrderedIncludeDirsForSourceFile(OovSt
     return incDirs;
     }
 
+
+//////////////
+
+IncDirDependencyClosure::FileId IncDirDependencyClosure::getFileId(
+        IncludedPath const &path)
+    {
+    auto const ret = mFileIds.insert(std::make_pair(path.getFullPath(),
+        mFiles.size()));
+    if(ret.second)
+        {
+        mFiles.push_back(IncFile(path.getFullPath()));
+        }
+    return (*ret.first).second;
+    }
+
+void IncDirDependencyClosure::visitFile(FileId fileId)
+    {
+    mFiles[fileId].mVisitIndex = mNextVisitIndex;
+    mFiles[fileId].mLowLink = mNextVisitIndex;
+    mNextVisitIndex++;
+    mVisitStack.push_back(fileId);
+    mFiles[fileId].mOnStack = true;
+
+    // Each file's includes are parsed from the include map only once.
+    std::set<IncludedPath> incFiles;
+    mIncMap.getImmediateIncludeFilesUsedBySourceFile(
+        mFiles[fileId].mFullPath, incFiles);
+    for(auto const &incFile : incFiles)
+        {
+        // Adding a file can move the other files.
+        FileId incId = getFileId(incFile);
+        mFiles[fileId].mImmediateFiles.push_back(incId);
+        mFiles[fileId].mImmediateDirs.insert(incFile.getIncDir());
+        }
+    for(size_t i=0; i<mFiles[fileId].mImmediateFiles.size(); i++)
+        {
+        FileId incId = mFiles[fileId].mImmediateFiles[i];
+        if(mFiles[incId].mVisitIndex == NoIndex)
+            {
+            visitFile(incId);
+            mFiles[fileId].mLowLink = std::min(mFiles[fileId].mLowLink,
+                mFiles[incId].mLowLink);
+            }
+        else if(mFiles[incId].mOnStack)
+            {
+            mFiles[fileId].mLowLink = std::min(mFiles[fileId].mLowLink,
+                mFiles[incId].mVisitIndex);
+            }
+        }
+    if(mFiles[fileId].mLowLink == mFiles[fileId].mVisitIndex)
+        {
+        addGroup(fileId);
+        }
+    }
+
+void IncDirDependencyClosure::addGroup(FileId rootFileId)
+    {
+    size_t groupIndex = mGroups.size();
+    mGroups.push_back(IncGroup());
+    std::vector<FileId> members;
+    FileId memberId;
+    do
+        {
+        memberId = mVisitStack.back();
+        mVisitStack.pop_back();
+        mFiles[memberId].mOnStack = false;
+        mFiles[memberId].mGroupIndex = groupIndex;
+        members.push_back(memberId);
+        } while(memberId != rootFileId);
+
+    // All groups that are included by this group are already complete, so
+    // the nested files are the included files and their nested files.
+    std::vector<FileId> nestedFiles;
+    IncGroup &group = mGroups[groupIndex];
+    for(auto const &member : members)
+        {
+        group.mNestedDirs.insert(mFiles[member].mImmediateDirs.begin(),
+            mFiles[member].mImmediateDirs.end());
+        for(auto const &incId : mFiles[member].mImmediateFiles)
+            {
+            size_t incGroupIndex = mFiles[incId].mGroupIndex;
+            nestedFiles.push_back(incId);
+            if(incGroupIndex != groupIndex)
+                {
+                IncGroup const &incGroup = mGroups[incGroupIndex];
+                nestedFiles.insert(nestedFiles.end(),
+                    incGroup.mNestedFiles.begin(), incGroup.mNestedFiles.end());
+                group.mNestedDirs.insert(incGroup.mNestedDirs.begin(),
+                    incGroup.mNestedDirs.end());
+                }
+            else
+                {
+                // A file in an include cycle includes all files in the cycle.
+                nestedFiles.insert(nestedFiles.end(), members.begin(),
+                    members.end());
+                }
+            }
+        }
+    std::sort(nestedFiles.begin(), nestedFiles.end());
+    nestedFiles.erase(std::unique(nestedFiles.begin(), nestedFiles.end()),
+        nestedFiles.end());
+    group.mNestedFiles.swap(nestedFiles);
+    }
+
+IncDirDependencyClosure::IncGroup &IncDirDependencyClosure::getGroup(
+        OovStringRef const srcName)
+    {
+    FilePath fp(srcName, FP_File);
+    FileId fileId = getFileId(IncludedPath("", fp));
+    if(mFiles[fileId].mGroupIndex == NoIndex)
+        {
+        visitFile(fileId);
+        }
+    return mGroups[mFiles[fileId].mGroupIndex];
+    }
+
+void IncDirDependencyClosure::getNestedIncludeFiles(OovStringRef const srcName,
+        OovStringVec &incFiles)
+    {
+    for(auto const &fileId : getGroup(srcName).mNestedFiles)
+        {
+        incFiles.push_back(mFiles[fileId].mFullPath);
+        }
+    }
+
+OovStringVec IncDirDependencyClosure::getNestedIncludeDirs(
+        OovStringRef const srcName)
+    {
+    OovStringSet const &nestedDirs = getGroup(srcName).mNestedDirs;
+    OovStringVec incDirs(nestedDirs.size());
+    std::copy(nestedDirs.begin(), nestedDirs.end(), incDirs.begin());
+    return incDirs;
+    }
+
+time_t IncDirDependencyClosure::getFileTime(FileId fileId)
+    {
+    IncFile &file = mFiles[fileId];
+    if(!file.mTimeRead)
+        {
+        OovStatus status = FileGetFileTime(file.mFullPath, file.mTime);
+        if(!status.ok())
+            {
+            // A missing file is newer than any output so that the compiler
+            // can report it.
+            file.mTime = std::numeric_limits<time_t>::max();
+            status.clearError();
+            }
+        file.mTimeRead = true;
+        }
+    return file.mTime;
+    }
+
+bool IncDirDependencyClosure::isOutputOld(OovStringRef const outputFn,
+        OovStringRef const srcName, OovString &newestFn)
+    {
+    IncGroup &group = getGroup(srcName);
+    if(!group.mNewestTimeFound)
+        {
+        time_t newestTime = 0;
+        for(auto const &fileId : group.mNestedFiles)
+            {
+            time_t fileTime = getFileTime(fileId);
+            if(group.mNewestFile == NoIndex || fileTime > newestTime)
+                {
+                newestTime = fileTime;
+                group.mNewestFile = fileId;
+                }
+            }
+        group.mNewestTimeFound = true;
+        }
+    bool old = false;
+    if(group.mNewestFile != NoIndex)
+        {
+        time_t outTime = 0;
+        OovStatus status = FileGetFileTime(outputFn, outTime);
+        if(status.ok())
+            {
+            old = getFileTime(group.mNewestFile) > outTime;
+            }
+        else
+            {
+            old = true;
+            status.clearError();
+            }
+        if(old)
+            {
+            newestFn = mFiles[group.mNewestFile].mFullPath;
+            }
+        }
+    return old;
+    }
@@ -10,6 +10,9 @@
 
 #include <string>
 #include <set>
+#include <vector>
+#include <unordered_map>
+#include <time.h>
 #include "NameValueFile.h"
 
 static const int IncDirMapNumTimeVals = 2;
@@ -54,11 +57,33 @@ struct IncludedPath
 
 void discardDirs(OovStringVec &dirs);
 
+/// The oovCppParser processes append their changed include dependencies to
+/// journal files instead of locking and rewriting the whole include map file.
+/// There is a journal file for each parser process, and they are compacted
+/// into the include map file by oovBuilder when the analysis is complete.
+/// @param incDepsFn The include map file name.
+/// @param journalId A string that is unique for each journal writer, or "*"
+///     to match all journals.
+OovString getIncDepsJournalFilename(OovStringRef const incDepsFn,
+    OovStringRef const journalId);
+
+/// Merge the journal files into the include map. If an includer is in more
+/// than one place, the value with the newest changed time is kept.
+/// @param incDepsMap The include map. The file name must be set.
+/// @param journalFns The returned journal file names that were merged.
+OovStatusReturn mergeIncDepsJournals(NameValueFile &incDepsMap,
+    OovStringVec &journalFns);
+
+/// Merge the journal files into the include map file, and delete them.
+/// @param incDepsFn The include map file name.
+OovStatusReturn compactIncDepsJournals(OovStringRef const incDepsFn);
+
 /// See the oovCppParser project for a definition of the file that this reads.
 class IncDirDependencyMapReader:public NameValueFile
     {
     public:
-        /// Read the include dependency map file
+        /// Read the include dependency map file. This also reads any journal
+        /// files that have not been compacted into the map file.
         /// @param fn The file name to read from
         OovStatusReturn read(OovStringRef const fn);
         /// Get the include files that are directly included in the source file.
@@ -107,6 +132,12 @@ class IncDirDependencyMapReader:public NameValueFile
         OovStringVec getOrderedIncludeDirsForSourceFile(
                 OovStringRef const srcName,
                 OovStringVec const &orderedIncRoots) const;
+        /// Sort include directories by the ordered include root directories.
+        /// @param unorderedIncDirs The include directories used by a file.
+        /// @param orderedIncRoots The ordered include root directories.
+        static OovStringVec getOrderedIncludeDirs(
+                OovStringVec const &unorderedIncDirs,
+                OovStringVec const &orderedIncRoots);
         OovStringVec getFilesDefinedInDirectory(
                 OovStringRef const dirName) const;
 
@@ -130,4 +161,92 @@ class IncDirDependencyMapReader:public NameValueFile
         OovStringVec getJavaExpandedFiles(OovStringRef const incPath) const;
     };
 
+/// This finds the nested include files of many source files without walking
+/// the same headers for every source file.  The included files of every file
+/// that is walked are saved, and include cycles are collapsed so that all
+/// files in a cycle share the same included files.  The modified time of each
+/// file is only read once, so this should only be used for a single build.
+/// This is not thread safe.
+class IncDirDependencyClosure
+    {
+    public:
+        /// @param incMap The include map. This must be read before any of
+        ///     the other functions are called.
+        IncDirDependencyClosure(IncDirDependencyMapReader const &incMap):
+            mIncMap(incMap), mNextVisitIndex(0)
+            {}
+        /// Get all included files used by a source file.
+        /// @param srcName The source file name
+        /// @param incFiles The returned list of included files
+        void getNestedIncludeFiles(OovStringRef const srcName,
+                OovStringVec &incFiles);
+        /// Get the nested include directories that are used by a source file.
+        /// This returns the include directories of every #include, so if a
+        /// file is included with different include directories, then all of
+        /// them are returned.
+        /// @param srcName The source file name.
+        OovStringVec getNestedIncludeDirs(OovStringRef const srcName);
+        /// Check if any file included by a source file is newer than the
+        /// output file. This does not return an error if the output or included
+        /// files do not exist. It just indicates that the output file is old.
+        /// @param outputFn The output file made from the source file.
+        /// @param srcName The source file name. The modified time of the
+        ///     source file is not checked unless the source file includes itself.
+        /// @param newestFn The returned newest included file if the output
+        ///     file is old.
+        bool isOutputOld(OovStringRef const outputFn, OovStringRef const srcName,
+                OovString &newestFn);
+
+    private:
+        typedef size_t FileId;
+        static const size_t NoIndex = static_cast<size_t>(-1);
+        /// A file in the include graph.
+        struct IncFile
+            {
+            IncFile(OovString const &fullPath):
+                mFullPath(fullPath), mVisitIndex(NoIndex), mLowLink(0),
+                mOnStack(false), mGroupIndex(NoIndex), mTimeRead(false),
+                mTime(0)
+                {}
+            OovString mFullPath;
+            std::vector<FileId> mImmediateFiles;
+            OovStringSet mImmediateDirs;
+            size_t mVisitIndex;
+            size_t mLowLink;
+            bool mOnStack;
+            size_t mGroupIndex;
+            bool mTimeRead;
+            time_t mTime;
+            };
+        /// A group of files that include each other, or a single file.
+        struct IncGroup
+            {
+            IncGroup():
+                mNewestTimeFound(false), mNewestFile(NoIndex)
+                {}
+            /// Sorted list of all files that are included by the group.
+            std::vector<FileId> mNestedFiles;
+            /// All include directories used by the group and nested files.
+            OovStringSet mNestedDirs;
+            bool mNewestTimeFound;
+            FileId mNewestFile;
+            };
+        IncDirDependencyMapReader const &mIncMap;
+        std::vector<IncFile> mFiles;
+        std::unordered_map<std::string, FileId> mFileIds;
+        std::vector<IncGroup> mGroups;
+        std::vector<FileId> mVisitStack;
+        size_t mNextVisitIndex;
+
+        FileId getFileId(IncludedPath const &path);
+        /// This finds the groups of files that include each other (strongly
+        /// connected components), and saves the nested files of each group.
+        /// This is recursive.
+        void visitFile(FileId fileId);
+        void addGroup(FileId rootFileId);
+        /// Returns the group that has the nested files for the source file.
+        IncGroup &getGroup(OovStringRef const srcName);
+        time_t getFileTime(FileId fileId);
+    };
+
 #endif /* INCLUDEMAP_H_ */
@@ -447,6 +447,14 @@ void ModelData::clear()
     mModules.clear();
     mAssociations.clear();
     mTypes.clear();
+    mTypeNameIndex.clear();
+    mDuplicateNameTypes.clear();
+    mTemplateDefIndex.clear();
+    mTypePositions.clear();
+    mTypeReferrers.clear();
+    mTypesSorted = true;
+    mTypeReferrersIndexed = false;
+    operReferencesChanged();
     }
 
 void ModelData::dumpTypes()
@@ -467,14 +475,13 @@ void ModelData::dumpTypes()
 
 const ModelType *ModelData::getTypeRef(OovStringRef const typeName) const
     {
-    OovString baseTypeName = getBaseType(typeName);
-    return findType(baseTypeName);
+    return findType(typeName);
     }
 
 ModelType *ModelData::createOrGetTypeRef(OovStringRef const typeName, eModelDataTypes dtype)
     {
     std::string baseTypeName = getBaseType(typeName);
-    ModelType *type = findType(baseTypeName);
+    ModelType *type = findBaseType(baseTypeName);
     if(!type)
         {
         type = static_cast<ModelType*>(createDataType(dtype, baseTypeName));
@@ -633,20 +640,131 @@ static inline bool compareStrs(OovStringRef const tstr1, OovStringRef const tstr
     return (strcmp(tstr1, tstr2) < 0);
     }
 
-#define BINARYSPEED 1
+static OovString getTemplateDefBaseName(OovString const &name)
+    {
+    OovString templName;
+    if(ModelType::isTemplateDefType(name))
+        {
+        size_t pos = name.find('<');
+        templName = name.substr(0, pos);
+        }
+    return templName;
+    }
 
 void ModelData::addType(std::unique_ptr<ModelType> &&type)
     {
-#if(BINARYSPEED)
     std::string baseTypeName = getBaseType(type->getName());
     type->setName(baseTypeName);
-    auto it = std::upper_bound(mTypes.begin(), mTypes.end(), baseTypeName,
-        [](OovStringRef const mod1Name, std::unique_ptr<ModelType> &mod2) -> bool
-        { return(compareStrs(mod1Name, mod2->getName())); } );
-    mTypes.insert(it, std::move(type));
-#else
-    mTypes.push_back(type);
-#endif
+    ModelType *newType = type.get();
+    if(mTypes.size() > 0 && compareStrs(baseTypeName, mTypes.back()->getName()))
+        {
+        mTypesSorted = false;
+        }
+    mTypePositions[newType] = mTypes.size();
+    mTypes.push_back(std::move(type));
+    indexTypeName(newType);
+    }
+
+void ModelData::sortTypes()
+    {
+    if(!mTypesSorted)
+        {
+        // A stable sort keeps types with the same name in the order they
+        // were added, so the first one is the one in mTypeNameIndex.
+        std::stable_sort(mTypes.begin(), mTypes.end(),
+            [](std::unique_ptr<ModelType> const &type1,
+                std::unique_ptr<ModelType> const &type2) -> bool
+            { return(compareStrs(type1->getName(), type2->getName())); } );
+        for(size_t i=0; i<mTypes.size(); i++)
+            {
+            mTypePositions[mTypes[i].get()] = i;
+            }
+        mTypesSorted = true;
+        }
+    }
+
+void ModelData::indexTypeName(ModelType *type)
+    {
+    auto nameResult = mTypeNameIndex.insert(std::make_pair(type->getName(), type));
+    if(!nameResult.second)
+        {
+        mDuplicateNameTypes.push_back(type);
+        }
+    if(type->isTemplateDefType())
+        {
+        indexTemplateDef(type);
+        }
+    }
+
+void ModelData::indexTemplateDef(ModelType *type)
+    {
+    // If there are multiple definitions, use the first in sorted order.
+    auto templResult = mTemplateDefIndex.insert(std::make_pair(
+        getTemplateDefBaseName(type->getName()), type));
+    if(!templResult.second && compareStrs(type->getName(),
+            (*templResult.first).second->getName()))
+        {
+        (*templResult.first).second = type;
+        }
+    }
+
+void ModelData::unindexTypeName(ModelType *type)
+    {
+    auto nameIter = mTypeNameIndex.find(type->getName());
+    if(nameIter != mTypeNameIndex.end() && (*nameIter).second == type)
+        {
+        // Use the next oldest type with the same name if there is one.
+        auto dupIter = std::find_if(mDuplicateNameTypes.begin(),
+            mDuplicateNameTypes.end(), [type](ModelType const *dupType)
+            { return(dupType->getName() == type->getName()); });
+        if(dupIter != mDuplicateNameTypes.end())
+            {
+            (*nameIter).second = *dupIter;
+            mDuplicateNameTypes.erase(dupIter);
+            }
+        else
+            {
+            mTypeNameIndex.erase(nameIter);
+            }
+        }
+    else
+        {
+        auto dupIter = std::find(mDuplicateNameTypes.begin(),
+            mDuplicateNameTypes.end(), type);
+        if(dupIter != mDuplicateNameTypes.end())
+            {
+            mDuplicateNameTypes.erase(dupIter);
+            }
+        }
+    if(type->isTemplateDefType())
+        {
+        OovString templName = getTemplateDefBaseName(type->getName());
+        auto templIter = mTemplateDefIndex.find(templName);
+        if(templIter != mTemplateDefIndex.end() && (*templIter).second == type)
+            {
+            // This is rare, so search for another definition.
+            mTemplateDefIndex.erase(templIter);
+            for(auto const &otherType : mTypes)
+                {
+                if(otherType.get() != type && otherType->isTemplateDefType() &&
+                        getTemplateDefBaseName(otherType->getName()) == templName)
+                    {
+                    indexTemplateDef(otherType.get());
+                    }
+                }
+            }
+        }
+    }
+
+ModelType *ModelData::findBaseType(std::string const &baseTypeName) const
+    {
+    ModelType *type = nullptr;
+    auto iter = mTypeNameIndex.find(baseTypeName);
+    if(iter != mTypeNameIndex.end())
+        {
+        type = (*iter).second;
+        }
+    return type;
     }
 
 /*
@@ -664,30 +782,7 @@ static OovString getTemplateUseBaseName(OovString const &name)
 
 const ModelType *ModelData::findType(OovStringRef const name) const
     {
-    const ModelType *type = nullptr;
-#if(BINARYSPEED)
-    // This comparison must produce the same sort order as addType.
-    std::string baseTypeName = getBaseType(name);
-    auto iter = std::lower_bound(mTypes.begin(), mTypes.end(), baseTypeName,
-        [](std::unique_ptr<ModelType> const &mod1, OovStringRef const mod2Name) -> bool
-        { return(compareStrs(mod1->getName(), mod2Name)); } );
-    if(iter != mTypes.end())
-        {
-        if(baseTypeName.compare((*iter)->getName()) == 0)
-            type = (*iter).get();
-        }
-#else
-    std::string baseTypeName = getBaseType(name);
-    for(auto &iterType : mTypes)
-        {
-        if(iterType->getName().compare(baseTypeName) == 0)
-            {
-            type = iterType;
-            break;
-            }
-        }
-#endif
-    return type;
+    return findBaseType(getBaseType(name));
     }
 
 ModelType *ModelData::findType(OovStringRef const name)
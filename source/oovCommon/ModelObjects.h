@@ -26,6 +26,8 @@
 #include <list>
 #include <vector>
 #include <memory>
+#include <unordered_map>
+#include <unordered_set>
 #include <string.h>
 #include "OovString.h"
 
@@ -139,9 +141,13 @@ class ModelTypeRef
         /// @param id The declaration type model id
         void setDeclTypeModelId(int id)
             { mDeclTypeModelId = static_cast<unsigned int>(id); }
-        /// Get the model id during file loading
+        /// Get the model id during file loading. This is UNDEFINED_ID after
+        /// the model type is resolved.
         int getDeclTypeModelId() const
-            { return mDeclTypeModelId; }
+            {
+            return(mDeclTypeModelId == UndefinedDeclTypeModelId ? UNDEFINED_ID :
+                static_cast<int>(mDeclTypeModelId));
+            }
         /// Check if the relation is const
         bool isConst() const
             { return mConst; }
@@ -152,6 +158,8 @@ class ModelTypeRef
         bool match(ModelTypeRef const &typeRef) const;
 
     private:
+        /// UNDEFINED_ID is stored as all bits set in the id bit field.
+        static unsigned int const UndefinedDeclTypeModelId = (1 << 29) - 1;
         ModelType const *mDeclType;
         unsigned int mDeclTypeModelId:29;
 //        unsigned int mStatic:1;
@@ -637,7 +645,7 @@ public:
         const ModelClassifier *parent, Visibility access):
         ModelObject(""),
         mChildModelId(UNDEFINED_ID), mParentModelId(UNDEFINED_ID),
-        mChild(child), mParent(parent), mAccess(access)
+        mChild(child), mParent(parent), mAccess(access), mModule(nullptr)
         {}
     /// Set the id of the child
     void setChildModelId(int id)
@@ -669,6 +677,12 @@ public:
     /// Set the class of the parent part of the relation
     void setParentClass(const ModelClassifier *cl)
         { mParent = cl; }
+    /// Set the module of the file that the relation was loaded from.
+    void setModule(const class ModelModule *module)
+        { mModule = module; }
+    /// Get the module of the file that the relation was loaded from.
+    const class ModelModule *getModule() const
+        { return mModule; }
 
 private:
     int mChildModelId;
@@ -676,6 +690,7 @@ private:
     const ModelClassifier *mChild;
     const ModelClassifier *mParent;
     Visibility mAccess;
+    const class ModelModule *mModule;
 };
 
 /// There can be code and comments on the same lines. There can also
@@ -761,12 +776,39 @@ class ConstModelClassifierVector:public std::vector<ModelClassifier const *>
         bool addUnique(ModelClassifier const *cl);
     };
 
+/// An operation and the class that contains the operation. This is used to
+/// find the operations that call an operation or refer to an attribute.
+struct ModelOperReference
+    {
+    ModelOperReference(ModelClassifier const *cls, ModelOperation const *oper):
+        mClass(cls), mOper(oper), mVarRef(false)
+        {}
+    ModelClassifier const *mClass;
+    ModelOperation const *mOper;
+    /// True if the operation has a variable reference to the attribute.
+    /// False if the attribute is only used to call a function.
+    bool mVarRef;
+    };
+typedef std::vector<ModelOperReference> ModelOperReferences;
 
 /// Holds all data used to make class and sequence diagrams. This data is read
 /// from the XMI files.
+///
+/// The types are indexed by name so that finding a type does not depend on
+/// the number of types. The types are appended as they are added, and
+/// sortTypes() puts them in name order. The pointer references to types can
+/// also be indexed so that replacing a type only touches the references to
+/// the type. See indexTypeReferences().
+///
+/// The callers of operations and the references to attributes are indexed
+/// when they are first needed. See getOperCallers().
 class ModelData
     {
     public:
+        ModelData():
+            mTypesSorted(true), mTypeReferrersIndexed(false),
+            mOperReferencesIndexed(false)
+            {}
         std::vector<std::unique_ptr<ModelType>> mTypes;                 // Some of these (otClasses) are Nodes
         std::vector<std::unique_ptr<ModelAssociation>> mAssociations;   // Edges
         std::vector<std::unique_ptr<ModelModule>> mModules;
@@ -776,8 +818,21 @@ class ModelData
         void clear();
         /// Use the model ids from the file to resolve references.  This should
         /// be done for every loaded file since ID's are specific for each file.
+        /// This also sorts the types and indexes the type references.
         void resolveModelIds();
 
+        /// Sort the types by name. Types are appended when they are added,
+        /// so this must be called before the order of mTypes is used.
+        void sortTypes();
+
+        /// Build the index of pointer references to types if it is not
+        /// already built. Once built, replaceType() only updates the
+        /// references that refer to the replaced type. The index is kept
+        /// up to date by replaceType() and resolveModelIds(), so this must
+        /// not be used when pointer references are set outside of ModelData,
+        /// such as by the parser.
+        void indexTypeReferences();
+
         bool isTypeReferencedByOperation(ModelOperation const &oper,
             ModelType const &type) const;
         bool isTypeReferencedByOperationInterface(ModelOperation const &oper,
@@ -789,13 +844,34 @@ class ModelData
         bool isTypeReferencedByParentClass(ModelClassifier const &classifier,
             ModelType const &type) const;
 
-        /// Go through the classes and operations and see if the type is
-        /// referenced as a supplier.
+        /// Go through the classes and operations and get the types that are
+        /// referenced as suppliers. This goes through the model once instead
+        /// of once for each type.
         /// This is used by the model writer, so it has one
         /// strange rule. If a type is related by inheritance in any way,
         /// then indicate it is referenced. Should this be changed?
-        /// @param type The type to check.
-        bool isTypeReferencedByDefinedObjects(ModelType const &type) const;
+        /// @param types The referenced types are added to this.
+        void getTypesReferencedByDefinedObjects(
+            std::unordered_set<ModelType const*> &types) const;
+
+        /// Get the operations that call an operation. The operations are in
+        /// the order of the types in the model.
+        /// The index of callers is built the first time this is called after
+        /// the model is resolved or changed, so this must not be called
+        /// while the model is being loaded on another thread.
+        /// @param calleeType The class that contains the called operation.
+        /// @param funcName The name of the called operation without the
+        ///     overload key. See ModelStatement::getFuncName().
+        ModelOperReferences const &getOperCallers(ModelType const *calleeType,
+            OovStringRef const funcName) const;
+
+        /// Get the operations that refer to an attribute, either with a
+        /// variable reference, or by calling a function of the attribute.
+        /// See getOperCallers() for when the index is built.
+        /// @param attrClass The class that contains the attribute.
+        /// @param attrName The name of the attribute.
+        ModelOperReferences const &getAttrReferences(ModelType const *attrClass,
+            OovStringRef const attrName) const;
 
         /// Add a type to the model.
         /// @param type The type to add.
@@ -834,6 +910,20 @@ class ModelData
         /// @param newType The new type.
         void replaceType(ModelType *existingType, ModelClassifier *newType);
 
+        /// Erase the objects that were loaded from the XMI file of a module,
+        /// so that a changed file can be loaded again without loading all
+        /// files. This erases the operations of the module, the attributes
+        /// of the classes that are defined in the module, the associations
+        /// that were loaded with the module, and the module. Types are not
+        /// erased since other files may refer to them.
+        /// @param module The module to erase.
+        void eraseModule(ModelModule const *module);
+
+        /// Erase the types with the name if they are not referenced by any
+        /// object and do not have a module, attributes or operations.
+        /// @param typeName The name of the type to erase.
+        void eraseUnreferencedType(std::string const &typeName);
+
         /// Takes the attributes from the source type, and moves them to the dest type.
         /// @param sourceType The type that the attributes will be taken from.
         /// @param destType Where the attributes will be copied to.
@@ -888,7 +978,48 @@ class ModelData
         static std::string getBaseType(OovStringRef const fullStr);
 
     private:
+        /// The pointer references to a type.
+        struct TypeReferrers
+            {
+            std::vector<ModelTypeRef*> mDecls;
+            std::vector<ModelAssociation*> mAssociations;
+            };
+        /// The first type added for each base type name.
+        std::unordered_map<std::string, ModelType*> mTypeNameIndex;
+        /// Types that have the same name as a type in mTypeNameIndex.
+        /// These are normally only present while a type is being replaced.
+        std::vector<ModelType*> mDuplicateNameTypes;
+        /// The template definition type for each template base name.
+        std::unordered_map<std::string, ModelType*> mTemplateDefIndex;
+        /// The index of each type in mTypes.
+        std::unordered_map<ModelType const*, size_t> mTypePositions;
+        std::unordered_map<ModelType const*, TypeReferrers> mTypeReferrers;
+        bool mTypesSorted;
+        bool mTypeReferrersIndexed;
+        /// The operation references for each class type and name.
+        typedef std::unordered_map<ModelType const*,
+            std::unordered_map<std::string, ModelOperReferences>> OperReferenceIndex;
+        mutable OperReferenceIndex mOperCallers;
+        mutable OperReferenceIndex mAttrReferences;
+        mutable bool mOperReferencesIndexed;
+
         ModelObject *createDataType(eModelDataTypes type, const std::string &id);
+        ModelType *findBaseType(std::string const &baseTypeName) const;
+        void indexTypeName(ModelType *type);
+        void unindexTypeName(ModelType *type);
+        void indexTemplateDef(ModelType *type);
+        void replaceIndexedTypeReferences(ModelType *existingType,
+                ModelClassifier *newType);
+        void replaceAllTypeReferences(ModelType *existingType,
+                ModelClassifier *newType);
+        void addTypeReferrer(ModelTypeRef &decl);
+        void addTypeReferrers(ModelStatements &stmts);
+        /// Called when references may have been deleted. The index can only
+        /// be kept if it is empty.
+        void typeReferencesChanged();
+        void indexOperReferences() const;
+        /// Called when operations or statements may have been changed.
+        void operReferencesChanged();
         void resolveStatements(class TypeIdMap const &typeMap, ModelStatements &stmt);
         void resolveDecl(class TypeIdMap const &typeMap, ModelTypeRef &decl);
         bool isTypeReferencedByStatements(ModelStatements const &stmts, ModelType const &type) const;
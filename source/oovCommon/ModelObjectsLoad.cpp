@@ -77,6 +77,7 @@ void ModelData::resolveDecl(TypeIdMap const &typeMap, ModelTypeRef &decl)
 
 void ModelData::resolveModelIds()
     {
+    sortTypes();
     dumpTypes();
     TypeIdMap typeMap(mTypes);
     // Resolve class member attributes and operations.
@@ -109,7 +110,8 @@ void ModelData::resolveModelIds()
                 }
             }
         }
-    // Resolve relations.
+    // Resolve relations. The ids are cleared so that relations that are
+    // already resolved are not resolved again if more files are loaded.
     for(auto &assoc : mAssociations)
         {
         if(assoc->getChildModelId() != UNDEFINED_ID)
@@ -118,12 +120,13 @@ void ModelData::resolveModelIds()
                 typeMap.getTypeByModelId(assoc->getChildModelId())));
             assoc->setParentClass(ModelClassifier::getClass(
                 typeMap.getTypeByModelId(assoc->getParentModelId())));
-/*
             assoc->setChildModelId(UNDEFINED_ID);
             assoc->setParentModelId(UNDEFINED_ID);
-*/
             }
         }
+    mTypeReferrersIndexed = false;
+    indexTypeReferences();
+    operReferencesChanged();
 /*
     for(auto &type : mTypes)
         {
@@ -206,7 +209,11 @@ void ModelData::takeAttributes(ModelClassifier *sourceType, ModelClassifier *des
             {
             ModelOperation *operPtr = oper.get();
             if(destOper)
+                {
+                // The references in the replaced operation are deleted.
+                typeReferencesChanged();
                 destType->replaceOperation(destOper, std::move(oper));
+                }
             else
                 destType->addOperation(std::move(oper));
             sourceType->eraseOperation(operPtr);
@@ -382,70 +389,20 @@ void ModelClassifier::eraseOperation(const ModelOperation *oper)
     }
 
 
-#define BINARYSPEED 1
-
-#if(BINARYSPEED)
-
-static OovString getTemplateDefBaseName(OovString const &name)
-    {
-    OovString templName;
-    if(ModelType::isTemplateDefType(name))
-        {
-        size_t pos = name.find('<');
-        templName = name.substr(0, pos);
-        }
-    return templName;
-    }
-
-/// Gets the template definition name, or the regular name if it
-/// is not a template definition. Template definitions have the template
-/// stereotype.
-/// This discards the template type parameters
-/// This must return most of the name otherwise the binary search will fail.
-static OovString getTemplateSortedBaseName(OovString const &name)
-    {
-    OovString templName = getTemplateDefBaseName(name);
-    if(templName.length() == 0)
-        {
-        templName = name;
-        }
-    return templName;
-    }
-#endif
-
-static inline bool compareStrs(OovStringRef const tstr1, OovStringRef const tstr2)
-    {
-    return (strcmp(tstr1, tstr2) < 0);
-    }
-
 const ModelType *ModelData::findTemplateType(OovStringRef const baseIdentName) const
     {
-    const ModelType *type = nullptr;
-#if(BINARYSPEED)
-    // This comparison must produce the same sort order as addType.
-    auto iter = std::lower_bound(mTypes.begin(), mTypes.end(), baseIdentName,
-        [](std::unique_ptr<ModelType> const &mod1, OovStringRef const mod2Name) -> bool
-        { return(compareStrs(getTemplateSortedBaseName(mod1->getName()), mod2Name)); } );
-    while(iter != mTypes.end())
+    // A type that exactly matches the name is used before a template
+    // definition.
+    std::string name = baseIdentName.getStr();
+    const ModelType *type = findBaseType(name);
+    if(!type)
         {
-        // At this point, the iterator should be at the first template name of
-        // either the usage or define, so search linearly to the end.
-        // This relies on the fact that the template base name is alphabetically
-        // less than all other uses, which it will be since it is shorter.
-        // This also expects that there will always be a definition, so it
-        // shouldn't take long to iterate until it is found instead of trying
-        // to stop when the base name changes. It should be very rare to reach
-        // the end.
-        OovString templName = getTemplateSortedBaseName((*iter)->getName());
-        if(templName.compare(baseIdentName) == 0)
+        auto iter = mTemplateDefIndex.find(name);
+        if(iter != mTemplateDefIndex.end())
             {
-            type = (*iter).get();
-            break;
+            type = (*iter).second;
             }
-        iter++;
         }
-#else
-#endif
     return type;
     }
 
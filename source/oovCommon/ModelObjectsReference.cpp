@@ -106,9 +106,18 @@ bool ModelData::isTypeReferencedByClassAttributes(ModelClassifier const &classif
     return referenced;
     }
 
-bool ModelData::isTypeReferencedByDefinedObjects(ModelType const &checkType) const
+static void addDeclType(ModelTypeRef const &decl,
+    std::unordered_set<ModelType const*> &types)
+    {
+    if(decl.getDeclType())
+        {
+        types.insert(decl.getDeclType());
+        }
+    }
+
+void ModelData::getTypesReferencedByDefinedObjects(
+    std::unordered_set<ModelType const*> &types) const
     {
-    bool referenced = false;
     for(const auto &type : mTypes)
         {
         if(type->getDataType() == DT_Class)
@@ -117,37 +126,146 @@ bool ModelData::isTypeReferencedByDefinedObjects(ModelType const &checkType) con
             // Only defined classes in the parsed translation unit have a module.
             if(classifier->getModule())
                 {
-                referenced = isTypeReferencedByClassAttributes(*classifier, checkType);
+                for(auto &attr : classifier->getAttributes())
+                    {
+                    addDeclType(*attr, types);
+                    }
                 }
-            if(!referenced)
+            for(auto &oper : classifier->getOperations())
                 {
-                for(auto &oper : classifier->getOperations())
+                // Only defined operations in the translation unit have a module.
+                if(oper->getModule())
                     {
-                    referenced = isTypeReferencedByOperation(*oper, checkType);
-                    if(referenced)
+                    for(auto &param : oper->getParams())
+                        {
+                        addDeclType(*param, types);
+                        }
+                    addDeclType(oper->getReturnType(), types);
+                    for(auto &stmt : oper->getStatements())
                         {
-                        break;
+                        if(stmt.getStatementType() == ST_Call)
+                            {
+                            addDeclType(stmt.getClassDecl(), types);
+                            }
+                        else if(stmt.getStatementType() == ST_VarRef)
+                            {
+                            addDeclType(stmt.getClassDecl(), types);
+                            addDeclType(stmt.getVarDecl(), types);
+                            }
+                        }
+                    for(auto &vd : oper->getBodyVarDeclarators())
+                        {
+                        addDeclType(*vd, types);
                         }
                     }
                 }
-            if(referenced)
-                {
-                break;
-                }
             }
         }
     // Check relations.
-    if(!referenced)
+    for(auto &assoc : mAssociations)
+        {
+        if(assoc->getChild())
+            {
+            types.insert(assoc->getChild());
+            }
+        if(assoc->getParent())
+            {
+            types.insert(assoc->getParent());
+            }
+        }
+    }
+
+static void addOperReference(ModelOperReferences &refs,
+    ModelClassifier const *cls, ModelOperation const *oper, bool varRef)
+    {
+    // The statements of an operation are indexed together, so only the last
+    // reference needs to be checked to keep one reference for each operation.
+    if(refs.size() == 0 || refs.back().mOper != oper)
+        {
+        refs.push_back(ModelOperReference(cls, oper));
+        }
+    if(varRef)
         {
-        for(auto &assoc : mAssociations)
+        refs.back().mVarRef = true;
+        }
+    }
+
+void ModelData::indexOperReferences() const
+    {
+    if(!mOperReferencesIndexed)
+        {
+        mOperCallers.clear();
+        mAttrReferences.clear();
+        for(const auto &type : mTypes)
             {
-            if(assoc->getChild() == &checkType || assoc->getParent() == &checkType)
+            ModelClassifier const *cls = ModelClassifier::getClass(type.get());
+            if(cls)
                 {
-                referenced = true;
-                break;
+                for(auto const &oper : cls->getOperations())
+                    {
+                    for(auto const &stmt : oper->getStatements())
+                        {
+                        ModelType const *declType = stmt.getClassDecl().getDeclType();
+                        if(declType && stmt.getStatementType() == ST_Call)
+                            {
+                            addOperReference(mOperCallers[declType][stmt.getFuncName()],
+                                cls, oper.get(), false);
+                            OovString attrName = stmt.getAttrName();
+                            if(attrName.length() > 0)
+                                {
+                                addOperReference(mAttrReferences[declType][attrName],
+                                    cls, oper.get(), false);
+                                }
+                            }
+                        else if(declType && stmt.getStatementType() == ST_VarRef)
+                            {
+                            addOperReference(mAttrReferences[declType][stmt.getAttrName()],
+                                cls, oper.get(), true);
+                            }
+                        }
+                    }
                 }
             }
+        mOperReferencesIndexed = true;
         }
-    return referenced;
     }
 
+void ModelData::operReferencesChanged()
+    {
+    mOperCallers.clear();
+    mAttrReferences.clear();
+    mOperReferencesIndexed = false;
+    }
+
+static ModelOperReferences const &findOperReferences(
+    std::unordered_map<ModelType const*,
+        std::unordered_map<std::string, ModelOperReferences>> const &index,
+    ModelType const *type, OovStringRef const name)
+    {
+    static ModelOperReferences const noReferences;
+    ModelOperReferences const *refs = &noReferences;
+    auto const typeIter = index.find(type);
+    if(typeIter != index.end())
+        {
+        auto const nameIter = (*typeIter).second.find(name.getStr());
+        if(nameIter != (*typeIter).second.end())
+            {
+            refs = &(*nameIter).second;
+            }
+        }
+    return *refs;
+    }
+
+ModelOperReferences const &ModelData::getOperCallers(ModelType const *calleeType,
+    OovStringRef const funcName) const
+    {
+    indexOperReferences();
+    return findOperReferences(mOperCallers, calleeType, funcName);
+    }
+
+ModelOperReferences const &ModelData::getAttrReferences(ModelType const *attrClass,
+    OovStringRef const attrName) const
+    {
+    indexOperReferences();
+    return findOperReferences(mAttrReferences, attrClass, attrName);
+    }
@@ -11,9 +11,55 @@
 #include "ModelObjects.h"
 #include "Debug.h"
 #include <map>
+#include <algorithm>
 
 void ModelData::replaceType(ModelType *existingType, ModelClassifier *newType)
     {
+    if(mTypeReferrersIndexed)
+        {
+        replaceIndexedTypeReferences(existingType, newType);
+        }
+    else
+        {
+        replaceAllTypeReferences(existingType, newType);
+        }
+    eraseType(existingType);
+    }
+
+void ModelData::replaceIndexedTypeReferences(ModelType *existingType,
+        ModelClassifier *newType)
+    {
+    auto refIter = mTypeReferrers.find(existingType);
+    if(refIter != mTypeReferrers.end())
+        {
+        TypeReferrers referrers = std::move((*refIter).second);
+        mTypeReferrers.erase(refIter);
+        for(auto &decl : referrers.mDecls)
+            {
+            decl->setDeclType(newType);
+            }
+        for(auto &assoc : referrers.mAssociations)
+            {
+            if(assoc->getChild() == existingType)
+                {
+                assoc->setChildClass(newType);
+                }
+            if(assoc->getParent() == existingType)
+                {
+                assoc->setParentClass(newType);
+                }
+            }
+        TypeReferrers &newReferrers = mTypeReferrers[newType];
+        newReferrers.mDecls.insert(newReferrers.mDecls.end(),
+            referrers.mDecls.begin(), referrers.mDecls.end());
+        newReferrers.mAssociations.insert(newReferrers.mAssociations.end(),
+            referrers.mAssociations.begin(), referrers.mAssociations.end());
+        }
+    }
+
+void ModelData::replaceAllTypeReferences(ModelType *existingType,
+        ModelClassifier *newType)
+    {
     // Don't need to update function parameter types at this time, because the
     // existing type is a datatype, and datatypes are not referred to at this time.
 
@@ -66,7 +112,6 @@ void ModelData::replaceType(ModelType *existingType, ModelClassifier *newType)
             assoc->setParentClass(newType);
             }
         }
-    eraseType(existingType);
     }
 
 void ModelData::replaceStatementType(ModelStatements &stmts, ModelType *existingType,
@@ -94,13 +139,166 @@ void ModelData::replaceStatementType(ModelStatements &stmts, ModelType *existing
 
 void ModelData::eraseType(ModelType *existingType)
     {
-    // Delete the old type
-    for(size_t ci=0; ci<mTypes.size(); ci++)
+    auto posIter = mTypePositions.find(existingType);
+    if(posIter != mTypePositions.end())
+        {
+        size_t pos = (*posIter).second;
+        mTypePositions.erase(posIter);
+        unindexTypeName(existingType);
+        operReferencesChanged();
+        mTypeReferrers.erase(existingType);
+        ModelClassifier const *classifier = ModelClassifier::getClass(existingType);
+        if(classifier && (classifier->getAttributes().size() > 0 ||
+                classifier->getOperations().size() > 0))
+            {
+            // The references in the class are deleted with the class.
+            typeReferencesChanged();
+            }
+        // Move the last type into the erased position instead of moving
+        // all of the following types. This means the types must be sorted
+        // again.
+        if(pos != mTypes.size()-1)
+            {
+            mTypes[pos] = std::move(mTypes.back());
+            mTypePositions[mTypes[pos].get()] = pos;
+            mTypesSorted = false;
+            }
+        mTypes.pop_back();
+        }
+    }
+
+void ModelData::eraseModule(ModelModule const *module)
+    {
+    for(auto const &type : mTypes)
+        {
+        ModelClassifier *classifier = ModelClassifier::getClass(type.get());
+        if(classifier)
+            {
+            // The attributes are only in the file that defines the class.
+            if(classifier->getModule() == module)
+                {
+                classifier->getAttributes().clear();
+                classifier->setModule(nullptr);
+                }
+            auto &opers = classifier->getOperations();
+            opers.erase(std::remove_if(opers.begin(), opers.end(),
+                [module](std::unique_ptr<ModelOperation> const &oper)
+                { return(oper->getModule() == module); }), opers.end());
+            }
+        }
+    mAssociations.erase(std::remove_if(mAssociations.begin(), mAssociations.end(),
+        [module](std::unique_ptr<ModelAssociation> const &assoc)
+        { return(assoc->getModule() == module); }), mAssociations.end());
+    mModules.erase(std::remove_if(mModules.begin(), mModules.end(),
+        [module](std::unique_ptr<ModelModule> const &mod)
+        { return(mod.get() == module); }), mModules.end());
+    // The references in the erased objects are deleted.
+    typeReferencesChanged();
+    operReferencesChanged();
+    }
+
+void ModelData::eraseUnreferencedType(std::string const &typeName)
+    {
+    indexTypeReferences();
+    bool erased = true;
+    while(erased)
+        {
+        erased = false;
+        ModelType *type = findBaseType(typeName);
+        if(type)
+            {
+            ModelClassifier const *classifier = ModelClassifier::getClass(type);
+            bool used = (classifier && (classifier->getModule() ||
+                classifier->getAttributes().size() > 0 ||
+                classifier->getOperations().size() > 0));
+            auto refIter = mTypeReferrers.find(type);
+            if(refIter != mTypeReferrers.end())
+                {
+                used = used || (*refIter).second.mDecls.size() > 0 ||
+                    (*refIter).second.mAssociations.size() > 0;
+                }
+            if(!used)
+                {
+                eraseType(type);
+                erased = true;
+                }
+            }
+        }
+    }
+
+void ModelData::addTypeReferrer(ModelTypeRef &decl)
+    {
+    if(decl.getDeclType())
+        {
+        mTypeReferrers[decl.getDeclType()].mDecls.push_back(&decl);
+        }
+    }
+
+void ModelData::addTypeReferrers(ModelStatements &stmts)
+    {
+    for(auto &stmt : stmts)
+        {
+        if(stmt.getStatementType() == ST_Call ||
+                stmt.getStatementType() == ST_VarRef)
+            {
+            addTypeReferrer(stmt.getClassDecl());
+            if(stmt.getStatementType() == ST_VarRef)
+                {
+                addTypeReferrer(stmt.getVarDecl());
+                }
+            }
+        }
+    }
+
+void ModelData::indexTypeReferences()
+    {
+    if(!mTypeReferrersIndexed)
         {
-        if(mTypes[ci].get() == existingType)
+        mTypeReferrers.clear();
+        for(const auto &type : mTypes)
             {
-            mTypes.erase(mTypes.begin() +
-                static_cast<int>(ci));
+            if(type->getDataType() == DT_Class)
+                {
+                ModelClassifier *classifier = ModelClassifier::getClass(type.get());
+                for(auto &attr : classifier->getAttributes())
+                    {
+                    addTypeReferrer(*attr);
+                    }
+                for(auto &oper : classifier->getOperations())
+                    {
+                    for(auto &parm : oper->getParams())
+                        {
+                        addTypeReferrer(*parm);
+                        }
+                    for(auto &vd : oper->getBodyVarDeclarators())
+                        {
+                        addTypeReferrer(*vd);
+                        }
+                    addTypeReferrer(oper->getReturnType());
+                    addTypeReferrers(oper->getStatements());
+                    }
+                }
             }
+        for(auto &assoc : mAssociations)
+            {
+            if(assoc->getChild())
+                {
+                mTypeReferrers[assoc->getChild()].mAssociations.push_back(assoc.get());
+                }
+            if(assoc->getParent() && assoc->getParent() != assoc->getChild())
+                {
+                mTypeReferrers[assoc->getParent()].mAssociations.push_back(assoc.get());
+                }
+            }
+        mTypeReferrersIndexed = true;
+        }
+    }
+
+void ModelData::typeReferencesChanged()
+    {
+    if(!mTypeReferrers.empty())
+        {
+        mTypeReferrers.clear();
+        mTypeReferrersIndexed = false;
         }
     }
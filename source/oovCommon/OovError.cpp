@@ -68,8 +68,8 @@ void OovError::report(OovErrorTypes et, OovStringRef errStr)
         }
     }
 
-static int sReportNeededErrorCount;
-int OovStatus::mScopeCounter;
+static std::atomic<int> sReportNeededErrorCount(0);
+std::atomic<int> OovStatus::mScopeCounter(0);
 
 void OovStatus::set(bool success, OovStatusClass sc)
     {
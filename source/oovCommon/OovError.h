@@ -9,6 +9,7 @@
 #define OOV_ERROR
 
 #include "OovString.h"
+#include <atomic>
 
 #define OovStatusReturn OovStatus __attribute__((warn_unused_result))
 enum OovErrorTypes { ET_Error, ET_Info, ET_Diagnostic };
@@ -154,7 +155,8 @@ class OovStatus
 
     private:
         int mStatus;
-        static int mScopeCounter;
+        // This is atomic since status objects are used on multiple threads.
+        static std::atomic<int> mScopeCounter;
 
         static void addError(int err);
         static void removeError(int err);
@@ -164,8 +166,7 @@ class OovStatus
             }
         static void statOutScope()
             {
-            mScopeCounter--;
-            if(mScopeCounter == 0)
+            if(--mScopeCounter == 0)
                 {
                 checkErrors();
                 }
@@ -3,6 +3,7 @@
 
 #include "OovThreadedBackgroundQueue.h"
 #include <thread>
+#include <chrono>
 
 #if(DEBUG_PROC_QUEUE)
 #include "Debug.h"
@@ -17,6 +18,15 @@ void logProc(char const *str, const void *ptr, int val)
 OovThreadedBackgroundQueuePrivate::~OovThreadedBackgroundQueuePrivate()
     {}
 
+bool OovThreadedBackgroundQueuePrivate::clearQuitPoppingPrivate()
+    {
+    std::unique_lock<std::mutex> lock(mProcessQueueMutex);
+    bool consumerQuit = mConsumerQuit;
+    mQuitPopping = false;
+    mConsumerQuit = false;
+    return consumerQuit;
+    }
+
 void OovThreadedBackgroundQueuePrivate::pushPrivate(void const *item)
     {
     std::unique_lock<std::mutex> lock(mProcessQueueMutex);
@@ -55,12 +65,21 @@ bool OovThreadedBackgroundQueuePrivate::waitPopPrivate(void *item)
     if(gotItem)
         {
         getFront(item);
+        // The previous item is complete, so a quit only cancels this item.
+        mContinueProcessingItem = true;
         }
+    else
+        {
+        mConsumerQuit = true;
+        }
+    mWorkingOnItem = gotItem;
 
     LOG_PROC_INT("pop unlock", this, gotItem);
-    // unlock and signal to provider thread that queue is processed.
     lock.unlock();
-    mConsumerPoppedQueueEmptySignal.notify_one();
+    if(!gotItem)
+        {
+        mConsumerWorkDoneSignal.notify_all();
+        }
     LOG_PROC("pop done", this);
     return gotItem;
     }
@@ -70,11 +89,10 @@ void OovThreadedBackgroundQueuePrivate::quitPopsPrivate()
     std::unique_lock<std::mutex> lock(mProcessQueueMutex);
     LOG_PROC("quitPops lock", this);
     mQuitPopping = true;
-    // Wait to make sure all queue items were processed.
-    while(!isQueueEmpty())
-        {
-        mConsumerPoppedQueueEmptySignal.wait(lock);
-        }
+    mContinueProcessingItem = false;
+    // The items that were not started are discarded here so that the
+    // caller only waits for the item that the consumer is working on.
+    clear();
     LOG_PROC("quitPops unlock", this);
     lock.unlock();
     mProviderPushedSignal.notify_all();
@@ -88,3 +106,39 @@ bool OovThreadedBackgroundQueuePrivate::isEmptyPrivate()
     return isQueueEmpty();
     }
 
+void OovThreadedBackgroundQueuePrivate::workCompletedPrivate()
+    {
+    std::unique_lock<std::mutex> lock(mProcessQueueMutex);
+    mWorkingOnItem = false;
+    LOG_PROC("workCompleted", this);
+    lock.unlock();
+    mConsumerWorkDoneSignal.notify_all();
+    }
+
+bool OovThreadedBackgroundQueuePrivate::isWorkingOnItemPrivate()
+    {
+    std::unique_lock<std::mutex> lock(mProcessQueueMutex);
+    return mWorkingOnItem;
+    }
+
+bool OovThreadedBackgroundQueuePrivate::isBusyPrivate()
+    {
+    std::unique_lock<std::mutex> lock(mProcessQueueMutex);
+    return !isIdle();
+    }
+
+bool OovThreadedBackgroundQueuePrivate::waitIdlePrivate(int timeoutMs)
+    {
+    std::unique_lock<std::mutex> lock(mProcessQueueMutex);
+    LOG_PROC_INT("waitIdle", this, timeoutMs);
+    if(timeoutMs < 0)
+        {
+        mConsumerWorkDoneSignal.wait(lock, [this]{ return isIdle(); });
+        }
+    else
+        {
+        mConsumerWorkDoneSignal.wait_for(lock,
+            std::chrono::milliseconds(timeoutMs), [this]{ return isIdle(); });
+        }
+    return isIdle();
+    }
@@ -41,26 +41,45 @@ class OovThreadedBackgroundQueuePrivate
     {
     public:
         OovThreadedBackgroundQueuePrivate():
-            mQuitPopping(false)
+            mQuitPopping(false), mContinueProcessingItem(true),
+            mWorkingOnItem(false), mConsumerQuit(false)
             {}
         virtual ~OovThreadedBackgroundQueuePrivate();
-        void clearQuitPoppingPrivate()
-            { mQuitPopping = false; }
+        bool clearQuitPoppingPrivate();
+        bool continueProcessingItemPrivate() const
+            { return mContinueProcessingItem; }
         void pushPrivate(void const *item);
         bool waitPopPrivate(void *item);
         void quitPopsPrivate();
         bool isEmptyPrivate();
+        void workCompletedPrivate();
+        bool isWorkingOnItemPrivate();
+        bool isBusyPrivate();
+        bool waitIdlePrivate(int timeoutMs);
 
     private:
         /// Indicates to quit waiting for pops, nothing more will be put on
         /// the queue, and the queue will be cleared.
         std::atomic_bool mQuitPopping;
+        /// This is cleared when the pops are quit, and is only set again
+        /// when the consumer pops the next item, so that an item that is
+        /// still being worked on stays cancelled.
+        std::atomic_bool mContinueProcessingItem;
         std::mutex mProcessQueueMutex;
         /// A signal that the provider pushed something onto the queue, or
         /// the provider wants the consumers to check the queue.
         std::condition_variable  mProviderPushedSignal;
-        /// A signal that a consumer popped everything from the queue.
-        std::condition_variable  mConsumerPoppedQueueEmptySignal;
+        /// Indicates that an item was read from the queue, and the
+        /// consumer has not completed the work for the item.
+        bool mWorkingOnItem;
+        /// Indicates that a waitPop returned without an item, so the
+        /// consumer thread is done.
+        bool mConsumerQuit;
+        /// A signal that the consumer completed an item or quit.
+        std::condition_variable  mConsumerWorkDoneSignal;
+
+        bool isIdle() const
+            { return(isQueueEmpty() && !mWorkingOnItem); }
 
         virtual bool isQueueEmpty() const = 0;
         virtual void pushBack(void const *item) = 0;
@@ -73,14 +92,16 @@ template<typename T_ThreadQueueItem>
     class OovThreadedBackgroundQueue:public OovThreadedBackgroundQueuePrivate
     {
     public:
-        OovThreadedBackgroundQueue():
-            mGotItemFromQueue(false)
+        OovThreadedBackgroundQueue()
             {}
         virtual ~OovThreadedBackgroundQueue()
             {}
 
-        void clearQuitPopping()
-            { clearQuitPoppingPrivate(); }
+        /// Called by the provider thread to allow pops after quitPops.
+        /// The return is true if the consumer quit because of an earlier
+        /// quitPops.
+        bool clearQuitPopping()
+            { return clearQuitPoppingPrivate(); }
 
         /// Called by the provider thread.
         /// @param item Item that will be pushed onto the queue.
@@ -108,21 +129,33 @@ template<typename T_ThreadQueueItem>
         bool isEmpty()
             { return isEmptyPrivate(); }
 
-        /// @todo - this works, but should be a signal?
+        /// Called by the consumer thread. The return is false if quitPops
+        /// was called after the current item was read with waitPop.
+        bool continueProcessingItem() const
+            { return continueProcessingItemPrivate(); }
+
+        /// Called by the consumer thread after the work for an item that
+        /// was read with waitPop is complete. This signals any threads
+        /// waiting in waitIdle.
         void workCompleted()
-            {
-            mGotItemFromQueue = false;
-            LOG_PROC_INT("workCompleted", this, mGotItemFromQueue);
-            }
-        bool isWorkingOnItem() const
-            {
-            LOG_PROC_INT("isWorking", this, mGotItemFromQueue);
-            return mGotItemFromQueue;
-            }
+            { workCompletedPrivate(); }
+        bool isWorkingOnItem()
+            { return isWorkingOnItemPrivate(); }
+
+        /// Is there something in the queue, or is an item being worked on.
+        bool isBusy()
+            { return isBusyPrivate(); }
+
+        /// Waits until the queue is empty and the consumer is not working
+        /// on an item.
+        /// @param timeoutMs The maximum time to wait, or negative to wait
+        ///     until idle.
+        /// The return is true if the queue is idle.
+        bool waitIdle(int timeoutMs)
+            { return waitIdlePrivate(timeoutMs); }
 
     private:
         std::list<T_ThreadQueueItem> mQueue;
-        std::atomic_bool mGotItemFromQueue;
 
         virtual bool isQueueEmpty() const override
             { return mQueue.empty(); }
@@ -130,9 +163,8 @@ template<typename T_ThreadQueueItem>
             { mQueue.push_back(*static_cast<T_ThreadQueueItem const*>(item)); }
         virtual void getFront(void *item) override
             {
-            *static_cast<T_ThreadQueueItem*>(item) = mQueue.front();
-            mGotItemFromQueue = true;
-            LOG_PROC_INT("getFront", this, mGotItemFromQueue);
+            *static_cast<T_ThreadQueueItem*>(item) = std::move(mQueue.front());
+            LOG_PROC("getFront", this);
             mQueue.pop_front();
             }
         virtual void clear() override
@@ -151,6 +183,12 @@ template<typename T_ThreadQueueItem>
 /// The thread is started when a task is added to the queue, and is cleaned up
 /// by this class during stopAndWaitForCompletion().
 ///
+/// The worker thread signals when it completes an item, so the waiting
+/// functions return as soon as the queue is idle. The processItem function
+/// should check continueProcessingItem() during long work, or pass this
+/// class as the OovTaskContinueListener to long running functions, so that
+/// stopping does not wait for all of the work of the item.
+///
 /// @param T_ThreadQueueItem The type of item that will be in the queue.
 /// @param T_ProcessItem A type derived from OovThreadedBackgroundQueue that contains a
 ///     function to process items:
@@ -186,8 +224,14 @@ template<typename T_ProcessClass, typename T_ThreadQueueItem>
         void addTask(T_ThreadQueueItem const &item)
             {
             LOG_PROC("addTask", this);
-            mContinueProcessingItem = true;
-            mTaskQueue.clearQuitPopping();
+            // If a stop timed out, the worker thread may still be working
+            // on the cancelled item, and will pop this item afterward. If
+            // the worker thread already quit, it must be joined and
+            // started again.
+            if(mTaskQueue.clearQuitPopping() && mWorkerThread.joinable())
+                {
+                mWorkerThread.join();
+                }
             if(!mWorkerThread.joinable())
                 {
                 mWorkerThread = std::thread(workerThreadProc, this);
@@ -198,38 +242,52 @@ template<typename T_ProcessClass, typename T_ThreadQueueItem>
         /// Stop processing background items and wait for any that are being
         /// processed.
         void stopAndWaitForCompletion()
+            {
+            stopAndWaitForCompletion(-1);
+            }
+
+        /// Stop processing background items and wait for any that are being
+        /// processed.
+        /// @param timeoutMs The maximum time to wait, or negative to wait
+        ///     until the item is complete.
+        /// The return is false if an item was still being processed at the
+        /// timeout. The item is still cancelled, and a later call will
+        /// wait for the thread.
+        bool stopAndWaitForCompletion(int timeoutMs)
             {
             LOG_PROC("stopAndWaitForCompletion", this);
-            mContinueProcessingItem = false;
             mTaskQueue.quitPops();
-            while(isQueueBusy())
-                {
-                sleepMs(100);           /// @todo - cleanup
-                }
-            LOG_PROC("stopAndWaitForCompletion - this", this);
-            LOG_PROC_INT("stopAndWaitForCompletion - work", this, mTaskQueue.isWorkingOnItem());
-            LOG_PROC_INT("stopAndWaitForCompletion - queue", this, mTaskQueue.isEmpty());
-            if(mWorkerThread.joinable())
+            bool idle = mTaskQueue.waitIdle(timeoutMs);
+            LOG_PROC_INT("stopAndWaitForCompletion - idle", this, idle);
+            if(idle && mWorkerThread.joinable())
                 {
                 mWorkerThread.join();
                 }
+            return idle;
             }
 
+        /// Wait for the items in the queue to be processed without stopping.
+        /// @param timeoutMs The maximum time to wait, or negative to wait
+        ///     until the queue is idle.
+        /// The return is false if the queue was still busy at the timeout.
+        bool waitForCompletion(int timeoutMs = -1)
+            { return mTaskQueue.waitIdle(timeoutMs); }
+
         /// Is there something in the queue, or is there some processing of the queue
         bool isQueueBusy()
-            { return !mTaskQueue.isEmpty() || mTaskQueue.isWorkingOnItem(); }
+            { return mTaskQueue.isBusy(); }
 
         /// This can be called from processItem to see if the process item should be aborted.
         virtual bool continueProcessingItem() const override
             {
-            LOG_PROC_INT("continue proc", this, mContinueProcessingItem);
-            return mContinueProcessingItem;
+            bool continueProc = mTaskQueue.continueProcessingItem();
+            LOG_PROC_INT("continue proc", this, continueProc);
+            return continueProc;
             }
 
     private:
         OovThreadedBackgroundQueue<T_ThreadQueueItem> mTaskQueue;
         std::thread mWorkerThread;
-        std::atomic_bool mContinueProcessingItem;
         static void workerThreadProc(
                 ThreadedWorkBackgroundQueue<T_ProcessClass, T_ThreadQueueItem> *workQueue)
             {
@@ -237,11 +295,9 @@ template<typename T_ProcessClass, typename T_ThreadQueueItem>
             T_ThreadQueueItem item;
             while(workQueue->mTaskQueue.waitPop(item))
                 {
-                LOG_PROC_INT("start processItem", static_cast<T_ProcessClass*>(workQueue),
-                        workQueue->mTaskQueue.isWorkingOnItem());
+                LOG_PROC("start processItem", static_cast<T_ProcessClass*>(workQueue));
                 static_cast<T_ProcessClass*>(workQueue)->processItem(item);
-                LOG_PROC_INT("done processItem", static_cast<T_ProcessClass*>(workQueue),
-                        workQueue->mTaskQueue.isWorkingOnItem());
+                LOG_PROC("done processItem", static_cast<T_ProcessClass*>(workQueue));
                 workQueue->mTaskQueue.workCompleted();
                 }
             LOG_PROC("done workerThreadProc", nullptr);
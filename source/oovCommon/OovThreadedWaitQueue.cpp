@@ -91,6 +91,100 @@ void OovThreadedWaitQueuePrivate::quitPopsPrivate()
     LOG_PROC("quitPops done", this);
     }
 
+
+OovBoundedWaitQueuePrivate::~OovBoundedWaitQueuePrivate()
+    {}
+
+size_t OovBoundedWaitQueuePrivate::initPositions(size_t minCapacity)
+    {
+    size_t capacity = 2;
+    while(capacity < minCapacity)
+        {
+        capacity *= 2;
+        }
+    mCapacity = capacity;
+    mEnqueuePos = 0;
+    mDequeuePos = 0;
+    mQuitPopping = false;
+    return capacity;
+    }
+
+void OovBoundedWaitQueuePrivate::waitNotFull()
+    {
+    std::unique_lock<std::mutex> lock(mWaitMutex);
+    mNumWaitingPushers++;
+    LOG_PROC("bounded push wait", this);
+    while(isFull())
+        {
+        mNotFullSignal.wait(lock);
+        }
+    mNumWaitingPushers--;
+    }
+
+bool OovBoundedWaitQueuePrivate::waitNotEmpty(
+        std::atomic<size_t> const *otherItems)
+    {
+    std::unique_lock<std::mutex> lock(mWaitMutex);
+    mNumWaitingPoppers++;
+    LOG_PROC("bounded pop wait", this);
+    while(isEmpty() && !mQuitPopping && !(otherItems && *otherItems != 0))
+        {
+        mNotEmptySignal.wait(lock);
+        }
+    mNumWaitingPoppers--;
+    return !isEmpty();
+    }
+
+void OovBoundedWaitQueuePrivate::notifyPushed()
+    {
+    if(mNumWaitingPoppers > 0)
+        {
+        // Taking the lock makes sure that a waiting thread that checked
+        // the positions before the push is waiting for the signal.
+        std::unique_lock<std::mutex> lock(mWaitMutex);
+        lock.unlock();
+        mNotEmptySignal.notify_one();
+        }
+    }
+
+void OovBoundedWaitQueuePrivate::notifyOtherItems()
+    {
+    if(mNumWaitingPoppers > 0)
+        {
+        std::unique_lock<std::mutex> lock(mWaitMutex);
+        lock.unlock();
+        mNotEmptySignal.notify_all();
+        }
+    }
+
+void OovBoundedWaitQueuePrivate::notifyPopped()
+    {
+    if(mNumWaitingPushers > 0)
+        {
+        std::unique_lock<std::mutex> lock(mWaitMutex);
+        lock.unlock();
+        // Both a pusher and quitPops may be waiting.
+        mNotFullSignal.notify_all();
+        }
+    }
+
+void OovBoundedWaitQueuePrivate::quitPopsPrivate()
+    {
+    std::unique_lock<std::mutex> lock(mWaitMutex);
+    LOG_PROC("bounded quitPops lock", this);
+    // Wait to make sure all queue items were read.
+    mNumWaitingPushers++;
+    while(!isEmpty())
+        {
+        mNotFullSignal.wait(lock);
+        }
+    mNumWaitingPushers--;
+    mQuitPopping = true;
+    lock.unlock();
+    mNotEmptySignal.notify_all();
+    LOG_PROC("bounded quitPops done", this);
+    }
+
 void ThreadedWorkWaitPrivate::joinThreads(std::vector<std::thread> &workerThreads)
     {
     if(workerThreads.size() > 0)
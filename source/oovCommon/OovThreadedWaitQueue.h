@@ -2,6 +2,11 @@
 // queue and processed by multiple worker/consumer threads. The single
 // producer will block if all consumer threads are busy.
 //
+// ThreadedWorkWaitQueue uses the OovBoundedWaitQueue, which is a fixed
+// size ring buffer where pushes and pops only use atomic operations unless
+// a thread must wait because the queue is full or empty.  The older
+// OovThreadedWaitQueue that uses a list and a mutex is still available.
+//
 // On Windows, this module uses MinGW-W64 because it fully supports
 // std::thread and atomic functions. MinGW does not at this time. (2014)
 // If normal MinGW is used, the interface stays the same, but the queue
@@ -16,8 +21,12 @@
 // http://www.justsoftwaresolutions.co.uk/threading/
 //      implementing-a-thread-safe-queue-using-condition-variables.html
 // https://eugenedruy.wordpress.com/2009/07/19/refactoring-template-bloat/
+// http://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
 #include <list>
 #include <vector>
+#include <deque>
+#include <memory>
+#include <atomic>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
@@ -104,6 +113,280 @@ template<typename T_ThreadQueueItem>
             }
     };
 
+
+/// This class reduces template code bloat. It keeps the positions of the
+/// ring buffer so that threads can wait for the queue to be not full or not
+/// empty without knowing the type of the items.  See OovBoundedWaitQueue for
+/// the interface description.
+///
+/// The mutex and condition variables are only used when a thread must wait.
+/// A thread that waits increments a waiting count before checking the
+/// positions, and a thread that changes a position checks the waiting
+/// count afterward, so a signal cannot be missed.
+class OovBoundedWaitQueuePrivate
+    {
+    public:
+        OovBoundedWaitQueuePrivate():
+            mCapacity(0), mEnqueuePos(0), mDequeuePos(0),
+            mNumWaitingPushers(0), mNumWaitingPoppers(0), mQuitPopping(false)
+            {}
+        virtual ~OovBoundedWaitQueuePrivate();
+        /// Wakes the consumer threads waiting in waitNotEmpty after the
+        /// other items count was increased.
+        void notifyOtherItems();
+        bool isQuitting() const
+            { return mQuitPopping; }
+
+    protected:
+        /// Resets the positions. This must only be called when no threads
+        /// are using the queue.
+        /// @param minCapacity The minimum number of items in the queue.
+        /// The return is the capacity, which is a power of two.
+        size_t initPositions(size_t minCapacity);
+        /// Waits until the queue is not full.
+        void waitNotFull();
+        /// Waits until the queue is not empty or quitPops is called.
+        /// The return is false if the queue is empty and quitting.
+        /// @param otherItems If this is not null, the wait also stops when
+        ///     this count of items that are available elsewhere is not zero.
+        bool waitNotEmpty(std::atomic<size_t> const *otherItems=nullptr);
+        /// Wakes a thread waiting in waitNotEmpty.
+        void notifyPushed();
+        /// Wakes the thread waiting in waitNotFull or quitPopsPrivate.
+        void notifyPopped();
+        void quitPopsPrivate();
+
+        size_t mCapacity;
+        // The padding keeps the positions that are changed by the producer
+        // and by the consumers in separate cache lines.
+        char mEnqueuePad[64];
+        std::atomic<size_t> mEnqueuePos;
+        char mDequeuePad[64];
+        std::atomic<size_t> mDequeuePos;
+        char mEndPad[64];
+
+    private:
+        std::atomic<int> mNumWaitingPushers;
+        std::atomic<int> mNumWaitingPoppers;
+        // Indicates to quit waiting for pops, nothing more will be put on
+        // the queue.
+        std::atomic<bool> mQuitPopping;
+        std::mutex mWaitMutex;
+        std::condition_variable mNotFullSignal;
+        std::condition_variable mNotEmptySignal;
+
+        bool isEmpty() const
+            { return(mDequeuePos >= mEnqueuePos); }
+        bool isFull() const
+            { return(mEnqueuePos - mDequeuePos >= mCapacity); }
+    };
+
+/// This is a thread safe bounded queue that allows multiple producers and
+/// multiple consumers, but does not handle the threads. Items are moved
+/// into and out of the queue, so items are not copied.
+///
+/// Each cell of the ring buffer has a sequence number that indicates
+/// whether the cell is ready to be written or read for a position, so the
+/// producer and consumers only contend for the positions.
+template<typename T_ThreadQueueItem>
+    class OovBoundedWaitQueue:public OovBoundedWaitQueuePrivate
+    {
+    public:
+        OovBoundedWaitQueue()
+            { initThreadSafeQueue(2); }
+        virtual ~OovBoundedWaitQueue()
+            { quitPops(); }
+
+        /// This must only be called when no threads are using the queue.
+        /// @param minCapacity The minimum number of items that can be in the
+        ///     queue before a push must wait. This is rounded up to a power
+        ///     of two, and is at least two.
+        void initThreadSafeQueue(size_t minCapacity)
+            {
+            size_t capacity = initPositions(minCapacity);
+            if(mCells.size() != capacity)
+                {
+                std::vector<Cell> cells(capacity);
+                mCells.swap(cells);
+                }
+            for(size_t i=0; i<capacity; i++)
+                {
+                mCells[i].mSequence.store(i, std::memory_order_relaxed);
+                }
+            }
+
+        /// Called by the provider thread.
+        /// Waits until there is room in the queue before pushing.
+        /// @param item Item that will be moved onto the queue.
+        void waitPush(T_ThreadQueueItem &&item)
+            {
+            while(!tryPush(item))
+                {
+                waitNotFull();
+                }
+            notifyPushed();
+            }
+
+        /// Called by the provider thread.
+        /// @param item Item that will be copied onto the queue.
+        void waitPush(T_ThreadQueueItem const &item)
+            {
+            T_ThreadQueueItem copy(item);
+            waitPush(std::move(copy));
+            }
+
+        /// Called by the consumer threads.
+        /// Waits until something is read from the queue or until quitPops
+        /// is called.
+        /// @param item Item to move from the queue.
+        /// The return indicates whether a queue item was read.
+        bool waitPop(T_ThreadQueueItem &item)
+            {
+            while(!tryPop(item))
+                {
+                if(!waitNotEmpty())
+                    {
+                    return false;
+                    }
+                }
+            notifyPopped();
+            return true;
+            }
+
+        /// Called by the consumer threads.
+        /// Waits until at least one item is read from the queue or until
+        /// quitPops is called, then reads any other available items without
+        /// waiting.
+        /// @param items The items are appended to this.
+        /// @param maxItems The maximum number of items to read.
+        /// @param otherItems If this is not null, the wait also stops when
+        ///     this count is not zero, and notifyOtherItems must be called
+        ///     after the count is increased.
+        /// The return indicates whether any queue items were read.
+        bool waitPopBatch(std::vector<T_ThreadQueueItem> &items, size_t maxItems,
+            std::atomic<size_t> const *otherItems=nullptr)
+            {
+            T_ThreadQueueItem item;
+            bool gotItem = true;
+            while(gotItem && !tryPop(item))
+                {
+                gotItem = waitNotEmpty(otherItems);
+                }
+            if(gotItem)
+                {
+                notifyPopped();
+                items.push_back(std::move(item));
+                if(maxItems > 1)
+                    {
+                    tryPopBatch(items, maxItems-1);
+                    }
+                }
+            return gotItem;
+            }
+
+        /// Called by the consumer threads. This does not wait.
+        /// @param items The items are appended to this.
+        /// @param maxItems The maximum number of items to read.
+        /// The return indicates whether any queue items were read.
+        bool tryPopBatch(std::vector<T_ThreadQueueItem> &items, size_t maxItems)
+            {
+            size_t numItems = 0;
+            T_ThreadQueueItem item;
+            while(numItems < maxItems && tryPop(item))
+                {
+                items.push_back(std::move(item));
+                numItems++;
+                }
+            if(numItems > 0)
+                {
+                notifyPopped();
+                }
+            return(numItems > 0);
+            }
+
+        /// Called by the provider thread.
+        /// This will wait to make sure all queue items were read
+        /// by a consumer thread.
+        /// This will cause the waitPop functions to quit and return false
+        /// if there are no more queue entries.
+        void quitPops()
+            { quitPopsPrivate(); }
+
+    private:
+        struct Cell
+            {
+            Cell():
+                mSequence(0)
+                {}
+            std::atomic<size_t> mSequence;
+            T_ThreadQueueItem mItem;
+            };
+        std::vector<Cell> mCells;
+
+        /// The item is only moved if the return is true.
+        bool tryPush(T_ThreadQueueItem &item)
+            {
+            size_t mask = mCapacity - 1;
+            size_t pos = mEnqueuePos.load(std::memory_order_relaxed);
+            Cell *cell;
+            while(1)
+                {
+                cell = &mCells[pos & mask];
+                size_t seq = cell->mSequence.load(std::memory_order_acquire);
+                ptrdiff_t diff = static_cast<ptrdiff_t>(seq - pos);
+                if(diff == 0)
+                    {
+                    if(mEnqueuePos.compare_exchange_weak(pos, pos+1))
+                        {
+                        break;
+                        }
+                    }
+                else if(diff < 0)
+                    {
+                    return false;       // Full
+                    }
+                else
+                    {
+                    pos = mEnqueuePos.load(std::memory_order_relaxed);
+                    }
+                }
+            cell->mItem = std::move(item);
+            cell->mSequence.store(pos+1, std::memory_order_release);
+            return true;
+            }
+
+        bool tryPop(T_ThreadQueueItem &item)
+            {
+            size_t mask = mCapacity - 1;
+            size_t pos = mDequeuePos.load(std::memory_order_relaxed);
+            Cell *cell;
+            while(1)
+                {
+                cell = &mCells[pos & mask];
+                size_t seq = cell->mSequence.load(std::memory_order_acquire);
+                ptrdiff_t diff = static_cast<ptrdiff_t>(seq - (pos+1));
+                if(diff == 0)
+                    {
+                    if(mDequeuePos.compare_exchange_weak(pos, pos+1))
+                        {
+                        break;
+                        }
+                    }
+                else if(diff < 0)
+                    {
+                    return false;       // Empty
+                    }
+                else
+                    {
+                    pos = mDequeuePos.load(std::memory_order_relaxed);
+                    }
+                }
+            item = std::move(cell->mItem);
+            cell->mSequence.store(pos+mCapacity, std::memory_order_release);
+            return true;
+            }
+    };
+
 // This class reduces template code bloat.
 class ThreadedWorkWaitPrivate
     {
@@ -123,6 +406,14 @@ class ThreadedWorkWaitPrivate
 /// The threads are started by setup(), and are cleaned up by this class during
 /// waitForCompletion().
 ///
+/// Worker threads can pop a batch of items at a time to reduce the
+/// accesses to the shared queue when there are many small items.  Items in
+/// a batch are kept in a list for each worker, and if OOV_QUEUE_WORK_STEALING
+/// is enabled, a worker that has no items will take items from the end of
+/// another worker's list. A worker that is waiting for the queue is woken
+/// when another worker lists items, so that the end of a batch is not
+/// processed by a single worker.
+///
 /// @param T_ThreadQueueItem The type of item that will be in the queue.
 /// @param T_ProcessItem A type derived from ThreadedWorkQueue that contains a
 ///     function that returns true to continue processing:
@@ -135,18 +426,30 @@ class ThreadedWorkWaitPrivate
 ///        // The function that will be called by the worker threads.
 ///        bool processItem(std::string const &item) {}
 ///    };
+#define OOV_QUEUE_WORK_STEALING 1
 template<typename T_ThreadQueueItem, typename T_ProcessItem>
     class ThreadedWorkWaitQueue
     {
     public:
+        ThreadedWorkWaitQueue():
+            mPopBatchSize(1), mNumListedItems(0)
+            {}
         // The worker threads are joined and cleaned up at destruction.
         ~ThreadedWorkWaitQueue()
             { waitForCompletion(); }
         // Starts the worker/consumer threads.
         // @param numThreads The number of threads to use to process the queue.
-        void setupQueue(size_t numThreads)
+        // @param popBatchSize The maximum number of items that a worker
+        //      thread takes from the queue at a time.
+        void setupQueue(size_t numThreads, size_t popBatchSize=1)
             {
-            mTaskQueue.initThreadSafeQueue();
+            if(mWorkerThreads.size() == 0)
+                {
+                mPopBatchSize = (popBatchSize > 0) ? popBatchSize : 1;
+                // Allow enough items for each worker to get a batch.
+                mTaskQueue.initThreadSafeQueue(mPopBatchSize > 1 ?
+                    numThreads * mPopBatchSize : 2);
+                }
             setupThreads(numThreads);
             }
         // This will block if the worker threads are busy processing the queue.
@@ -155,6 +458,12 @@ template<typename T_ThreadQueueItem, typename T_ProcessItem>
             {
             mTaskQueue.waitPush(item);
             }
+        // This will block if the worker threads are busy processing the queue.
+        // @param item The item to move onto the queue to process.
+        void addTask(T_ThreadQueueItem &&item)
+            {
+            mTaskQueue.waitPush(std::move(item));
+            }
 
         // Wait for all threads to complete work on the queued items.
         // setupQueue must be called each time after waitForCompletion.
@@ -162,6 +471,7 @@ template<typename T_ThreadQueueItem, typename T_ProcessItem>
             {
             mTaskQueue.quitPops();
             ThreadedWorkWaitPrivate::joinThreads(mWorkerThreads);
+            mWorkerItems.clear();
             }
 
         // Uses std::thread::hardware_concurrency() to find number of
@@ -172,29 +482,150 @@ template<typename T_ThreadQueueItem, typename T_ProcessItem>
             }
 
     private:
-        OovThreadedWaitQueue<T_ThreadQueueItem> mTaskQueue;
+        /// The items that a worker popped in a batch, but has not processed.
+        struct WorkerItems
+            {
+            std::mutex mItemsMutex;
+            std::deque<T_ThreadQueueItem> mItems;
+            std::vector<T_ThreadQueueItem> mBatch;
+            };
+        OovBoundedWaitQueue<T_ThreadQueueItem> mTaskQueue;
+        size_t mPopBatchSize;
+        /// The number of items in all of the worker lists.
+        std::atomic<size_t> mNumListedItems;
         std::vector<std::thread> mWorkerThreads;
+        std::vector<std::unique_ptr<WorkerItems>> mWorkerItems;
         // Only sets the number of threads if there are
         // currently no threads running.
         void setupThreads(size_t numThreads)
             {
             if(mWorkerThreads.size() == 0)
                 {
+                if(mPopBatchSize > 1)
+                    {
+                    mNumListedItems = 0;
+                    for(size_t i=0; i<numThreads; i++)
+                        {
+                        mWorkerItems.push_back(std::unique_ptr<WorkerItems>(
+                            new WorkerItems()));
+                        }
+                    }
                 for(size_t i=0; i<numThreads; i++)
                     {
-                    mWorkerThreads.push_back(std::thread(workerThreadProc, this));
+                    mWorkerThreads.push_back(std::thread(workerThreadProc, this, i));
                     }
                 }
             }
         static void workerThreadProc(
-                ThreadedWorkWaitQueue<T_ThreadQueueItem, T_ProcessItem> *workQueue)
+                ThreadedWorkWaitQueue<T_ThreadQueueItem, T_ProcessItem> *workQueue,
+                size_t workerIndex)
             {
             T_ThreadQueueItem item;
-            while(workQueue->mTaskQueue.waitPop(item))
+            if(workQueue->mPopBatchSize > 1)
+                {
+                while(workQueue->getBatchedItem(workerIndex, item))
+                    {
+                    static_cast<T_ProcessItem*>(workQueue)->processItem(item);
+                    }
+                }
+            else
+                {
+                while(workQueue->mTaskQueue.waitPop(item))
+                    {
+                    static_cast<T_ProcessItem*>(workQueue)->processItem(item);
+                    }
+                }
+            }
+        // Gets an item from the worker's list, or pops a batch from the
+        // queue. The return is false when there are no more items.
+        bool getBatchedItem(size_t workerIndex, T_ThreadQueueItem &item)
+            {
+            WorkerItems &worker = *mWorkerItems[workerIndex];
+            if(popWorkerItem(worker, item))
+                {
+                return true;
+                }
+            worker.mBatch.clear();
+#if(OOV_QUEUE_WORK_STEALING)
+            while(!mTaskQueue.tryPopBatch(worker.mBatch, mPopBatchSize))
+                {
+                if(stealItem(workerIndex, item))
+                    {
+                    return true;
+                    }
+                // The wait stops when other workers list items, since
+                // those items may be taken instead of waiting for the
+                // other workers to process them.
+                if(mTaskQueue.waitPopBatch(worker.mBatch, mPopBatchSize,
+                        &mNumListedItems))
+                    {
+                    break;
+                    }
+                if(mTaskQueue.isQuitting())
+                    {
+                    return stealItem(workerIndex, item);
+                    }
+                }
+#else
+            if(!mTaskQueue.tryPopBatch(worker.mBatch, mPopBatchSize))
+                {
+                if(!mTaskQueue.waitPopBatch(worker.mBatch, mPopBatchSize))
+                    {
+                    return false;
+                    }
+                }
+#endif
+            item = std::move(worker.mBatch[0]);
+            if(worker.mBatch.size() > 1)
+                {
+                std::lock_guard<std::mutex> lock(worker.mItemsMutex);
+                for(size_t i=1; i<worker.mBatch.size(); i++)
+                    {
+                    worker.mItems.push_back(std::move(worker.mBatch[i]));
+                    }
+                mNumListedItems += worker.mBatch.size() - 1;
+                }
+#if(OOV_QUEUE_WORK_STEALING)
+            if(worker.mBatch.size() > 1)
+                {
+                mTaskQueue.notifyOtherItems();
+                }
+#endif
+            return true;
+            }
+        bool popWorkerItem(WorkerItems &worker, T_ThreadQueueItem &item)
+            {
+            std::lock_guard<std::mutex> lock(worker.mItemsMutex);
+            bool gotItem = !worker.mItems.empty();
+            if(gotItem)
                 {
-                static_cast<T_ProcessItem*>(workQueue)->processItem(item);
+                item = std::move(worker.mItems.front());
+                worker.mItems.pop_front();
+                mNumListedItems--;
                 }
+            return gotItem;
             }
+#if(OOV_QUEUE_WORK_STEALING)
+        // Takes an item from the end of another worker's list.
+        bool stealItem(size_t workerIndex, T_ThreadQueueItem &item)
+            {
+            bool gotItem = false;
+            for(size_t i=1; i<mWorkerItems.size() && !gotItem; i++)
+                {
+                WorkerItems &victim = *mWorkerItems[(workerIndex + i) %
+                    mWorkerItems.size()];
+                std::lock_guard<std::mutex> lock(victim.mItemsMutex);
+                gotItem = !victim.mItems.empty();
+                if(gotItem)
+                    {
+                    item = std::move(victim.mItems.back());
+                    victim.mItems.pop_back();
+                    mNumListedItems--;
+                    }
+                }
+            return gotItem;
+            }
+#endif
     };
 
 #endif
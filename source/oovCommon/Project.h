@@ -54,6 +54,21 @@
 
 #define DupsDir "dups"
 #define DupsHashExtension "hsh"
+// The duplicate hash files are binary in the byte order of the machine. They
+// start with DupsHashFileId and a 32 bit item count padded to 64 bits. Then
+// there is an array of 64 bit hashes, followed by an array of 32 bit line
+// numbers. A line number of zero is a break between functions.
+// Older hash files are text, with a hex hash and a line number on each line.
+#define DupsHashFileId "OovHash2"
+#define DupsHashFileIdSize 8
+
+// The oovCppParser switch that reads source file arguments from stdin, and
+// the string that is output by the parser after each source file is done.
+#define CppParserServerArg "-server"
+#define CppParserServerDoneStr "oovCppParser-done"
+// The start of the names of the precompiled header files that oovCppParser
+// makes in the analysis directory.
+#define PrecompiledHeaderFilePrefix "oovaide-pch-"
 
 
 enum eProcessModes
@@ -136,6 +151,9 @@ class Project
 
         static OovStringRef getAnalysisIncDepsFilename()
             { return "oovaide-incdeps.txt"; }
+        /// The binary model that is saved after the XMI files are loaded.
+        static OovStringRef getAnalysisModelCacheFilename()
+            { return "oovaide-model.bin"; }
         /// Make a filename for the compressed content file for each source file.
         /// The analysisDir is retreived from the build configuration.
         static OovString makeAnalysisFileName(OovStringRef const srcFileName,
@@ -198,13 +198,77 @@ static void replaceAttrChars(OovString &str)
         }
 }
 
-bool XmiParser::parse(char const * const buf)
+/// Only values that contain an escaped character need to be searched for
+/// the entity strings.
+static OovString getAttrString(char const * const val, int valLen)
+    {
+    OovString str(val, valLen);
+    if(memchr(val, '&', valLen))
+        {
+        replaceAttrChars(str);
+        }
+    return str;
+    }
+
+/// Compares a name that is not null terminated to a null terminated name.
+static bool isName(char const * const name, int len, char const * const str)
+    {
+    return(strncmp(name, str, len) == 0 && str[len] == '\0');
+    }
+
+static XmiAttrTypes getAttrType(char const * const name, int len)
+    {
+    struct attrLookup
+        {
+        char const * const mName;
+        XmiAttrTypes mAttrType;
+        };
+    // The most common attributes are first.
+    static attrLookup const attrs[] =
+    {
+        { "id", AT_Id },
+        { "name", AT_Name },
+        { "type", AT_Type },
+        { "const", AT_Const },
+        { "ref", AT_Ref },
+        { "access", AT_Access },
+        { "line", AT_Line },
+        { "list", AT_List },
+        { "sym", AT_Sym },
+        { "virt", AT_Virt },
+        { "ret", AT_Ret },
+        { "retconst", AT_RetConst },
+        { "retref", AT_RetRef },
+        { "module", AT_Module },
+        { "parent", AT_Parent },
+        { "child", AT_Child },
+        { "codeLines", AT_CodeLines },
+        { "commentLines", AT_CommentLines },
+        { "moduleLines", AT_ModuleLines },
+    };
+    XmiAttrTypes attrType = AT_None;
+    for(size_t i=0; i<sizeof(attrs)/sizeof(attrs[0]); i++)
+        {
+        if(attrs[i].mName[0] == name[0] && isName(name, len, attrs[i].mName))
+            {
+            attrType = attrs[i].mAttrType;
+            break;
+            }
+        }
+    return attrType;
+    }
+
+bool XmiParser::parse(char const * const buf, size_t size)
     {
 #if(DEBUG_LOAD)
     if(sDumpFile)
         fprintf(sLog.mFp, "---------- starting index = %d\n", mStartingModuleTypeIndex);
 #endif
-    bool success = (parseXml(buf) == ERROR_NONE);
+    // The types in the XMI file only refer to other types using ids, so
+    // indexing only needs to be done once for the model.
+    mModel.indexTypeReferences();
+    mFirstNewAssociation = mModel.mAssociations.size();
+    bool success = (parseXml(buf, size) == ERROR_NONE);
     if(success)
         {
         updateTypeIndices();
@@ -234,10 +298,9 @@ void XmiParser::onOpenElem(char const * const name, int len)
         { "Statements", ET_Statements },
     };
     XmiElement elem;
-    OovString elName(name, len);
     for(size_t ni=0; ni<sizeof(names)/sizeof(names[0]); ni++)
         {
-        if(elName.compare(names[ni].mName) == 0)
+        if(isName(name, len, names[ni].mName))
             {
             elem.mType = names[ni].mElType;
             break;
@@ -288,7 +351,7 @@ void XmiParser::onOpenElem(char const * const name, int len)
             break;
         }
 #if(DEBUG_LOAD)
-    sDumpLoad.dumpOpen(mElementStack.size(), elName.c_str());
+    sDumpLoad.dumpOpen(mElementStack.size(), OovString(name, len).c_str());
 #endif
     mElementStack.push_back(elem);
     }
@@ -305,114 +368,136 @@ static int getInt(char const * const str)
     return id;
     }
 
+/// Returns -1 if the value does not start with a number.
+static int getInt(char const * const val, int valLen)
+    {
+    int id = -1;
+    int i = 0;
+    bool negative = (valLen > 0 && val[0] == '-');
+    if(negative)
+        {
+        i++;
+        }
+    if(i < valLen && val[i] >= '0' && val[i] <= '9')
+        {
+        id = 0;
+        for(; i<valLen && val[i] >= '0' && val[i] <= '9'; i++)
+            {
+            id = id * 10 + (val[i] - '0');
+            }
+        if(negative)
+            {
+            id = -id;
+            }
+        }
+    return id;
+    }
+
 static bool isTrue(const std::string &attrVal)
     {
     return(attrVal[0] == 't');
     }
 
-void XmiParser::setDeclAttr(const std::string &attrName,
-        const std::string &attrVal, ModelDeclarator &decl)
+static bool isTrue(char const * const val, int valLen)
+    {
+    return(valLen > 0 && val[0] == 't');
+    }
+
+void XmiParser::setDeclAttr(XmiAttrTypes attrType, char const * const val,
+        int valLen, ModelDeclarator &decl)
     {
-    if(strcmp(attrName.c_str(), "type") == 0)
-        decl.setDeclTypeModelId(mStartingModuleTypeIndex + getInt(attrVal.c_str()));
-    else if(strcmp(attrName.c_str(), "ref") == 0)
-        decl.setRefer(isTrue(attrVal));
-    else if(strcmp(attrName.c_str(), "const") == 0)
-        decl.setConst(isTrue(attrVal));
+    if(attrType == AT_Type)
+        decl.setDeclTypeModelId(mStartingModuleTypeIndex + getInt(val, valLen));
+    else if(attrType == AT_Ref)
+        decl.setRefer(isTrue(val, valLen));
+    else if(attrType == AT_Const)
+        decl.setConst(isTrue(val, valLen));
     }
 
-void XmiParser::addFuncParams(OovStringRef const &attrName,
-        OovStringRef const &attrVal, ModelOperation &oper)
+void XmiParser::addFuncParams(OovStringRef const &attrVal, ModelOperation &oper)
     {
-    if(strcmp(attrName.getStr(), "list") == 0)
+    OovStringVec parms = attrVal.split('#');
+    for(auto const &parm : parms)
         {
-        OovStringVec parms = attrVal.split('#');
-        for(auto const &parm : parms)
+        OovStringVec parmVals = parm.split('@');
+        if(parmVals.size() == 4)
             {
-            OovStringVec parmVals = parm.split('@');
-            if(parmVals.size() == 4)
-                {
-                ModelFuncParam *param = oper.addMethodParameter(parmVals[0],
-                        nullptr, false);
-                param->setDeclTypeModelId(mStartingModuleTypeIndex + getInt(parmVals[1].c_str()));
-                param->setConst(parmVals[2][0] == 't');
-                param->setRefer(parmVals[3][0] == 't');
-                }
+            ModelFuncParam *param = oper.addMethodParameter(parmVals[0],
+                    nullptr, false);
+            param->setDeclTypeModelId(mStartingModuleTypeIndex + getInt(parmVals[1].c_str()));
+            param->setConst(parmVals[2][0] == 't');
+            param->setRefer(parmVals[3][0] == 't');
             }
         }
     }
 
-void XmiParser::addFuncStatements(OovStringRef const &attrName,
-        OovStringRef const &attrVal, ModelOperation &oper)
+void XmiParser::addFuncStatements(OovStringRef const &attrVal, ModelOperation &oper)
     {
-    if(strcmp(attrName.getStr(), "list") == 0)
+    OovStringVec statements = attrVal.split('#');
+    for(auto const &stmt : statements)
         {
-        OovStringVec statements = attrVal.split('#');
-        for(auto const &stmt : statements)
+        OovStringVec stmtVals = stmt.split('@');
+        switch(stmtVals[0][0])
             {
-            OovStringVec stmtVals = stmt.split('@');
-            switch(stmtVals[0][0])
+            case '{':
                 {
-                case '{':
-                    {
-                    ModelStatement modStmt(&stmtVals[0][1], ST_OpenNest);
-                    oper.getStatements().addStatement(modStmt);
-                    }
-                    break;
+                ModelStatement modStmt(&stmtVals[0][1], ST_OpenNest);
+                oper.getStatements().addStatement(modStmt);
+                }
+                break;
 
-                case '}':
-                    {
-                    ModelStatement modStmt("", ST_CloseNest);
-                    oper.getStatements().addStatement(modStmt);
-                    }
-                    break;
+            case '}':
+                {
+                ModelStatement modStmt("", ST_CloseNest);
+                oper.getStatements().addStatement(modStmt);
+                }
+                break;
 
-                case 'c':
+            case 'c':
+                {
+                ModelStatement modStmt(&stmtVals[0][2], ST_Call);
+                int typeId = 0;
+                // -1 is used for [else]
+                if(stmtVals.getStr(1).getInt(-1, INT_MAX, typeId))
                     {
-                    ModelStatement modStmt(&stmtVals[0][2], ST_Call);
-                    int typeId = 0;
-                    // -1 is used for [else]
-                    if(stmtVals.getStr(1).getInt(-1, INT_MAX, typeId))
-                        {
-                        if(typeId != -1)
-                            typeId += mStartingModuleTypeIndex;
-                        modStmt.getClassDecl().setDeclTypeModelId(typeId);
-                        oper.getStatements().addStatement(modStmt);
+                    if(typeId != -1)
+                        typeId += mStartingModuleTypeIndex;
+                    modStmt.getClassDecl().setDeclTypeModelId(typeId);
+                    oper.getStatements().addStatement(modStmt);
 #if(DEBUG_CLASS)
-                        if(modStmt.getFullName().find("appendPage") != std::string::npos)
-                            {
-                            OovString str;
-                            str = "XMI CALL ";
-                            str += modStmt.getFullName();
-                            str += ' ';
-                            str.appendInt(typeId);
-                            OovError::report(ET_Error, str);
-                            }
-#endif
+                    if(modStmt.getFullName().find("appendPage") != std::string::npos)
+                        {
+                        OovString str;
+                        str = "XMI CALL ";
+                        str += modStmt.getFullName();
+                        str += ' ';
+                        str.appendInt(typeId);
+                        OovError::report(ET_Error, str);
                         }
+#endif
                     }
-                    break;
+                }
+                break;
 
-                case 'v':
+            case 'v':
+                {
+                ModelStatement modStmt(&stmtVals[0][2], ST_VarRef);
+                int classTypeId = 0;
+                if(stmtVals.getStr(1).getInt(0, INT_MAX, classTypeId))
                     {
-                    ModelStatement modStmt(&stmtVals[0][2], ST_VarRef);
-                    int classTypeId = 0;
-                    if(stmtVals.getStr(1).getInt(0, INT_MAX, classTypeId))
-                        {
-                        modStmt.getClassDecl().setDeclTypeModelId(
-                                mStartingModuleTypeIndex + classTypeId);
-                        }
-                    int varTypeId = 0;
-                    if(stmtVals.getStr(2).getInt(0, INT_MAX, varTypeId))
-                        {
-                        modStmt.getVarDecl().setDeclTypeModelId(
-                                mStartingModuleTypeIndex + varTypeId);
-                        }
-                    modStmt.setVarAccessWrite(isTrue(stmtVals.getStr(3)));
-                    oper.getStatements().addStatement(modStmt);
+                    modStmt.getClassDecl().setDeclTypeModelId(
+                            mStartingModuleTypeIndex + classTypeId);
                     }
-                    break;
+                int varTypeId = 0;
+                if(stmtVals.getStr(2).getInt(0, INT_MAX, varTypeId))
+                    {
+                    modStmt.getVarDecl().setDeclTypeModelId(
+                            mStartingModuleTypeIndex + varTypeId);
+                    }
+                modStmt.setVarAccessWrite(isTrue(stmtVals.getStr(3)));
+                oper.getStatements().addStatement(modStmt);
                 }
+                break;
             }
         }
     }
@@ -420,17 +505,15 @@ void XmiParser::addFuncStatements(OovStringRef const &attrName,
 void XmiParser::onAttr(char const * const name, int &nameLen,
         char const * const val, int &valLen)
     {
-    if(mElementStack.size() > 0)
+    XmiAttrTypes attrType = getAttrType(name, nameLen);
+    if(mElementStack.size() > 0 && attrType != AT_None)
         {
-        OovString attrName(name, nameLen);
-        OovString attrVal(val, valLen);
         XmiElement const &elItem = mElementStack.back();
         if(elItem.mModelObject)
             {
-            replaceAttrChars(attrVal);
-            if(strcmp(attrName.c_str(), "id") == 0)
+            if(attrType == AT_Id)
                 {
-                int index = getInt(attrVal.c_str());
+                int index = getInt(val, valLen);
                 if(elItem.mType == ET_Module || elItem.mType == ET_Generalization)
                     {
                     elItem.mModelObject->setModelId(index);
@@ -442,8 +525,9 @@ void XmiParser::onAttr(char const * const name, int &nameLen,
                         mEndingModuleTypeIndex = mStartingModuleTypeIndex + index;
                     }
                 }
-            if(strcmp(attrName.c_str(), "name") == 0)
+            if(attrType == AT_Name)
                 {
+                OovString attrVal = getAttrString(val, valLen);
 #if(DEBUG_CLASS)
     if(attrVal == "oovJavaParser")
         {
@@ -461,9 +545,9 @@ void XmiParser::onAttr(char const * const name, int &nameLen,
             case ET_Class:
                 {
                 ModelClassifier *cl = static_cast<ModelClassifier*>(elItem.mModelObject);
-                if(strcmp(attrName.c_str(), "module") == 0)
+                if(attrType == AT_Module)
                     {
-                    int modId = getInt(attrVal.c_str());
+                    int modId = getInt(val, valLen);
                     const ModelModule *mod = mModel.findModuleById(modId);
                     if(mod)
                         cl->setModule(mod);
@@ -472,9 +556,9 @@ void XmiParser::onAttr(char const * const name, int &nameLen,
                         DebugAssert(__FILE__, __LINE__);
                         }
                     }
-                else if(strcmp(attrName.c_str(), "line") == 0)
+                else if(attrType == AT_Line)
                     {
-                    cl->setLineNum(getInt(attrVal.c_str()));
+                    cl->setLineNum(getInt(val, valLen));
                     }
                 }
                 break;
@@ -482,19 +566,19 @@ void XmiParser::onAttr(char const * const name, int &nameLen,
             case ET_Attr:
                 {
                 ModelAttribute *attr = static_cast<ModelAttribute*>(elItem.mModelObject);
-                if(strcmp(attrName.c_str(), "access") == 0)
-                    attr->setAccess(getAccess(attrVal.c_str()));
+                if(attrType == AT_Access)
+                    attr->setAccess(getAccess(getAttrString(val, valLen).c_str()));
                 else
-                    setDeclAttr(attrName, attrVal, *attr);
+                    setDeclAttr(attrType, val, valLen, *attr);
                 }
                 break;
 
             case ET_FuncParams:
                 {
                 ModelOperation *oper = static_cast<ModelOperation*>(elItem.mModelObject);
-                if(oper)
+                if(oper && attrType == AT_List)
                     {
-                    addFuncParams(attrName.c_str(), attrVal.c_str(), *oper);
+                    addFuncParams(getAttrString(val, valLen), *oper);
                     }
                 }
                 break;
@@ -502,9 +586,9 @@ void XmiParser::onAttr(char const * const name, int &nameLen,
             case ET_Statements:
                 {
                 ModelOperation *oper = static_cast<ModelOperation*>(elItem.mModelObject);
-                if(oper)
+                if(oper && attrType == AT_List)
                     {
-                    addFuncStatements(attrName.c_str(), attrVal.c_str(), *oper);
+                    addFuncStatements(getAttrString(val, valLen), *oper);
                     }
                 }
                 break;
@@ -513,78 +597,89 @@ void XmiParser::onAttr(char const * const name, int &nameLen,
             case ET_BodyVarDecl:
                 {
                 ModelBodyVarDecl *vd = static_cast<ModelBodyVarDecl*>(elItem.mModelObject);
-                setDeclAttr(attrName, attrVal, *vd);
+                setDeclAttr(attrType, val, valLen, *vd);
                 }
                 break;
 
             case ET_Generalization:
                 {
                 ModelAssociation *assoc = static_cast<ModelAssociation*>(elItem.mModelObject);
-                if(strcmp(attrName.c_str(), "parent") == 0)
-                    assoc->setParentModelId(mStartingModuleTypeIndex + getInt(attrVal.c_str()));
-                else if(strcmp(attrName.c_str(), "child") == 0)
-                    assoc->setChildModelId(mStartingModuleTypeIndex + getInt(attrVal.c_str()));
-                else if(strcmp(attrName.c_str(), "access") == 0)
-                    assoc->setAccess(getAccess(attrVal.c_str()));
+                if(attrType == AT_Parent)
+                    assoc->setParentModelId(mStartingModuleTypeIndex + getInt(val, valLen));
+                else if(attrType == AT_Child)
+                    assoc->setChildModelId(mStartingModuleTypeIndex + getInt(val, valLen));
+                else if(attrType == AT_Access)
+                    assoc->setAccess(getAccess(getAttrString(val, valLen).c_str()));
                 }
                 break;
 
             case ET_Module:
                 {
                 ModelModule *mod = static_cast<ModelModule*>(elItem.mModelObject);
-                if(strcmp(attrName.c_str(), "module") == 0)
-                    mod->setModulePath(attrVal);
-                else if(strcmp(attrName.c_str(), "codeLines") == 0)
-                    mod->mLineStats.mNumCodeLines = getInt(attrVal.c_str());
-                else if(strcmp(attrName.c_str(), "commentLines") == 0)
-                    mod->mLineStats.mNumCommentLines = getInt(attrVal.c_str());
-                else if(strcmp(attrName.c_str(), "moduleLines") == 0)
-                    mod->mLineStats.mNumModuleLines = getInt(attrVal.c_str());
+                if(attrType == AT_Module)
+                    mod->setModulePath(getAttrString(val, valLen));
+                else if(attrType == AT_CodeLines)
+                    mod->mLineStats.mNumCodeLines = getInt(val, valLen);
+                else if(attrType == AT_CommentLines)
+                    mod->mLineStats.mNumCommentLines = getInt(val, valLen);
+                else if(attrType == AT_ModuleLines)
+                    mod->mLineStats.mNumModuleLines = getInt(val, valLen);
                 }
                 break;
 
             case ET_Function:
                 {
                 ModelOperation *oper = static_cast<ModelOperation*>(elItem.mModelObject);
-                if(strcmp(attrName.c_str(), "access") == 0)
-                    {
-                    oper->setAccess(getAccess(attrVal.c_str()));
-                    }
-                else if(strcmp(attrName.c_str(), "sym") == 0)
-                    {
-                    oper->setOverloadKeyFromKey(attrVal);
-                    }
-                else if(strcmp(attrName.c_str(), "const") == 0)
-                    {
-                    oper->setConst(isTrue(attrVal));
-                    }
-                else if(strcmp(attrName.c_str(), "virt") == 0)
-                    {
-                    oper->setVirtual(isTrue(attrVal));
-                    }
-                else if(strcmp(attrName.c_str(), "line") == 0)
+                switch(attrType)
                     {
-                    if(mModel.mModules.size() > 0)
+                    case AT_Access:
+                        oper->setAccess(getAccess(getAttrString(val, valLen).c_str()));
+                        break;
+
+                    case AT_Sym:
+                        oper->setOverloadKeyFromKey(getAttrString(val, valLen));
+                        break;
+
+                    case AT_Const:
+                        oper->setConst(isTrue(val, valLen));
+                        break;
+
+                    case AT_Virt:
+                        oper->setVirtual(isTrue(val, valLen));
+                        break;
+
+                    case AT_Line:
+                        if(mModel.mModules.size() > 0)
+                            {
+                            oper->setModule(
+                                    mModel.mModules[mModel.mModules.size()-1].get());
+                            }
+                        oper->setLineNum(getInt(val, valLen));
+                        break;
+
+                    case AT_Ret:
                         {
-                        oper->setModule(
-                                mModel.mModules[mModel.mModules.size()-1].get());
+                        ModelTypeRef &retType = oper->getReturnType();
+                        retType.setDeclTypeModelId(mStartingModuleTypeIndex + getInt(val, valLen));
                         }
-                    oper->setLineNum(getInt(attrVal.c_str()));
-                    }
-                else if(strcmp(attrName.c_str(), "ret") == 0)
-                    {
-                    ModelTypeRef &retType = oper->getReturnType();
-                    retType.setDeclTypeModelId(mStartingModuleTypeIndex + getInt(attrVal.c_str()));
-                    }
-                else if(strcmp(attrName.c_str(), "retconst") == 0)
-                    {
-                    ModelTypeRef retType = oper->getReturnType();
-                    retType.setConst(isTrue(attrVal));
-                    }
-                else if(strcmp(attrName.c_str(), "retref") == 0)
-                    {
-                    ModelTypeRef retType = oper->getReturnType();
-                    retType.setRefer(isTrue(attrVal));
+                        break;
+
+                    case AT_RetConst:
+                        {
+                        ModelTypeRef retType = oper->getReturnType();
+                        retType.setConst(isTrue(val, valLen));
+                        }
+                        break;
+
+                    case AT_RetRef:
+                        {
+                        ModelTypeRef retType = oper->getReturnType();
+                        retType.setRefer(isTrue(val, valLen));
+                        }
+                        break;
+
+                    default:
+                        break;
                     }
                 }
                 break;
@@ -620,7 +715,11 @@ void XmiParser::closeTypeElem(XmiElement const &elItem)
         if(newType->getDataType() == DT_Class &&
                 existingType->getDataType() == DT_DataType)
             {
-            // Upgrade the type from a datatype to a class.
+            // Upgrade the type from a datatype to a class. The class uses
+            // the id of the datatype so that references to the datatype
+            // from previous modules resolve to the class.
+            mFileTypeIndexMap[newType->getModelId()] = existingType->getModelId();
+            newType->setModelId(existingType->getModelId());
             mModel.replaceType(existingType, static_cast<ModelClassifier*>(newType));
 #if(DEBUG_LOAD)
 if(sDumpFile)
@@ -755,6 +854,10 @@ void XmiParser::onCloseElem(char const * const /*name*/, int /*len*/)
             case ET_Generalization:
                 {
                 ModelAssociation *assoc = static_cast<ModelAssociation*>(elItem.mModelObject);
+                if(mModel.mModules.size() > 0)
+                    {
+                    assoc->setModule(mModel.mModules[mModel.mModules.size()-1].get());
+                    }
                 /// @todo - use make_unique when supported.
                 mModel.mAssociations.push_back(std::unique_ptr<ModelAssociation>(assoc));
                 }
@@ -857,9 +960,11 @@ void XmiParser::updateTypeIndices()
             }
         }
     // Not real efficient to go through all, but there should not be all that many
-    // compared to the number of types.
-    for(auto &assoc : mModel.mAssociations)
+    // compared to the number of types.  Associations from previous modules
+    // only refer to indices that are lower than the indices in the map.
+    for(size_t ai=mFirstNewAssociation; ai<mModel.mAssociations.size(); ai++)
         {
+        auto &assoc = mModel.mAssociations[ai];
             for(auto const &iterChild : mFileTypeIndexMap)
                 {
                 if(iterChild.first == assoc->getChildModelId())
@@ -928,11 +1033,105 @@ void XmiParser::updateTypeIndices()
         }
     }
 
-static bool loadXmiBuf(char const * const buf, ModelData &model, int &typeIndex)
+int XmiParser::getFragmentTypeIndex(int fragmentIndex) const
+    {
+    // Indices that were not set from the file, such as UNDEFINED_ID,
+    // zero, or the index for [else], are not in the fragment range, and are
+    // not changed.
+    int index = fragmentIndex;
+    if(fragmentIndex >= XmiFragmentTypeIndexBase &&
+            fragmentIndex < XmiFragmentTypeIndexBase * 2)
+        {
+        index = fragmentIndex - XmiFragmentTypeIndexBase + mStartingModuleTypeIndex;
+        }
+    return index;
+    }
+
+void XmiParser::updateFragmentDeclTypeIndex(ModelTypeRef &decl)
+    {
+    decl.setDeclTypeModelId(getFragmentTypeIndex(decl.getDeclTypeModelId()));
+    }
+
+void XmiParser::updateFragmentTypeIndices(ModelData &fragment)
+    {
+    for(auto const &type : fragment.mTypes)
+        {
+        type->setModelId(getFragmentTypeIndex(type->getModelId()));
+        if(type->getDataType() == DT_Class)
+            {
+            ModelClassifier *classifier = ModelClassifier::getClass(type.get());
+            for(auto &attr : classifier->getAttributes())
+                {
+                attr->setModelId(getFragmentTypeIndex(attr->getModelId()));
+                updateFragmentDeclTypeIndex(*attr);
+                }
+            for(auto &oper : classifier->getOperations())
+                {
+                oper->setModelId(getFragmentTypeIndex(oper->getModelId()));
+                for(auto &param : oper->getParams())
+                    {
+                    updateFragmentDeclTypeIndex(*param);
+                    }
+                for(auto &stmt : oper->getStatements())
+                    {
+                    if(stmt.getStatementType() == ST_Call ||
+                            stmt.getStatementType() == ST_VarRef)
+                        {
+                        updateFragmentDeclTypeIndex(stmt.getClassDecl());
+                        if(stmt.getStatementType() == ST_VarRef)
+                            {
+                            updateFragmentDeclTypeIndex(stmt.getVarDecl());
+                            }
+                        }
+                    }
+                for(auto &vd : oper->getBodyVarDeclarators())
+                    {
+                    vd->setModelId(getFragmentTypeIndex(vd->getModelId()));
+                    updateFragmentDeclTypeIndex(*vd);
+                    }
+                updateFragmentDeclTypeIndex(oper->getReturnType());
+                }
+            }
+        }
+    for(auto const &assoc : fragment.mAssociations)
+        {
+        assoc->setChildModelId(getFragmentTypeIndex(assoc->getChildModelId()));
+        assoc->setParentModelId(getFragmentTypeIndex(assoc->getParentModelId()));
+        }
+    }
+
+void XmiParser::mergeFragment(ModelData &fragment, int fragmentNextTypeIndex)
+    {
+    mModel.indexTypeReferences();
+    updateFragmentTypeIndices(fragment);
+    mEndingModuleTypeIndex = fragmentNextTypeIndex - XmiFragmentTypeIndexBase +
+        mStartingModuleTypeIndex - 1;
+    mFirstNewAssociation = mModel.mAssociations.size();
+    for(auto &mod : fragment.mModules)
+        {
+        mModel.mModules.push_back(std::move(mod));
+        }
+    for(auto &assoc : fragment.mAssociations)
+        {
+        mModel.mAssociations.push_back(std::move(assoc));
+        }
+    // The types are merged using the same rules as when they are parsed.
+    for(auto &type : fragment.mTypes)
+        {
+        XmiElement elem(type->getDataType() == DT_Class ? ET_Class : ET_DataType);
+        elem.mModelObject = type.release();
+        closeTypeElem(elem);
+        }
+    fragment.clear();
+    updateTypeIndices();
+    }
+
+static bool loadXmiBuf(char const * const buf, size_t size, ModelData &model,
+        int &typeIndex)
     {
     XmiParser parser(model);
     parser.setStartingTypeIndex(typeIndex);
-    bool parsed = parser.parse(buf);
+    bool parsed = parser.parse(buf, size);
     typeIndex = parser.getNextTypeIndex();
     return(parsed);
     }
@@ -949,17 +1148,23 @@ bool loadXmiFile(File const &file, ModelData &graph, OovStringRef const fn, int
         // sDumpFile = (srcFn.find("ModelObjects_h") != std::string::npos);
         dumpFilename(fn, typeIndex);
 #endif
-        // allocate memory to contain the whole file plus a null byte
-        char *buf = new char[size+1];
-        if(buf)
+        // The parser does not need a null terminated buffer, so the file
+        // is parsed without copying it.
+        MappedFile mappedFile;
+        if(mappedFile.open(fn))
             {
-            buf[size] = 0;
-            status = file.read(buf, size);
+            status.set(loadXmiBuf(reinterpret_cast<char const *>(mappedFile.getData()),
+                mappedFile.getSize(), graph, typeIndex), SC_Logic);
+            }
+        else
+            {
+            std::vector<char> buf(size);
+            status = file.read(buf.data(), size);
             if(status.ok())
                 {
-                status.set(loadXmiBuf(buf, graph, typeIndex), SC_Logic);
+                status.set(loadXmiBuf(buf.data(), buf.size(), graph, typeIndex),
+                    SC_Logic);
                 }
-            delete [] buf;
             }
 #if(DEBUG_LOAD)
         dumpTypes(graph);
@@ -995,3 +1200,131 @@ bool loadXmiFile(File const &file, ModelData &graph, OovStringRef const fn, int
     return status.ok();
     };
 
+bool XmiFilesLoader::loadFiles(std::vector<std::string> const &fileNames,
+        MergedListener const &merged, size_t numThreads)
+    {
+    mFileNames = &fileNames;
+    mMergedListener = merged;
+    mTypeIndex = std::max(mTypeIndex, getNextTypeIndex(mModel));
+    mFragments.clear();
+    mFragments.resize(fileNames.size());
+    mFragmentNextTypeIndices.assign(fileNames.size(), 0);
+    mLoaded.assign(fileNames.size(), false);
+    mNextMergeIndex = 0;
+    mMerging = false;
+    mAbort = false;
+    // Limit the number of fragments that are loaded, but not merged, so
+    // that a slow file does not cause all other files to be kept in memory.
+    if(numThreads == 0)
+        {
+        numThreads = 1;
+        }
+    size_t maxUnmergedFiles = numThreads * 4;
+    setupQueue(numThreads);
+    for(size_t i=0; i<fileNames.size() && !mAbort; i++)
+        {
+            {
+            std::unique_lock<std::mutex> lock(mFragmentsMutex);
+            while(i >= mNextMergeIndex + maxUnmergedFiles && !mAbort)
+                {
+                mMergedSignal.wait(lock);
+                }
+            }
+        if(!mAbort)
+            {
+            addTask(i);
+            }
+        }
+    waitForCompletion();
+    mFragments.clear();
+    mFileNames = nullptr;
+    return !mAbort;
+    }
+
+bool XmiFilesLoader::processItem(size_t const &fileIndex)
+    {
+    std::unique_ptr<ModelData> fragment;
+    int nextTypeIndex = XmiFragmentTypeIndexBase;
+    if(!mAbort)
+        {
+        fragment.reset(new ModelData());
+        OovString const &fn = (*mFileNames)[fileIndex];
+        File file;
+        OovStatus status = file.open(fn, "r");
+        if(status.ok())
+            {
+            loadXmiFile(file, *fragment, fn, nextTypeIndex);
+            }
+        if(status.needReport())
+            {
+            OovString err = "Unable to read XMI file ";
+            err += fn;
+            status.report(ET_Error, err);
+            }
+        }
+    std::unique_lock<std::mutex> lock(mFragmentsMutex);
+    mFragments[fileIndex] = std::move(fragment);
+    mFragmentNextTypeIndices[fileIndex] = nextTypeIndex;
+    mLoaded[fileIndex] = true;
+    if(!mMerging)
+        {
+        mMerging = true;
+        lock.unlock();
+        mergeLoadedFragments();
+        }
+    return true;
+    }
+
+void XmiFilesLoader::mergeLoadedFragments()
+    {
+    std::unique_lock<std::mutex> lock(mFragmentsMutex);
+    while(mNextMergeIndex < mLoaded.size() && mLoaded[mNextMergeIndex])
+        {
+        size_t fileIndex = mNextMergeIndex;
+        std::unique_ptr<ModelData> fragment = std::move(mFragments[fileIndex]);
+        int fragmentNextTypeIndex = mFragmentNextTypeIndices[fileIndex];
+        lock.unlock();
+        // Only this thread changes the model, so the lock is not held
+        // while merging.
+        if(fragment && !mAbort)
+            {
+            XmiFileContents contents;
+            if(fragment->mModules.size() > 0)
+                {
+                contents.mModule = fragment->mModules[0].get();
+                }
+            contents.mTypeNames.reserve(fragment->mTypes.size());
+            for(auto const &type : fragment->mTypes)
+                {
+                contents.mTypeNames.push_back(type->getName());
+                }
+            XmiParser parser(mModel);
+            parser.setStartingTypeIndex(mTypeIndex);
+            parser.mergeFragment(*fragment, fragmentNextTypeIndex);
+            mTypeIndex = parser.getNextTypeIndex();
+            if(mMergedListener && !mMergedListener(fileIndex, contents))
+                {
+                mAbort = true;
+                }
+            }
+        fragment.reset();
+        lock.lock();
+        mNextMergeIndex++;
+        mMergedSignal.notify_all();
+        }
+    mMerging = false;
+    }
+
+int XmiFilesLoader::getNextTypeIndex(ModelData const &model)
+    {
+    int maxIndex = -1;
+    for(auto const &type : model.mTypes)
+        {
+        maxIndex = std::max(maxIndex, type->getModelId());
+        }
+    for(auto const &mod : model.mModules)
+        {
+        maxIndex = std::max(maxIndex, mod->getModelId());
+        }
+    return maxIndex + 1;
+    }
@@ -0,0 +1,233 @@
+/**
+*   Copyright (C) 2008 by dcblaha
+*
+*   This program is free software; you can redistribute it and/or modify
+*   it under the terms of the GNU General Public License as published by
+*   the Free Software Foundation; either version 2 of the License, or
+*   (at your option) any later version.
+*
+*   This program is distributed in the hope that it will be useful,
+*   but WITHOUT ANY WARRANTY; without even the implied warranty of
+*   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*   GNU General Public License for more details.
+*
+*   You should have received a copy of the GNU General Public License
+*   along with this program; if not, write to the
+*   Free Software Foundation, Inc.,
+*   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.
+*
+*  @file      xmi2object.h
+*
+*  @author    dcblaha
+*
+*  @date      2/1/2009
+*
+*/
+
+#ifndef XMI2OBJECT_H
+#define XMI2OBJECT_H
+
+#include "XmlParser.h"
+#include "ModelObjects.h"
+#include <map>
+#include <vector>
+#include "OovString.h"
+#include "File.h"
+#include "OovThreadedWaitQueue.h"
+#include <functional>
+#include <memory>
+
+
+enum XmiElementTypes
+    { ET_None, ET_Class, ET_DataType,
+    ET_Attr,
+    ET_Function,        // Same as operation
+    ET_FuncParams,
+    ET_BodyVarDecl,
+    ET_Statements,
+    ET_Generalization,  // Same as association
+    ET_Module,
+    };
+
+/// The attribute names are converted to these so that the attributes can be
+/// handled without comparing strings for every element type.
+enum XmiAttrTypes
+    { AT_None, AT_Id, AT_Name, AT_Module, AT_Line, AT_Access,
+    AT_Type, AT_Ref, AT_Const, AT_List,
+    AT_Parent, AT_Child,
+    AT_CodeLines, AT_CommentLines, AT_ModuleLines,
+    AT_Sym, AT_Virt, AT_Ret, AT_RetConst, AT_RetRef,
+    };
+
+
+class XmiElement
+    {
+    public:
+        XmiElement(XmiElementTypes type=ET_None):
+            mType(type),
+            mModelObject(nullptr)
+            {}
+        XmiElementTypes mType;
+        ModelObject *mModelObject;
+    };
+
+/// Used to parse an XMI file. An XMI file is an XML format file that defines
+/// the data that is used to make diagrams.  The OovCppParser creates the files
+/// and then the Oovaide program does not need to rescan the cpp source or
+/// header files to create the diagrams.
+class XmiParser:private XmlParser
+    {
+    public:
+        XmiParser(ModelData &model):
+            mModel(model), mCurrentClassifier(NULL), mStartingModuleTypeIndex(0),
+            mEndingModuleTypeIndex(0), mFirstNewAssociation(0)
+            {}
+    public:
+        /// The buffer does not need to be null terminated.
+        bool parse(char const * const buf, size_t size);
+        // Merges a model that was parsed from a single file into this
+        // parser's model. The fragment must have been parsed using a starting
+        // type index of XmiFragmentTypeIndexBase, and the starting index of
+        // this parser must be set the same as if the file were being parsed.
+        // This does the same type upgrades, attribute merging, and index
+        // remapping as parse(), so the merged model is the same as if the
+        // file were parsed directly into this model.
+        // @param fragment The model for a single file. All objects are moved
+        //      out of the fragment.
+        // @param fragmentNextTypeIndex The next type index after parsing the
+        //      fragment.
+        void mergeFragment(ModelData &fragment, int fragmentNextTypeIndex);
+        // Since each file only has indices relative to the file, they
+        // must be remapped to a global indices so that the references can be
+        // resolved later.  It is the responsibility of the caller to start the
+        // first file at zero, then get the next type index when the file is
+        // completed parsing and use that for the starting index of the next module.
+        void setStartingTypeIndex(int index)
+            {
+            mStartingModuleTypeIndex = index;
+            mEndingModuleTypeIndex = index;
+            }
+        int getNextTypeIndex() const
+            { return mEndingModuleTypeIndex+1; }
+
+    private:
+        ModelData &mModel;
+        std::vector<XmiElement> mElementStack;
+        ModelClassifier *mCurrentClassifier;
+        int mStartingModuleTypeIndex;
+        int mEndingModuleTypeIndex;
+        // First is index from current module or the original index. Second is
+        // index from previous module or the new index that it will be changed to
+        std::map<int, int> mFileTypeIndexMap;
+        // These are the types that were loaded from the current module that
+        // may need to have indices remapped.
+        std::vector<ModelType*> mPotentialRemapIndicesTypes;
+        // The associations before this index were loaded from other modules.
+        size_t mFirstNewAssociation;
+
+        void closeTypeElem(XmiElement const &elItem);
+        void updateDeclTypeIndices(ModelTypeRef &decl);
+        void updateStatementTypeIndices(ModelStatements &stmt);
+        void updateTypeIndices();
+        int getFragmentTypeIndex(int fragmentIndex) const;
+        void updateFragmentDeclTypeIndex(ModelTypeRef &decl);
+        void updateFragmentTypeIndices(ModelData &fragment);
+        virtual void onOpenElem(char const * const name, int len) override;
+        virtual void onCloseElem(char const * const /*name*/, int /*len*/) override;
+        virtual void onAttr(char const * const name, int &nameLen,
+                char const * const val, int &valLen) override;
+        void addClass(const ModelClassifier *obj);
+        void addAttrs(const ModelClassifier *obj);
+        void addOpers(const ModelClassifier *obj);
+// DEAD CODE
+//        void dumpTypeMap(char const * const str1, char const * const str2);
+        ModelObject *findParentInStack(XmiElementTypes type, bool afterAddingSelf = true);
+        void setDeclAttr(XmiAttrTypes attrType, char const * const val,
+                int valLen, ModelDeclarator &decl);
+        void addFuncParams(OovStringRef const &attrVal, ModelOperation &oper);
+        void addFuncStatements(OovStringRef const &attrVal, ModelOperation &oper);
+    };
+
+/// The file at fn is memory mapped and parsed in place. The opened file is
+/// only read if the file cannot be mapped.
+bool loadXmiFile(File const &file, ModelData &model, OovStringRef const fn, int &typeIndex);
+
+/// The starting type index used to parse a file into a separate model that
+/// will be merged later. The type indices from a file are offset by this, so
+/// indices that were set from the file can be distinguished from defaults.
+#define XmiFragmentTypeIndexBase (1 << 27)
+
+/// The objects that were added to a model from an XMI file. This is used to
+/// erase the objects of a file when the file changes.
+struct XmiFileContents
+    {
+    XmiFileContents():
+        mModule(nullptr)
+        {}
+    /// The module of the file, or null if the file does not have a module.
+    ModelModule const *mModule;
+    /// The names of all types in the file.
+    std::vector<std::string> mTypeNames;
+    };
+
+/// Loads XMI files using multiple threads. Each file is parsed into a
+/// separate model on a worker thread, then the models are merged into the
+/// main model in the order of the file names.  Since the merge order is the
+/// same as loading the files one at a time, the model is the same no
+/// matter how many threads are used.
+class XmiFilesLoader:public ThreadedWorkWaitQueue<size_t, XmiFilesLoader>
+    {
+    public:
+        /// Called after each file is merged. This is called from a worker
+        /// thread, but is never called at the same time by multiple threads.
+        /// The contents are the objects that the file added to the model,
+        /// and may be moved by the listener.
+        /// The return is false to stop loading.
+        typedef std::function<bool(size_t fileIndex,
+            XmiFileContents &contents)> MergedListener;
+
+        XmiFilesLoader(ModelData &model):
+            mModel(model), mTypeIndex(0), mFileNames(nullptr),
+            mNextMergeIndex(0), mMerging(false), mAbort(false)
+            {}
+
+        /// Load the files into the model. This waits until all files are
+        /// loaded or merged returns false. The model may already contain
+        /// resolved objects from other files, and the type indices of the
+        /// files start after the indices in the model.
+        /// @param fileNames The XMI files to load.
+        /// @param merged The function called after each file is merged.
+        /// @param numThreads The number of threads to use.
+        /// The return is false if loading was stopped.
+        bool loadFiles(std::vector<std::string> const &fileNames,
+            MergedListener const &merged, size_t numThreads);
+
+        /// Called by ThreadedWorkWaitQueue
+        bool processItem(size_t const &fileIndex);
+
+        /// Get the type index that is after all type and module indices in
+        /// the model.
+        static int getNextTypeIndex(ModelData const &model);
+
+    private:
+        ModelData &mModel;
+        int mTypeIndex;
+        std::vector<std::string> const *mFileNames;
+        MergedListener mMergedListener;
+        std::vector<std::unique_ptr<ModelData>> mFragments;
+        std::vector<int> mFragmentNextTypeIndices;
+        std::vector<bool> mLoaded;
+        /// All of the above vectors are protected by this mutex.
+        std::mutex mFragmentsMutex;
+        /// Signalled when a fragment is merged.
+        std::condition_variable mMergedSignal;
+        size_t mNextMergeIndex;
+        /// Only one worker at a time merges fragments.
+        bool mMerging;
+        std::atomic_bool mAbort;
+
+        void mergeLoadedFragments();
+    };
+
+#endif
+
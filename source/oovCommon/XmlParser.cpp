@@ -46,24 +46,62 @@ a file such as the following.
 #include <stdio.h>
 #include <string.h>
 
-static char const sWhiteSpaceStr[] = " \t\n\r";
 static char const sTokenStr[] = " \t\n\r\"\'=<>";
 
-static bool sDeclarationElement = false;
+/// A lookup table of the characters in sTokenStr, so that the tokenizer does
+/// not need to search the token string for every character.
+class XmlCharTable
+    {
+    public:
+        XmlCharTable()
+            {
+            for(size_t i=0; i<sizeof(mTokenChars); i++)
+                {
+                mTokenChars[i] = false;
+                mWhiteSpaceChars[i] = false;
+                }
+            // The null character is a token so that null terminated buffers
+            // end names the same as before.
+            mTokenChars[0] = true;
+            for(char const *p = sTokenStr; *p; p++)
+                {
+                mTokenChars[static_cast<unsigned char>(*p)] = true;
+                }
+            for(char const *p = " \t\n\r"; *p; p++)
+                {
+                mWhiteSpaceChars[static_cast<unsigned char>(*p)] = true;
+                }
+            }
+        bool isToken(char ch) const
+            { return mTokenChars[static_cast<unsigned char>(ch)]; }
+        bool isWhiteSpace(char ch) const
+            { return mWhiteSpaceChars[static_cast<unsigned char>(ch)]; }
+
+    private:
+        bool mTokenChars[256];
+        bool mWhiteSpaceChars[256];
+    };
+
+static XmlCharTable sCharTable;
 
 XmlError XmlParser::parseXml(char const * const buf)
+    {
+    return parseXml(buf, strlen(buf));
+    }
+
+XmlError XmlParser::parseXml(char const * const buf, size_t size)
     {
     XmlError errCode;
-    char const *p = buf;
-    p = strchr(p, '<');
-    if(p)
+    mEnd = buf + size;
+    char const *p = findChar(buf, '<');
+    if(p != mEnd)
         {
         p++;      // Skip '<'
         errCode = parseElem(p);
-        if(sDeclarationElement && p)
+        if(mDeclarationElement && p != mEnd)
             {
-            p = strchr(p, '<');
-            if(buf)
+            p = findChar(p, '<');
+            if(p != mEnd)
                 {
                 p++;
                 errCode = parseElem(p);
@@ -75,6 +113,12 @@ XmlError XmlParser::parseXml(char const * const buf)
     return errCode;
     }
 
+char const *XmlParser::findChar(char const *buf, char ch) const
+    {
+    char const *p = static_cast<char const *>(memchr(buf, ch, mEnd - buf));
+    return(p ? p : mEnd);
+    }
+
 XmlError XmlParser::parseAttr(char const *&buf)
     {
     char const * attrName;
@@ -82,20 +126,22 @@ XmlError XmlParser::parseAttr(char const *&buf)
     XmlError errCode = parseName(buf, attrName, attrNameLen);
     if(errCode.isOK())
         {
-        int quoteChar;
         buf += attrNameLen;
-        char const *startVal = strchr(buf, '=');
-        if(startVal)
+        char const *startVal = findChar(buf, '=');
+        if(startVal != mEnd)
             {
             startVal++;
-            startVal = startVal + strcspn(startVal, sTokenStr);
-            quoteChar = *startVal;
-            startVal++;
+            while(startVal < mEnd && !sCharTable.isToken(*startVal))
+                {
+                startVal++;
+                }
             }
-        if(startVal)
+        if(startVal < mEnd)
             {
-            char const *end = strchr(startVal, quoteChar);
-            if(end)
+            char quoteChar = *startVal;
+            startVal++;
+            char const *end = findChar(startVal, quoteChar);
+            if(end != mEnd)
                 {
                 int len = end - startVal;
                 onAttr(attrName, attrNameLen, startVal, len);
@@ -111,7 +157,7 @@ XmlError XmlParser::parseAttr(char const *&buf)
 XmlError XmlParser::parseElemValue(char const *& buf)
     {
     char const * const value = buf;
-    char const * const endVal = strchr(buf, '<');
+    char const * const endVal = findChar(buf, '<');
     unsigned int len = endVal - buf;
     XmlError errCode;
     onElemValue(value, len);
@@ -122,8 +168,8 @@ XmlError XmlParser::parseElemValue(char const *& buf)
 XmlError XmlParser::eatElementEndTag(char const *& buf)
     {
     XmlError errCode;
-    buf = strchr(buf, '>');
-    if(buf)
+    buf = findChar(buf, '>');
+    if(buf != mEnd)
         buf++;
     return errCode;
     }
@@ -137,14 +183,15 @@ XmlError XmlParser::parseElem(char const *&buf)
     XmlError errCode = parseName(buf, elemName, elemNameLen);
     if(errCode.isOK())
         {
-        sDeclarationElement = (elemName[0] == '?');
+        mDeclarationElement = (elemName[0] == '?');
         onOpenElem(elemName, elemNameLen);
         buf += elemNameLen;
         }
     bool inElementStart = true;
-    while(buf && errCode.isOK())
+    while(buf < mEnd && *buf && errCode.isOK())
         {
-        if(*buf == '<' && buf[1] == '/')
+        char nextChar = (buf+1 < mEnd) ? buf[1] : '\0';
+        if(*buf == '<' && nextChar == '/')
             {
             buf++;
             eatElementEndTag(buf);
@@ -160,7 +207,7 @@ XmlError XmlParser::parseElem(char const *&buf)
             inElementStart = false;
             buf++;
             }
-        else if((*buf == '/' || *buf == '?') && buf[1] == '>')
+        else if((*buf == '/' || *buf == '?') && nextChar == '>')
             {
             buf+=2;
             break;
@@ -186,10 +233,19 @@ XmlError XmlParser::parseName(char const *&buf, char const *&name,
         int &nameLen)
     {
     XmlError errCode;
-    char const * const startName = buf + strspn(buf, sWhiteSpaceStr);
-    if(*startName)
+    char const *startName = buf;
+    while(startName < mEnd && sCharTable.isWhiteSpace(*startName))
+        {
+        startName++;
+        }
+    if(startName < mEnd && *startName)
         {
-        nameLen = strcspn(startName, sTokenStr);
+        char const *endName = startName;
+        while(endName < mEnd && !sCharTable.isToken(*endName))
+            {
+            endName++;
+            }
+        nameLen = endName - startName;
         name = startName;
         }
     else
@@ -205,7 +261,7 @@ void XmlParser::stringCbCopy(char *dest, int bytes, char const * const src)
 
 bool XmlParser::isNameChar(char ch)
     {
-    return(!strchr(sTokenStr, ch));
+    return(!sCharTable.isToken(ch));
     }
 
 
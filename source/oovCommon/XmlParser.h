@@ -24,6 +24,8 @@
 *
 */
 
+#include <stddef.h>
+
 enum XmlErrorType
     {
     ERROR_NONE, ERROR_NO_ELEMS, ERROR_BAD_NAME, ERROR_BAD_VALUE
@@ -51,11 +53,19 @@ class XmlError
         XmlErrorType mError;
     };
 
-
+/// This parses the buffer in place, so the names and values that are passed
+/// to the callbacks point into the buffer and are not null terminated.
 class XmlParser
     {
     public:
+        XmlParser():
+            mDeclarationElement(false), mEnd(nullptr)
+            {}
+        /// Parse a null terminated buffer.
         XmlError parseXml(char const * const buf);
+        /// Parse a buffer that does not need to be null terminated, such as
+        /// a memory mapped file.
+        XmlError parseXml(char const * const buf, size_t size);
         virtual ~XmlParser()
             {}
 
@@ -68,13 +78,19 @@ class XmlParser
             {}
 
     private:
+        // This is a member so that files can be parsed on multiple threads.
+        bool mDeclarationElement;
+        char const *mEnd;
+
         XmlError parseAttr(char const *&buf);
         XmlError parseElem(char const *&buf);
         XmlError parseElemValue(char const *& buf);
         XmlError parseName(char const *&buf, char const *&name, int &nameLen);
         XmlError eatElementEndTag(char const *& buf);
+        /// Returns the end of the buffer if the character is not found.
+        char const *findChar(char const *buf, char ch) const;
         void stringCbCopy(char *dest, int bytes, char const * const src);
-        bool isNameChar(char ch);
+        static bool isNameChar(char ch);
     };
 
 
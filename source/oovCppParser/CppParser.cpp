@@ -26,7 +26,6 @@
 // setModule is called for every class defined in the current TU.
 // setModule is called for every operation defined in the current TU.
 
-#define DEBUG_HASH 0
 #if(DEBUG_PARSE)
 static DebugFile sLog("DebugCppParse.txt", false);
 #endif
@@ -136,6 +135,10 @@ class CrashDiagnostics
             { mEnableDumpCursor = enable; }
         void setCrashed()
             { mCrashed = true; }
+        /// Clears the crash state so that another translation unit can be
+        /// parsed by the same process.
+        void reset()
+            { mCrashed = false; mDiagStr.clear(); }
         bool hasCrashed() const
             { return mCrashed; }
         void dumpCrashed(FILE *fp)
@@ -207,7 +210,8 @@ static CXChildVisitResult visitFunctionAddDupHashes(CXCursor cursor, CXCursor pa
 /////////////////////////
 
 
-void CppParser::addOperationParts(CXCursor cursor, bool addParams)
+void CppParser::addOperationParts(CXCursor cursor, bool addParams,
+    bool addStatements)
     {
     // When a function outside of the class is defined, there is no need to add parameters again.
     if(addParams)
@@ -219,8 +223,11 @@ void CppParser::addOperationParts(CXCursor cursor, bool addParams)
     mOperation->getReturnType().setDeclType(mParserModelData.createOrGetDataTypeRef(retType, rt));
     mOperation->getReturnType().setConst(rt.isConst);
     mOperation->getReturnType().setRefer(rt.isRef);
-    mStatements = &mOperation->getStatements();
-    clang_visitChildren(cursor, ::visitFunctionAddStatements, this);
+    if(addStatements)
+        {
+        mStatements = &mOperation->getStatements();
+        clang_visitChildren(cursor, ::visitFunctionAddStatements, this);
+        }
     if(mDupHashFile.isOpen())
         {
         FilePath fn(getFileLoc(cursor), FP_File);
@@ -441,51 +448,6 @@ void CppParser::addElseStatement(CXCursor condStmtCursor, int elseBodyIndex)
         fprintf(sLog.mFp, "end else visited\n");
 #endif
         }
-    }
-
-static unsigned int makeHash(OovStringRef const text)
-    {
-    // djb2 hash function
-    unsigned int hash = 5381;
-    char const *str = text;
-
-    while(*str)
-        {
-        int c = *str++;
-        hash = ((hash << 5) + hash) + c; /* hash * 33 + c */
-        }
-    return hash;
-    }
-
-void DupHashFile::open(OovStringRef const fn)
-    {
-    mFile.open(fn, "w");
-    if(!mFile.isOpen())
-        {
-        fprintf(stderr, "Unable to open hash file");
-        }
-    }
-
-void DupHashFile::append(OovStringRef const text, unsigned int line)
-    {
-    if(mFile.isOpen() && text.numBytes() > 0)
-        {
-        OovString str;
-        str.appendInt(makeHash(text), 16);
-        str += ' ';
-        str.appendInt(line);
-#if(DEBUG_HASH)
-        str += ' ';
-        str += text.getStr());
-#endif
-        str += '\n';
-        OovStatus status = mFile.putString(str);
-        if(status.needReport())
-            {
-            status.report(ET_Error, "Unable to append to hash file");
-            }
-        mAlreadyAddedBreak = false;
-        }
     }
 
 CXChildVisitResult CppParser::visitFunctionAddDupHashes(CXCursor cursor,
@@ -993,10 +955,15 @@ CXChildVisitResult CppParser::visitRecord(CXCursor cursor, CXCursor parent)
                 quals.isMethodConst(), quals.isMethodVirtual());
             CXStringDisposer sym = clang_getCursorUSR(cursor);
             mOperation->setOverloadKeyFromOperUSR(sym);
-            addOperationParts(cursor, true);
             unsigned int line;
             FilePath fn(getFileLoc(cursor, &line), FP_File);
-            if(fn == mTopParseFn)
+            // Only operations in the parsed file are written with statements.
+            // Inline functions in other headers are saved when the header is
+            // parsed, so parsing their bodies in every translation unit that
+            // includes the header is not needed.
+            bool inParsedFile = (fn == mTopParseFn);
+            addOperationParts(cursor, true, inParsedFile);
+            if(inParsedFile)
                 {
                 mOperation->setLineNum(line);
                 mOperation->setModule(mParserModelData.getParsedModule());
@@ -1006,7 +973,10 @@ CXChildVisitResult CppParser::visitRecord(CXCursor cursor, CXCursor parent)
 
         default:
             {
-            if(isField(cursor))
+            // Attributes are only written for classes in the parsed file.
+            // The attributes of classes in other headers are saved when the
+            // header is parsed.
+            if(isField(cursor) && FilePath(getFileLoc(cursor), FP_File) == mTopParseFn)
                 {
                 CXStringDisposer name = clang_getCursorDisplayName(cursor);
                 RefType rt;
@@ -1177,9 +1147,11 @@ CXChildVisitResult CppParser::visitTranslationUnitForIncludes(CXCursor cursor,
         case CXCursor_InclusionDirective:
             {
             CXFile file = clang_getIncludedFile(cursor);
-            if(file)
+            std::string includerFn = getFileLoc(cursor);
+            // The headers that are generated for precompiled headers are not
+            // part of the project.
+            if(file && !mSession.getPrecompiledHeaders().isPrefixHeader(includerFn))
                 {
-                std::string includerFn = getFileLoc(cursor);
                 CXStringDisposer includedFn = clang_getFileName(file);
                 CXStringDisposer includedNameString(clang_getCursorSpelling(cursor));
 
@@ -1296,6 +1268,52 @@ static ModelModuleLineStats makeLineStats(CXCursor cursor)
     }
 #endif
 
+CppParserSession::~CppParserSession()
+    {
+    if(mIndex)
+        {
+        clang_disposeIndex(mIndex);
+        }
+    }
+
+void CppParserSession::open(OovStringRef const outDir)
+    {
+    if(mOutDir != outDir.getStr())
+        {
+        if(mOutDir.length() > 0)
+            {
+            writeIncDirDeps();
+            }
+        mOutDir = outDir.getStr();
+        mIncDirDeps.read(outDir, Project::getAnalysisIncDepsFilename());
+        }
+    }
+
+CXIndex CppParserSession::getIndex()
+    {
+    if(!mIndex)
+        {
+        // Declarations from precompiled headers must not be excluded, since
+        // the classes in the headers are added to the model.
+        mIndex = clang_createIndex(0, 1);
+        }
+    return mIndex;
+    }
+
+bool CppParserSession::writeIncDirDeps()
+    {
+    bool success = true;
+    try
+        {
+        mIncDirDeps.write();
+        }
+    catch(...)
+        {
+        success = false;
+        }
+    return success;
+    }
+
 CppParser::eErrorTypes CppParser::parse(bool lineHashes, char const * const srcFn,
         char const * const srcRootDir, char const * const outDir,
         char const * const clang_args[], int num_clang_args)
@@ -1305,10 +1323,10 @@ CppParser::eErrorTypes CppParser::parse(bool lineHashes, char const * const srcF
     mTopParseFn.setPath(srcFn, FP_File);
     /// Create a module so the modelwriter has a filename.
     mParserModelData.addParsedModule(srcFn);
+    sCrashDiagnostics.reset();
 
-    mIncDirDeps.read(outDir, Project::getAnalysisIncDepsFilename());
-
-    CXIndex index = clang_createIndex(1, 1);
+    mSession.open(outDir);
+    CXIndex index = mSession.getIndex();
 
     std::string outBaseFileName = Project::makeOutBaseFileName(srcFn,
             srcRootDir, outDir);
@@ -1340,11 +1358,31 @@ CppParser::eErrorTypes CppParser::parse(bool lineHashes, char const * const srcF
 //    unsigned options = 0;
     CXTranslationUnit tu;
 
+    OovString pchFn;
+    if(mSession.getUsePrecompiledHeaders())
+        {
+        pchFn = mSession.getPrecompiledHeaders().getPchFilename(index, srcFn,
+            outDir, clang_args, num_clang_args);
+        }
+    std::vector<char const *> args;
+    if(pchFn.length() > 0)
+        {
+        args.push_back("-include-pch");
+        args.push_back(pchFn.getStr());
+        }
+    args.insert(args.end(), clang_args, clang_args + num_clang_args);
+
     CXErrorCode errCode = CXError_Success;
     try
         {
         errCode = clang_parseTranslationUnit2(index, srcFn,
-                clang_args, num_clang_args, 0, 0, options, &tu);
+                args.data(), static_cast<int>(args.size()), 0, 0, options, &tu);
+        if(errCode != CXError_Success && pchFn.length() > 0)
+            {
+            mSession.getPrecompiledHeaders().disablePch(pchFn);
+            errCode = clang_parseTranslationUnit2(index, srcFn,
+                    clang_args, num_clang_args, 0, 0, options, &tu);
+            }
     }
     catch(...)
         {
@@ -1366,6 +1404,7 @@ CppParser::eErrorTypes CppParser::parse(bool lineHashes, char const * const srcF
             errType = ET_ParseError;
             sCrashDiagnostics.setCrashed();
             }
+        mDupHashFile.close();
 
 #if(DEBUG_PARSE)
         fprintf(sLog.mFp, "DUMP TYPES\n");
@@ -1386,11 +1425,7 @@ CppParser::eErrorTypes CppParser::parse(bool lineHashes, char const * const srcF
             {
             errType = ET_ParseError;
             }
-        try
-            {
-            mIncDirDeps.write();
-            }
-        catch(...)
+        if(!mSession.writeIncDirDeps())
             {
             errType = ET_ParseError;
             }
@@ -1447,6 +1482,7 @@ CppParser::eErrorTypes CppParser::parse(bool lineHashes, char const * const srcF
             {
             unlink(outErrFileName.c_str());
             }
+        clang_disposeTranslationUnit(tu);
         }
     else
         {
@@ -10,7 +10,10 @@
 
 #include "IncDirMap.h"
 #include "ParserModelData.h"
+#include "PrecompiledHeaders.h"
+#include "DupHashFile.h"
 #include <set>
+#include <stdint.h>
 #include "OovString.h"
 #include "OovError.h"
 
@@ -99,36 +102,53 @@ class SwitchContexts:public std::vector<SwitchContext>
         SwitchContext mDummyContext;
     };
 
-class DupHashFile
-    {
+/// This keeps the state that can be shared while parsing many translation
+/// units in a single process, such as the clang index and the include
+/// dependencies.
+class CppParserSession
+    {
     public:
-        DupHashFile():
-            mAlreadyAddedBreak(true)
-            {}
-        void open(OovStringRef const fn);
-        bool isOpen() const
-            { return mFile.isOpen(); }
-        void append(OovStringRef const text, unsigned int line);
-        void appendBreak()
-            {
-            if(!mAlreadyAddedBreak)
-                {
-                fprintf(mFile.getFp(), "\n");
-                mAlreadyAddedBreak = true;
-                }
-            }
-
-    private:
-        File mFile;
-        bool mAlreadyAddedBreak;
+        CppParserSession():
+            mIndex(nullptr), mUsePrecompiledHeaders(false)
+            {}
+        ~CppParserSession();
+        /// Reads the include dependencies for the output directory. The file
+        /// is only read again if the output directory changes.
+        /// @param outDir The analysis directory.
+        void open(OovStringRef const outDir);
+        /// Writes the include dependencies that were found since the last
+        /// write.
+        /// Returns false if the dependencies could not be written.
+        bool writeIncDirDeps();
+        CXIndex getIndex();
+        IncDirDependencyMap &getIncDirDeps()
+            { return mIncDirDeps; }
+        /// Use precompiled headers for the library headers that are included
+        /// at the top of source files.
+        void setUsePrecompiledHeaders(bool usePch)
+            { mUsePrecompiledHeaders = usePch; }
+        bool getUsePrecompiledHeaders() const
+            { return mUsePrecompiledHeaders; }
+        PrecompiledHeaders &getPrecompiledHeaders()
+            { return mPrecompiledHeaders; }
+
+    private:
+        CXIndex mIndex;
+        OovString mOutDir;
+        IncDirDependencyMap mIncDirDeps;
+        bool mUsePrecompiledHeaders;
+        PrecompiledHeaders mPrecompiledHeaders;
     };
-
+
 /// This parses a C++ source file, then saves important data into a file.
+/// A new parser must be used for every source file, but the session can be
+/// used for many source files.
 class CppParser
     {
     public:
-        CppParser():
-            mClassifier(nullptr), mOperation(nullptr), mStatements(nullptr)
+        CppParser(CppParserSession &session):
+            mSession(session), mClassifier(nullptr), mOperation(nullptr),
+            mStatements(nullptr), mIncDirDeps(session.getIncDirDeps())
 #if(DEBUG_PARSE)
             ,
             mStatementRecurseLevel(0)
@@ -149,6 +169,7 @@ class CppParser
         CXChildVisitResult visitFunctionAddDupHashes(CXCursor cursor, CXCursor parent);
 
     private:
+        CppParserSession &mSession;
         /// This contains all parsed information.
         ParserModelData mParserModelData;
         DupHashFile mDupHashFile;
@@ -158,11 +179,16 @@ class CppParser
         SwitchContexts mSwitchContexts;
         FilePath mTopParseFn;   /// The top level file that is being parsed.
         Visibility mClassMemberAccess;
-        IncDirDependencyMap mIncDirDeps;
+        IncDirDependencyMap &mIncDirDeps;
 #if(DEBUG_PARSE)
         int mStatementRecurseLevel;
 #endif
-        void addOperationParts(CXCursor cursor, bool addParams);
+        /// @param addParams Add the parameters. These are only added when
+        ///     the operation is declared in the class.
+        /// @param addStatements Add the statements of the operation body.
+        ///     These are only needed for operations in the parsed file.
+        void addOperationParts(CXCursor cursor, bool addParams,
+            bool addStatements=true);
         void addRecord(CXCursor cursor, Visibility vis);
 // DEAD CODE
 //        void addVar(CXCursor cursor);
@@ -0,0 +1,76 @@
+/*
+ * DupHashFile.cpp
+ *
+ *  \copyright 2016 DCBlaha.  Distributed under the GPL.
+ */
+
+#include "DupHashFile.h"
+#include "Project.h"
+
+// A 64 bit hash has much fewer collisions than the previous 32 bit djb2
+// hash, so there are fewer false matches of different token sequences.
+static uint64_t makeHash(OovStringRef const text)
+    {
+    // FNV-1a hash function
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    char const *str = text;
+
+    while(*str)
+        {
+        hash ^= static_cast<unsigned char>(*str++);
+        hash *= 0x100000001B3ULL;
+        }
+    return hash;
+    }
+
+void DupHashFile::open(OovStringRef const fn)
+    {
+    mHashes.clear();
+    mLineNums.clear();
+    mAlreadyAddedBreak = true;
+    OovStatus status = mFile.open(fn, "wb");
+    if(status.needReport())
+        {
+        status.report(ET_Error, "Unable to open hash file");
+        }
+    }
+
+void DupHashFile::close()
+    {
+    if(mFile.isOpen())
+        {
+        uint32_t header[2] = { static_cast<uint32_t>(mHashes.size()), 0 };
+        OovStatus status = mFile.write(DupsHashFileId, DupsHashFileIdSize);
+        if(status.ok())
+            {
+            status = mFile.write(reinterpret_cast<char const *>(header),
+                sizeof(header));
+            }
+        if(status.ok() && mHashes.size() > 0)
+            {
+            status = mFile.write(reinterpret_cast<char const *>(&mHashes[0]),
+                static_cast<int>(mHashes.size() * sizeof(mHashes[0])));
+            if(status.ok())
+                {
+                status = mFile.write(reinterpret_cast<char const *>(&mLineNums[0]),
+                    static_cast<int>(mLineNums.size() * sizeof(mLineNums[0])));
+                }
+            }
+        if(status.needReport())
+            {
+            status.report(ET_Error, "Unable to write hash file");
+            }
+        mFile.close();
+        }
+    mHashes.clear();
+    mLineNums.clear();
+    }
+
+void DupHashFile::append(OovStringRef const text, unsigned int line)
+    {
+    if(mFile.isOpen() && text.numBytes() > 0)
+        {
+        appendItem(makeHash(text), line);
+        mAlreadyAddedBreak = false;
+        }
+    }
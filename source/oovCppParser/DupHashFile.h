@@ -0,0 +1,52 @@
+/*
+ * DupHashFile.h
+ *
+ *  \copyright 2016 DCBlaha.  Distributed under the GPL.
+ */
+
+#ifndef DUPHASHFILE_H_
+#define DUPHASHFILE_H_
+
+#include "File.h"
+#include <vector>
+#include <stdint.h>
+
+/// This keeps the hashes of the tokens of the functions in the parsed file,
+/// and writes them to the hash file in a single block when it is closed.
+class DupHashFile
+    {
+    public:
+        DupHashFile():
+            mAlreadyAddedBreak(true)
+            {}
+        ~DupHashFile()
+            { close(); }
+        void open(OovStringRef const fn);
+        /// Writes the hashes and closes the file.
+        void close();
+        bool isOpen() const
+            { return mFile.isOpen(); }
+        void append(OovStringRef const text, unsigned int line);
+        void appendBreak()
+            {
+            if(!mAlreadyAddedBreak)
+                {
+                appendItem(0, 0);
+                mAlreadyAddedBreak = true;
+                }
+            }
+
+    private:
+        File mFile;
+        bool mAlreadyAddedBreak;
+        std::vector<uint64_t> mHashes;
+        std::vector<uint32_t> mLineNums;
+
+        void appendItem(uint64_t hash, uint32_t line)
+            {
+            mHashes.push_back(hash);
+            mLineNums.push_back(line);
+            }
+    };
+
+#endif /* DUPHASHFILE_H_ */
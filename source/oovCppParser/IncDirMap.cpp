@@ -11,9 +11,17 @@
 #include <algorithm>            // For find
 #include <time.h>
 #include <limits.h>     // For UINT_MAX
+// Prevent "error: 'off64_t' does not name a type"
+#define __NO_MINGW_LFS 1
+// Prevent "error: 'off_t' has not been declared"
+#define off_t _off_t
+#include <unistd.h>     // For getpid
 
 
 #define SHARED_FILE 1
+// Appending to a journal for each process prevents all of the parsers
+// from waiting to read and rewrite the whole include map file.
+#define JOURNAL_FILE 1
 
 void IncDirDependencyMap::read(char const * const outDir, char const * const incFn)
     {
@@ -26,6 +34,18 @@ void IncDirDependencyMap::read(char const * const outDir, char const * const inc
         {
         status.report(ET_Error, "\nOovCppParser - Read file sharing error\n");
         }
+#if(JOURNAL_FILE)
+    OovString pidStr;
+    pidStr.appendInt(getpid());
+    mJournalFilename = getIncDepsJournalFilename(outIncFileName, pidStr);
+    // Other parsers may have already found some of the dependencies.
+    OovStringVec journalFns;
+    status = mergeIncDepsJournals(*this, journalFns);
+    if(status.needReport())
+        {
+        status.report(ET_Error, "\nOovCppParser - Read journal error\n");
+        }
+#endif
 #else
     if(!readFile())
         {
@@ -47,7 +67,9 @@ void IncDirDependencyMap::write()
     time_t changedTime = 0;
     time(&curTime);
 
-#if(SHARED_FILE)
+#if(JOURNAL_FILE)
+    OovString journalBuf;
+#elif(SHARED_FILE)
     SharedFile file;
     OovStatus status = writeFileExclusiveReadUpdate(file);
     if(status.needReport())
@@ -86,9 +108,41 @@ void IncDirDependencyMap::write()
                     }
                 }
             setNameValue(newMapItem.first, newIncludedInfoCompVal.getAsString());
+#if(JOURNAL_FILE)
+            journalBuf += newMapItem.first;
+            journalBuf += mapDelimiter;
+            journalBuf += newIncludedInfoCompVal.getAsString();
+            journalBuf += '\n';
+#endif
             anyChanges = true;
             }
         }
+#if(JOURNAL_FILE)
+    if(anyChanges)
+        {
+        // The whole buffer is written at once so that a reader will only
+        // see complete lines, or a partial last line that it can discard.
+        SharedFile file;
+        OovStatus status(true, SC_File);
+        eOpenStatus openStat = file.open(mJournalFilename,
+            M_ReadWriteExclusiveAppend);
+        if(openStat == OS_Opened)
+            {
+            status = file.write(&journalBuf[0], static_cast<int>(journalBuf.size()));
+            }
+        else
+            {
+            status.set(false, SC_File);
+            }
+        if(status.needReport())
+            {
+            OovString err = "\nOovCppParser - Unable to write include map journal ";
+            err += mJournalFilename;
+            err += "\n";
+            status.report(ET_Error, err);
+            }
+        }
+#else
     if(file.isOpen() && anyChanges)
         {
 #if(SHARED_FILE)
@@ -101,6 +155,10 @@ void IncDirDependencyMap::write()
         writeFile();
 #endif
         }
+#endif
+    // The file now contains these dependencies, so a parser that handles
+    // many source files only needs to check the newly parsed includers.
+    mParsedIncludeDependencies.clear();
     }
 
 bool IncDirDependencyMap::includedPathsChanged(OovStringRef includerFn,
@@ -19,6 +19,8 @@
 ///     the last time the paths were checked - THIS IS NOT UPDATED!,
 ///     the included filepath (such as "gtk/gtk.h"), and the search path
 ///     to get to that file.
+/// Each parser process appends its changes to a separate journal file, and
+/// oovBuilder compacts the journals into the include map file.
 class IncDirDependencyMap:public NameValueFile
     {
     public:
@@ -32,6 +34,8 @@ class IncDirDependencyMap:public NameValueFile
         /// The second string is a compound value containing the IncludedPath,
         /// which contains the included filepath, and the search path.
         std::map<std::string, std::set<std::string>> mParsedIncludeDependencies;
+        /// The journal file that this process appends the changes to.
+        OovString mJournalFilename;
         bool includedPathsChanged(OovStringRef includerFn,
                 std::set<std::string> const &includedInfoStr) const;
     };
@@ -75,6 +75,11 @@ static void writeDebugStr(std::string const &str)
 //
 // - Inheritance relations are also only defined if they are defined in this TU.
 
+ModelWriter::ModelWriter(const ModelData &modelData):
+    mModelData(modelData), mNextModelId(MIO_NoLookup)
+    {
+    }
+
 OovStatusReturn ModelWriter::openFile(OovStringRef const filename)
     {
 #if(DEBUG_WRITE)
@@ -84,34 +89,63 @@ OovStatusReturn ModelWriter::openFile(OovStringRef const filename)
     mFile.open(filename, "w");
     if(mFile.isOpen())
         {
-        status = mFile.putString("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
+        status = putString("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n");
         if(status.ok())
             {
-            status = mFile.putString("<XMI xmi.version=\"1.2\""
+            status = putString("<XMI xmi.version=\"1.2\""
                     " xmlns:UML=\"http://schema.omg.org/spec/UML/1.3\" >\n");
             }
         if(status.ok())
             {
-            status = mFile.putString(" <XMI.content>\n");
+            status = putString(" <XMI.content>\n");
             }
         }
     return(status);
     }
 
-static int sModelId = MIO_NoLookup;
-static int newModelId()
-    { return sModelId++; }
+OovStatusReturn ModelWriter::putString(OovStringRef const str)
+    {
+    static size_t const OutBufSize = 0x10000;
+    OovStatus status(true, SC_File);
+    mOutBuf += str;
+    if(mOutBuf.length() > OutBufSize)
+        {
+        status = flushOutput();
+        }
+    return status;
+    }
 
-int ModelWriter::getObjectModelId(const std::string &name)
+OovStatusReturn ModelWriter::flushOutput()
     {
-    int index = -1;
+    OovStatus status(true, SC_File);
+    if(mOutBuf.length() > 0)
+        {
+        status = mFile.write(mOutBuf.c_str(), static_cast<int>(mOutBuf.length()));
+        mOutBuf.clear();
+        }
+    return status;
+    }
+
+void ModelWriter::indexTypes()
+    {
+    mTypeIds.clear();
     for(size_t i=0; i<mModelData.mTypes.size(); i++)
         {
-        if(name.compare(mModelData.mTypes[i]->getName()) == 0)
-            {
-            index = static_cast<int>(i) + MIO_Object;
-            break;
-            }
+        // If there are types with the same name, the first one is used.
+        mTypeIds.insert(std::make_pair(mModelData.mTypes[i]->getName(),
+            static_cast<int>(i) + MIO_Object));
+        }
+    mReferencedTypes.clear();
+    mModelData.getTypesReferencedByDefinedObjects(mReferencedTypes);
+    }
+
+int ModelWriter::getObjectModelId(const std::string &name) const
+    {
+    int index = -1;
+    auto const iter = mTypeIds.find(name);
+    if(iter != mTypeIds.end())
+        {
+        index = iter->second;
         }
     return index;
     }
@@ -239,7 +273,7 @@ OovStatusReturn ModelWriter::writeStatements(const ModelStatements &stmts)
                 }
             }
         outStr += "\"/>\n";
-        status = mFile.putString(outStr);
+        status = putString(outStr);
         }
     return status;
     }
@@ -287,7 +321,7 @@ OovStatusReturn ModelWriter::writeOperation(ModelClassifier const &classifier, M
     appendAttr("retref", boolStr(retType.isRefer()), outStr);
     outStr += ">\n";
 
-    OovStatus status = mFile.putString(outStr);
+    OovStatus status = putString(outStr);
     if(status.ok() && oper.getParams().size() > 0)
         {
         OovString parmStr="";
@@ -309,7 +343,7 @@ OovStatusReturn ModelWriter::writeOperation(ModelClassifier const &classifier, M
         parmOutStr += "   <Parms";
         appendAttr("list", parmStr, parmOutStr);
         parmOutStr += " />\n";
-        status = mFile.putString(parmOutStr);
+        status = putString(parmOutStr);
         }
     if(status.ok())
         {
@@ -321,7 +355,7 @@ OovStatusReturn ModelWriter::writeOperation(ModelClassifier const &classifier, M
             appendAttr("const", boolStr(decl->isConst()), declOutStr);
             appendAttr("ref", boolStr(decl->isRefer()), declOutStr);
             declOutStr +=  " />\n";
-            status = mFile.putString(declOutStr);
+            status = putString(declOutStr);
             }
         }
     if(status.ok())
@@ -330,7 +364,7 @@ OovStatusReturn ModelWriter::writeOperation(ModelClassifier const &classifier, M
         }
     if(status.ok())
         {
-        status = mFile.putString("  </Oper>\n");
+        status = putString("  </Oper>\n");
         }
     return status;
     }
@@ -349,7 +383,7 @@ OovStatusReturn ModelWriter::writeClassDefinition(const ModelClassifier &classif
             appendAttr("ref", boolStr(attr->isRefer()), outStr);
             appendAttr("access", attr->getAccess().asUmlStr().getStr(), outStr);
             outStr += " />\n";
-            status = mFile.putString(outStr);
+            status = putString(outStr);
             }
         }
 
@@ -388,7 +422,7 @@ OovStatusReturn ModelWriter::writeType(const ModelType &mtype)
         }
     OovStatus status(true, SC_File);
     if(isDefinedClass || isDefinedOpers ||
-        mModelData.isTypeReferencedByDefinedObjects(mtype))
+        mReferencedTypes.find(&mtype) != mReferencedTypes.end())
         {
         char const *typeName;
         char lineNumStr[50];
@@ -435,7 +469,7 @@ OovStatusReturn ModelWriter::writeType(const ModelType &mtype)
         outStr += lineNumStr;
         outStr += earlyTermStr;
         outStr += ">\n";
-        status = mFile.putString(outStr);
+        status = putString(outStr);
         if(status.ok())
             {
             if(mtype.getDataType() == DT_Class)
@@ -451,7 +485,7 @@ OovStatusReturn ModelWriter::writeType(const ModelType &mtype)
                 OovString outStr = "  </";
                 outStr += typeName;
                 outStr += ">\n";
-                status = mFile.putString(outStr);
+                status = putString(outStr);
                 }
             }
         }
@@ -466,7 +500,7 @@ OovStatusReturn ModelWriter::writeAssociation(const ModelAssociation &assoc)
     appendIntAttr("parent", getObjectModelId(assoc.getParent()->getName()), outStr);
     appendAttr("access", assoc.getAccess().asUmlStr(), outStr);
     outStr += " />\n";
-    return mFile.putString(outStr);
+    return putString(outStr);
     }
 
 OovStatusReturn ModelWriter::writeFile(OovStringRef const filename)
@@ -474,6 +508,7 @@ OovStatusReturn ModelWriter::writeFile(OovStringRef const filename)
     OovStatus status = openFile(filename);
     if(status.ok())
         {
+        indexTypes();
         int moduleXmiId=MIO_Module;
         ModelModule const *module = mModelData.mModules[0].get();
         OovString outStr = "  <Module";
@@ -484,7 +519,7 @@ OovStatusReturn ModelWriter::writeFile(OovStringRef const filename)
         appendIntAttr("moduleLines", module->mLineStats.mNumModuleLines, outStr);
         outStr += " >\n";
         outStr += "  </Module>\n";
-        status = mFile.putString(outStr);
+        status = putString(outStr);
 #if(DEBUG_WRITE)
         writeDebugStr(std::string("     Types"));
 #endif
@@ -517,6 +552,10 @@ OovStatusReturn ModelWriter::writeFile(OovStringRef const filename)
         writeDebugStr(std::string("     Done"));
 #endif
         }
+    if(status.ok())
+        {
+        status = flushOutput();
+        }
     if(!status.ok())
         {
         OovString str = "Unable to save model data file: ";
@@ -530,7 +569,11 @@ ModelWriter::~ModelWriter()
     {
     if(mFile.isOpen())
         {
-        OovStatus status = mFile.putString(" </XMI.content>\n</XMI>\n");
+        OovStatus status = putString(" </XMI.content>\n</XMI>\n");
+        if(status.ok())
+            {
+            status = flushOutput();
+            }
         if(status.needReport())
             {
             status.report(ET_Error, "Unable to finish model file");
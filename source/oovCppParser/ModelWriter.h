@@ -26,6 +26,8 @@
 #include <stdio.h>
 #include "ModelObjects.h"
 #include "File.h"
+#include <unordered_map>
+#include <unordered_set>
 
 
 /**
@@ -34,18 +36,34 @@
 class ModelWriter
 {
 public:
-    ModelWriter(const ModelData &modelData):
-        mModelData(modelData)
-        {}
+    ModelWriter(const ModelData &modelData);
     OovStatusReturn writeFile(OovStringRef const filename);
     ~ModelWriter();
 
 private:
     File mFile;
     const ModelData &mModelData;
+    /// The output is collected here so that the file is written in large
+    /// blocks instead of for every element.
+    OovString mOutBuf;
+    /// The XMI id for each type name. This is built once for the model so
+    /// that each type reference does not need to search all types.
+    std::unordered_map<std::string, int> mTypeIds;
+    /// The types that are referenced by objects that are defined in the
+    /// translation unit.
+    std::unordered_set<ModelType const*> mReferencedTypes;
+    /// The next XMI id for elements that are not looked up by name. This
+    /// starts at the same value for each file, so that the output of a file
+    /// does not depend on other files parsed by the same process.
+    int mNextModelId;
 
     OovStatusReturn openFile(OovStringRef const filename);
-    int getObjectModelId(const std::string &name);
+    OovStatusReturn putString(OovStringRef const str);
+    OovStatusReturn flushOutput();
+    void indexTypes();
+    int getObjectModelId(const std::string &name) const;
+    int newModelId()
+        { return mNextModelId++; }
     OovStatusReturn writeType(const ModelType &type);
     OovStatusReturn writeClassDefinition(const ModelClassifier &classifier, bool isClassDef);
     OovStatusReturn writeOperation(ModelClassifier const &classifier, ModelOperation const &oper);
@@ -211,6 +211,8 @@ void ParserModelData::setLineStats(ModelModuleLineStats const &lineStats)
 
 void ParserModelData::writeModel(OovStringRef fileName)
     {
+    // The writer uses the sorted type positions as ids.
+    mModelData.sortTypes();
     ModelWriter writer(mModelData);
     OovStatus status = writer.writeFile(fileName);
     if(status.needReport())
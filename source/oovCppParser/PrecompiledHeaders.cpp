@@ -0,0 +1,385 @@
+/*
+ * PrecompiledHeaders.cpp
+ *
+ *  \copyright 2016 DCBlaha.  Distributed under the GPL.
+ */
+
+#include "PrecompiledHeaders.h"
+#include "FilePath.h"
+#include "File.h"
+#include "Project.h"
+#include <unistd.h>     // For getpid
+#include <string.h>
+#include <ctype.h>
+#include <algorithm>
+
+// Limit the number of precompiled headers, since each one can be large.
+static const size_t MaxPchs = 32;
+// Only some previous source files are kept to find common includes.
+static const size_t MaxPrevSources = 64;
+// The includes must be near the top of the source file.
+static const int MaxLeadingLines = 200;
+
+static OovString getArgsKey(char const * const clang_args[], int num_clang_args)
+    {
+    OovString key;
+    for(int i=0; i<num_clang_args; i++)
+        {
+        key += clang_args[i];
+        key += '\n';
+        }
+    return key;
+    }
+
+// Returns the number of includes that are the same at the start of both.
+static size_t getNumCommonIncludes(OovStringVec const &incs1,
+        OovStringVec const &incs2)
+    {
+    size_t num = 0;
+    while(num < incs1.size() && num < incs2.size() && incs1[num] == incs2[num])
+        {
+        num++;
+        }
+    return num;
+    }
+
+static char const *skipSpace(char const *p)
+    {
+    while(*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')
+        {
+        p++;
+        }
+    return p;
+    }
+
+static bool startsWith(char const *str, char const *prefix)
+    {
+    return(strncmp(str, prefix, strlen(prefix)) == 0);
+    }
+
+static OovString getName(char const *p)
+    {
+    char const *endName = p;
+    while(isalnum(*endName) || *endName == '_')
+        {
+        endName++;
+        }
+    return OovString(p, static_cast<size_t>(endName-p));
+    }
+
+// Reads a whole line, even if it is longer than the buffer, so that the
+// end of a long line is not parsed as a separate line.
+static bool getLine(File &file, OovString &line, OovStatus &status)
+    {
+    char buf[1000];
+    bool gotLine = false;
+    bool endOfLine = false;
+    line.clear();
+    while(!endOfLine && file.getString(buf, sizeof(buf), status))
+        {
+        line += buf;
+        gotLine = true;
+        size_t len = strlen(buf);
+        endOfLine = (len > 0 && buf[len-1] == '\n');
+        }
+    return gotLine;
+    }
+
+// This only allows lines that cannot change how the included headers are
+// parsed, so that using the precompiled header is the same as parsing the
+// headers in the source file. The include guard of a header is allowed
+// before the includes.
+OovStringVec PrecompiledHeaders::getLeadingIncludes(OovStringRef const srcFn)
+    {
+    OovStringVec includes;
+    File file;
+    OovStatus status = file.open(srcFn, "r");
+    if(status.ok())
+        {
+        OovString line;
+        bool inComment = false;
+        bool allowGuard = true;
+        OovString guardName;
+        bool guardDefined = false;
+        bool done = false;
+        for(int lineNum=0; !done && lineNum<MaxLeadingLines &&
+                getLine(file, line, status); lineNum++)
+            {
+            char const *p = skipSpace(line.getStr());
+            if(inComment)
+                {
+                char const *endComment = strstr(p, "*/");
+                if(endComment)
+                    {
+                    inComment = false;
+                    done = (*skipSpace(endComment+2) != '\0');
+                    }
+                }
+            else if(*p == '\0' || startsWith(p, "//"))
+                {
+                }
+            else if(startsWith(p, "/*"))
+                {
+                char const *endComment = strstr(p+2, "*/");
+                if(endComment)
+                    {
+                    done = (*skipSpace(endComment+2) != '\0');
+                    }
+                else
+                    {
+                    inComment = true;
+                    }
+                }
+            else if(*p == '#')
+                {
+                p = skipSpace(p+1);
+                // The includes must not be inside an #ifndef without a define.
+                bool guardOk = (guardName.length() == 0 || guardDefined);
+                if(guardOk && startsWith(p, "include") && *skipSpace(p+7) == '<')
+                    {
+                    p = skipSpace(p+7);
+                    char const *endName = strchr(p, '>');
+                    if(endName)
+                        {
+                        includes.push_back(OovString(p,
+                            static_cast<size_t>(endName-p+1)));
+                        allowGuard = false;
+                        }
+                    else
+                        {
+                        done = true;
+                        }
+                    }
+                else if(startsWith(p, "pragma") && strstr(p, "once"))
+                    {
+                    }
+                else if(allowGuard && guardName.length() == 0 &&
+                        startsWith(p, "ifndef"))
+                    {
+                    guardName = getName(skipSpace(p+6));
+                    done = (guardName.length() == 0);
+                    }
+                else if(allowGuard && guardName.length() != 0 &&
+                        startsWith(p, "define"))
+                    {
+                    guardDefined = (getName(skipSpace(p+6)) == guardName);
+                    done = !guardDefined;
+                    allowGuard = false;
+                    }
+                else
+                    {
+                    done = true;
+                    }
+                }
+            else
+                {
+                done = true;
+                }
+            }
+        }
+    return includes;
+    }
+
+static void deleteFile(OovStringRef const fn)
+    {
+    OovStatus status = FileDelete(fn);
+    if(status.needReport())
+        {
+        OovString err = "Unable to delete precompiled header file ";
+        err += fn;
+        status.report(ET_Error, err);
+        }
+    }
+
+PrecompiledHeaders::~PrecompiledHeaders()
+    {
+    for(auto const &pch : mPchs)
+        {
+        deleteFile(pch.mHeaderFn);
+        if(pch.mValid)
+            {
+            deleteFile(pch.mPchFn);
+            }
+        }
+    }
+
+OovString PrecompiledHeaders::getPchFilename(CXIndex index,
+        OovStringRef const srcFn, OovStringRef const outDir,
+        char const * const clang_args[], int num_clang_args)
+    {
+    OovString pchFn;
+    SourceIncludes src;
+    src.mArgs = getArgsKey(clang_args, num_clang_args);
+    src.mIncludes = getLeadingIncludes(srcFn);
+    if(src.mIncludes.size() > 0)
+        {
+        // Find the longest existing precompiled header that can be used.
+        // Don't try again to create a precompiled header that failed.
+        size_t bestPchIndex = mPchs.size();
+        size_t numBestIncludes = 0;
+        size_t numTriedIncludes = 0;
+        for(size_t pi=0; pi<mPchs.size(); pi++)
+            {
+            PchInfo const &pch = mPchs[pi];
+            if(pch.mArgs == src.mArgs && getNumCommonIncludes(pch.mIncludes,
+                    src.mIncludes) == pch.mIncludes.size())
+                {
+                if(pch.mValid && pch.mIncludes.size() > numBestIncludes)
+                    {
+                    bestPchIndex = pi;
+                    numBestIncludes = pch.mIncludes.size();
+                    }
+                numTriedIncludes = std::max(numTriedIncludes, pch.mIncludes.size());
+                }
+            }
+        // Find the most common includes with a previous source file. If
+        // they are more than the existing precompiled headers have, then
+        // make a new precompiled header for them.
+        size_t numCommon = 0;
+        for(auto const &prevSrc : mPrevSources)
+            {
+            if(prevSrc.mArgs == src.mArgs)
+                {
+                numCommon = std::max(numCommon,
+                    getNumCommonIncludes(prevSrc.mIncludes, src.mIncludes));
+                }
+            }
+        if(numCommon > numTriedIncludes && mPchs.size() < MaxPchs)
+            {
+            PchInfo pch;
+            pch.mArgs = src.mArgs;
+            pch.mIncludes.assign(src.mIncludes.begin(),
+                src.mIncludes.begin() + static_cast<int>(numCommon));
+            if(createPch(index, pch, outDir, clang_args, num_clang_args))
+                {
+                bestPchIndex = mPchs.size();
+                }
+            mPchs.push_back(pch);
+            }
+        if(bestPchIndex < mPchs.size())
+            {
+            pchFn = mPchs[bestPchIndex].mPchFn;
+            }
+        if(mPrevSources.size() >= MaxPrevSources)
+            {
+            mPrevSources.erase(mPrevSources.begin());
+            }
+        mPrevSources.push_back(src);
+        }
+    return pchFn;
+    }
+
+bool PrecompiledHeaders::createPch(CXIndex index, PchInfo &pch,
+        OovStringRef const outDir, char const * const clang_args[],
+        int num_clang_args)
+    {
+    OovString baseName = PrecompiledHeaderFilePrefix;
+    baseName.appendInt(getpid());
+    baseName += '-';
+    baseName.appendInt(static_cast<int>(mPchs.size()));
+    FilePath headerFn(outDir, FP_Dir);
+    headerFn.appendFile(baseName);
+    pch.mPchFn = headerFn;
+    pch.mPchFn += ".pch";
+    headerFn.appendExtension("h");
+    pch.mHeaderFn = headerFn;
+
+    OovString headerText;
+    for(auto const &inc : pch.mIncludes)
+        {
+        headerText += "#include ";
+        headerText += inc;
+        headerText += '\n';
+        }
+    File file;
+    OovStatus status = file.open(pch.mHeaderFn, "w");
+    if(status.ok())
+        {
+        status = file.putString(headerText);
+        file.close();
+        }
+    if(status.ok())
+        {
+        // The header must be parsed as a header instead of as a source file.
+        std::vector<char const *> args;
+        bool foundLang = false;
+        for(int i=0; i<num_clang_args; i++)
+            {
+            if(i > 0 && strcmp(clang_args[i-1], "-x") == 0 &&
+                    strcmp(clang_args[i], "c++") == 0)
+                {
+                args.push_back("c++-header");
+                foundLang = true;
+                }
+            else
+                {
+                args.push_back(clang_args[i]);
+                }
+            }
+        if(!foundLang)
+            {
+            args.insert(args.begin(), "c++-header");
+            args.insert(args.begin(), "-x");
+            }
+        unsigned options = CXTranslationUnit_DetailedPreprocessingRecord |
+            CXTranslationUnit_Incomplete | CXTranslationUnit_ForSerialization;
+        CXTranslationUnit tu;
+        CXErrorCode errCode = clang_parseTranslationUnit2(index, pch.mHeaderFn.getStr(),
+            &args[0], static_cast<int>(args.size()), 0, 0, options, &tu);
+        if(errCode == CXError_Success)
+            {
+            // Errors in the headers would be reported for every source file
+            // instead of once, so parse the source files without the
+            // precompiled header.
+            bool hasErrors = false;
+            unsigned int numDiags = clang_getNumDiagnostics(tu);
+            for(unsigned int i=0; i<numDiags; i++)
+                {
+                CXDiagnostic diag = clang_getDiagnostic(tu, i);
+                if(clang_getDiagnosticSeverity(diag) >= CXDiagnostic_Error)
+                    {
+                    hasErrors = true;
+                    }
+                clang_disposeDiagnostic(diag);
+                }
+            if(!hasErrors)
+                {
+                pch.mValid = (clang_saveTranslationUnit(tu, pch.mPchFn.getStr(),
+                    clang_defaultSaveOptions(tu)) == CXSaveError_None);
+                }
+            clang_disposeTranslationUnit(tu);
+            }
+        }
+    if(status.needReport())
+        {
+        OovString err = "Unable to write precompiled header file ";
+        err += pch.mHeaderFn;
+        status.report(ET_Error, err);
+        }
+    return pch.mValid;
+    }
+
+void PrecompiledHeaders::disablePch(OovStringRef const pchFn)
+    {
+    for(auto &pch : mPchs)
+        {
+        if(pch.mPchFn == pchFn.getStr())
+            {
+            pch.mValid = false;
+            deleteFile(pch.mPchFn);
+            }
+        }
+    }
+
+bool PrecompiledHeaders::isPrefixHeader(OovStringRef const fn) const
+    {
+    bool isPrefix = false;
+    for(auto const &pch : mPchs)
+        {
+        if(FilePathComparePaths(pch.mHeaderFn, fn) == 0)
+            {
+            isPrefix = true;
+            }
+        }
+    return isPrefix;
+    }
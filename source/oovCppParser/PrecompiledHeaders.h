@@ -0,0 +1,76 @@
+/*
+ * PrecompiledHeaders.h
+ *
+ *  \copyright 2016 DCBlaha.  Distributed under the GPL.
+ */
+
+#ifndef PRECOMPILEDHEADERS_H_
+#define PRECOMPILEDHEADERS_H_
+
+#include "OovString.h"
+#include "clang-c/Index.h"
+#include <vector>
+
+/// This creates precompiled headers for the library headers that are
+/// included at the top of source files, so that large headers such as gtk,
+/// Qt or the STL are not parsed again for every source file.
+///
+/// A precompiled header only contains the leading "#include <...>" lines of
+/// the source files that use it, so the source file still includes the same
+/// headers in the same order, and the include guards of the headers prevent
+/// parsing them again. A precompiled header is made for the common leading
+/// includes of source files that use the same clang arguments, which are
+/// normally the source files of the same component.
+class PrecompiledHeaders
+    {
+    public:
+        ~PrecompiledHeaders();
+        /// Gets the precompiled header to use for a source file. The
+        /// precompiled header is created if another source file with the
+        /// same arguments starts with the same includes.
+        /// Returns an empty string if there is no precompiled header to use.
+        /// @param index The index used to create the precompiled header.
+        /// @param srcFn The source file that will be parsed.
+        /// @param outDir The directory where precompiled headers are created.
+        /// @param clang_args The arguments used to parse the source file.
+        /// @param num_clang_args The number of clang arguments.
+        OovString getPchFilename(CXIndex index, OovStringRef const srcFn,
+            OovStringRef const outDir, char const * const clang_args[],
+            int num_clang_args);
+        /// Prevents a precompiled header from being used again, for example
+        /// if a source file could not be parsed with it.
+        void disablePch(OovStringRef const pchFn);
+        /// Returns true if the file is a header that was generated to create
+        /// a precompiled header.
+        bool isPrefixHeader(OovStringRef const fn) const;
+        /// Gets the includes at the top of a source file that can be put
+        /// in a precompiled header.
+        static OovStringVec getLeadingIncludes(OovStringRef const srcFn);
+
+    private:
+        struct PchInfo
+            {
+            PchInfo():
+                mValid(false)
+                {}
+            OovString mArgs;
+            OovStringVec mIncludes;
+            OovString mHeaderFn;
+            OovString mPchFn;
+            bool mValid;
+            };
+        struct SourceIncludes
+            {
+            OovString mArgs;
+            OovStringVec mIncludes;
+            };
+        std::vector<PchInfo> mPchs;
+        /// The leading includes of previous source files. These are used to
+        /// find common includes.
+        std::vector<SourceIncludes> mPrevSources;
+
+        bool createPch(CXIndex index, PchInfo &pch, OovStringRef const outDir,
+            char const * const clang_args[], int num_clang_args);
+    };
+
+#endif /* PRECOMPILEDHEADERS_H_ */
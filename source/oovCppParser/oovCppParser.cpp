@@ -12,53 +12,140 @@
 #include "CppParser.h"
 #include "Version.h"
 #include "OovProcessArgs.h"
+#include "Project.h"
 #include <stdlib.h>     /* exit, EXIT_FAILURE */
 #include <stdio.h>
 #include <string.h>
 
 
-static CppParser sCppParser;
-
-int main(int argc, char const *const argv[])
+/// Parses a single source file.
+/// @param session The session that is shared between source files.
+/// @param args The source file, source root directory, output directory,
+///     and the remaining arguments are the -dups and -pch switches and clang
+///     arguments.
+static CppParser::eErrorTypes parseFile(CppParserSession &session,
+        OovStringVec const &args)
     {
-    CppParser::eErrorTypes et = CppParser::ET_None;
-    OovError::setComponent(EC_OovCppParser);
-    if(argc >= 4)
+    bool dupHashes = false;
+    bool usePch = false;
+    OovProcessChildArgs childArgs;
+    for(size_t i=3; i<args.size(); i++)
         {
-        bool dupHashes = false;
-        OovProcessChildArgs childArgs;
-        for(int i=4; i<argc; i++)
+        if(args[i] == "-dups")
             {
-            if(strcmp(argv[i], "-dups") == 0)
-                {
-                dupHashes = true;
-                }
-            else
-                {
-                childArgs.addArg(argv[i]);
-                }
+            dupHashes = true;
             }
-        // This saves the CPP info in an XMI file.
-//      et = sCppParser.parse(dupHashes, argv[1], argv[2], argv[3], &argv[4], argc-4);
-        et = sCppParser.parse(dupHashes, argv[1], argv[2], argv[3],
-            childArgs.getArgv(), static_cast<int>(childArgs.getArgc()));
-        if(et == CppParser::ET_CLangError)
+        else if(args[i] == "-pch")
             {
-            fprintf(stderr, "oovCppParser: CLang error analyzing file %s.\n"
-                    "It could be an argument error (Windows spaces in path), or a bug in CLang\n", argv[1]);
+            usePch = true;
             }
-        else if(et != CppParser::ET_None && et != CppParser::ET_CompileWarnings)
+        else
             {
-            fprintf(stderr, "oovCppParser: Error analyzing file %s\n", argv[1]);
+            childArgs.addArg(args[i]);
             }
         }
-    else
+    session.setUsePrecompiledHeaders(usePch);
+    // This saves the CPP info in an XMI file.
+    CppParser parser(session);
+    CppParser::eErrorTypes et = parser.parse(dupHashes, args[0].getStr(),
+        args[1].getStr(), args[2].getStr(), childArgs.getArgv(),
+        static_cast<int>(childArgs.getArgc()));
+    if(et == CppParser::ET_CLangError)
         {
-        fprintf(stderr, "OovCppParser version %s\n", OOV_VERSION);
-        fprintf(stderr, "oovCppParser args are: sourceFilePath sourceRootDir outputProjectFilesDir [cppArgs]...\n");
+        fprintf(stderr, "oovCppParser: CLang error analyzing file %s.\n"
+                "It could be an argument error (Windows spaces in path), or a bug in CLang\n",
+                args[0].getStr());
+        }
+    else if(et != CppParser::ET_None && et != CppParser::ET_CompileWarnings)
+        {
+        fprintf(stderr, "oovCppParser: Error analyzing file %s\n", args[0].getStr());
         }
+    return et;
+    }
+
+static int getExitCode(CppParser::eErrorTypes et)
+    {
     int exitCode = 0;
     if(et != CppParser::ET_None && et != CppParser::ET_CompileWarnings)
         exitCode = EXIT_FAILURE;
     return exitCode;
     }
+
+/// Reads a line from standard input, and removes the line terminator.
+/// Returns false at the end of the input.
+static bool readStdInLine(OovString &line)
+    {
+    line.clear();
+    bool gotLine = false;
+    char buf[1000];
+    while(fgets(buf, sizeof(buf), stdin))
+        {
+        gotLine = true;
+        line += buf;
+        if(line.length() > 0 && line.back() == '\n')
+            {
+            line.pop_back();
+            break;
+            }
+        }
+    return gotLine;
+    }
+
+/// Parses many source files in one process. Each line of standard input
+/// contains the same arguments as the command line separated with tabs.
+/// After each source file is parsed, a line containing the done string is
+/// sent to standard error, and a line containing the done string and the
+/// exit code of the file is sent to standard output. An empty line or the
+/// end of the input stops the server.
+static void runServer()
+    {
+    CppParserSession session;
+    OovString line;
+    while(readStdInLine(line) && line.length() > 0)
+        {
+        OovStringVec args = line.split('\t');
+        CppParser::eErrorTypes et = CppParser::ET_ParseError;
+        if(args.size() >= 3)
+            {
+            et = parseFile(session, args);
+            }
+        else
+            {
+            fprintf(stderr, "oovCppParser: Bad server arguments %s\n", line.getStr());
+            }
+        // The errors for the file must be sent before the done strings.
+        fflush(stderr);
+        fprintf(stderr, "\n%s\n", CppParserServerDoneStr);
+        fflush(stderr);
+        fprintf(stdout, "\n%s %d\n", CppParserServerDoneStr, getExitCode(et));
+        fflush(stdout);
+        }
+    }
+
+int main(int argc, char const *const argv[])
+    {
+    CppParser::eErrorTypes et = CppParser::ET_None;
+    OovError::setComponent(EC_OovCppParser);
+    if(argc == 2 && strcmp(argv[1], CppParserServerArg) == 0)
+        {
+        runServer();
+        }
+    else if(argc >= 4)
+        {
+        OovStringVec args;
+        for(int i=1; i<argc; i++)
+            {
+            args.push_back(argv[i]);
+            }
+        CppParserSession session;
+        et = parseFile(session, args);
+        }
+    else
+        {
+        fprintf(stderr, "OovCppParser version %s\n", OOV_VERSION);
+        fprintf(stderr, "oovCppParser args are: sourceFilePath sourceRootDir outputProjectFilesDir [cppArgs]...\n");
+        fprintf(stderr, "   or: %s (arguments for each file are read from stdin)\n",
+            CppParserServerArg);
+        }
+    return getExitCode(et);
+    }
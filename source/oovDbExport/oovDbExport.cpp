@@ -0,0 +1,142 @@
+//============================================================================
+// Name        : oovDbExport.cpp
+//  \copyright 2016 DCBlaha.  Distributed under the GPL.
+//============================================================================
+
+// This writes the analysis of a project to the OovReports.db database
+// without running oovaide, so that reports can be generated from scripts.
+//
+// The XMI files are loaded and written one at a time, so the model of the
+// whole project is never in memory. Each XMI file is read twice. The first
+// pass writes the modules, types and methods, and the second pass writes
+// the references between them, since the references may be to types or
+// methods that are defined in XMI files that are read later.
+
+#include "OovDatabaseWriter.h"
+#include "Xmi2Object.h"
+#include "BuildConfigReader.h"
+#include "Components.h"
+#include "IncludeMap.h"
+#include "DirList.h"
+#include "Project.h"
+#include "Version.h"
+#include "OovError.h"
+#include <stdlib.h>     /* exit, EXIT_FAILURE */
+#include <stdio.h>
+
+
+static bool writeXmiFiles(std::vector<std::string> const &fileNames)
+    {
+    bool success = true;
+    for(int pass=0; pass<2 && success; pass++)
+        {
+        for(size_t i=0; i<fileNames.size() && success; i++)
+            {
+            std::string const &fn = fileNames[i];
+            ModelData model;
+            File file;
+            OovStatus status = file.open(fn, "r");
+            if(status.ok())
+                {
+                int typeIndex = 0;
+                loadXmiFile(file, model, fn, typeIndex);
+                model.resolveModelIds();
+                success = WriteDbModel(pass, &model);
+                }
+            if(status.needReport())
+                {
+                OovString err = "Unable to read XMI file ";
+                err += fn;
+                status.report(ET_Error, err);
+                }
+            }
+        }
+    return success;
+    }
+
+static bool writeComponents(ProjectReader &project)
+    {
+    bool success = true;
+    ComponentTypesFile compFile(project);
+    ScannedComponentInfo scannedCompInfo;
+    // The component files are optional.
+    OovStatus status = scannedCompInfo.readScannedInfo();
+    if(status.ok())
+        {
+        success = WriteDbComponentTypes(&compFile, &scannedCompInfo);
+        }
+    else
+        {
+        status.reported();
+        }
+    if(success)
+        {
+        IncDirDependencyMapReader incMapFile;
+        BuildConfigReader buildConfig;
+        status = incMapFile.read(buildConfig.getIncDepsFilePath());
+        if(status.ok())
+            {
+            success = WriteDbModuleRelations(&incMapFile);
+            }
+        else
+            {
+            status.reported();
+            }
+        }
+    return success;
+    }
+
+int main(int argc, char const * const argv[])
+    {
+    bool success = false;
+    OovError::setComponent(EC_OovDbWriter);
+    if(argc == 2)
+        {
+        ProjectReader project;
+        OovStatus status = project.readProject(argv[1]);
+        if(status.ok())
+            {
+            std::vector<std::string> fileNames;
+            BuildConfigReader buildConfig;
+            OovStatus dirStatus = getDirListMatchExt(buildConfig.getAnalysisPath(),
+                FilePath(".xmi", FP_File), fileNames);
+            if(dirStatus.ok())
+                {
+                // The library has a separate copy of the static project
+                // directory, so it is passed to the library.
+                success = OpenDb(Project::getProjectDirectory().getStr(), nullptr);
+                if(success)
+                    {
+                    success = writeXmiFiles(fileNames);
+                    if(success)
+                        {
+                        success = writeComponents(project);
+                        }
+                    CloseDb();
+                    }
+                if(!success)
+                    {
+                    fprintf(stderr, "oovDbExport: %s\n", GetLastDbError());
+                    }
+                }
+            if(dirStatus.needReport())
+                {
+                dirStatus.report(ET_Error, "Unable to find the analysis files");
+                }
+            }
+        if(status.needReport())
+            {
+            OovString err = "Unable to read project ";
+            err += argv[1];
+            status.report(ET_Error, err);
+            }
+        }
+    else
+        {
+        fprintf(stderr, "OovDbExport version %s\n", OOV_VERSION);
+        fprintf(stderr, "oovDbExport: Args are: oovProjectDir\n");
+        fprintf(stderr, "     The project must be analyzed. The database is written to\n");
+        fprintf(stderr, "     oovProjectDir/output/OovReports.db\n");
+        }
+    return(success ? 0 : EXIT_FAILURE);
+    }
@@ -7,6 +7,7 @@
 #include "OovDatabase.h"
 #include "DbString.h"
 #include <limits>
+#include <string.h>
 
 
 bool OovDatabase::exec(OovStringRef sqlStr)
@@ -48,19 +49,203 @@ bool OovDatabase::execSelectId(OovStringRef colName, OovStringRef table,
     return success;
     }
 
-bool OovDatabase::execSelectLastInsertedRowId(int &id)
+bool OovDatabase::setFastWriteMode()
     {
-    DbString rowQuery;
-    id = UNDEFINED_INT;
-    rowQuery.SELECT("last_insert_rowid()");
-    bool success = exec(rowQuery.getDbStr());
-    if(success && haveResults())
+    char const *pragmaStrs[] =
         {
-        mLastResults[0].getInt(0, std::numeric_limits<int>::max(), id);
+        "PRAGMA journal_mode = OFF",
+        "PRAGMA synchronous = OFF",
+        "PRAGMA locking_mode = EXCLUSIVE",
+        "PRAGMA temp_store = MEMORY",
+        };
+    bool success = true;
+    for(auto const *pragmaStr : pragmaStrs)
+        {
+        success = exec(pragmaStr);
+        if(!success)
+            {
+            break;
+            }
+        }
+    return success;
+    }
+
+bool OovDatabase::prepareStatements()
+    {
+    // These must be in the same order as eStatements.
+    // The ID columns are not set, so SQLite assigns the row IDs.
+    char const *stmtStrs[S_NumStatements] =
+        {
+        "INSERT INTO Module(name,codeLines,commentLines,moduleLines) "
+            "VALUES(?,?,?,?)",
+        "INSERT INTO Type(name,idOwningModule,lineNumber) VALUES(?,?,?)",
+        "INSERT INTO Method(name,lineNumber,visibility,const,virtual,"
+            "idOwningType,idOwningModule) VALUES(?,?,?,?,?,?,?)",
+        "INSERT INTO TypeRelation(typeRelationDescription,visibility,"
+            "idSupplierType,idConsumerType) VALUES(?,?,?,?)",
+        "INSERT INTO ModuleRelation(idSupplierModule,idConsumerModule) "
+            "VALUES(?,?)",
+        "INSERT INTO MethodTypeRef(name,varRelationDescription,idOwningMethod,"
+            "idSupplierType) VALUES(?,?,?,?)",
+        "INSERT INTO Statement(statementDescription,lineNumber,idOwningMethod,"
+            "idSupplierClass,idSupplierMethod) VALUES(?,?,?,?,?)",
+        "INSERT INTO Component(name) VALUES(?)",
+        "UPDATE Module SET idOwningComponent=? WHERE idModule=?",
+        "UPDATE Type SET idOwningModule=?,lineNumber=? WHERE idType=?",
+        "UPDATE Method SET idOwningModule=?,lineNumber=? WHERE idMethod=?",
+        };
+    // The tables were just created, so there are no IDs from a previous
+    // database.
+    mModuleIds.clear();
+    mTypeIds.clear();
+    mComponentIds.clear();
+    mMethodIds.clear();
+    mTypeModuleIds.clear();
+    mMethodsWithoutModule.clear();
+    bool success = true;
+    for(size_t i=0; i<S_NumStatements; i++)
+        {
+        mStatements[i] = prepareDb(stmtStrs[i]);
+        if(!mStatements[i])
+            {
+            OovString errStr = stmtStrs[i];
+            errStr += " : ";
+            errStr += mSqlError;
+            setLastError(errStr);
+            success = false;
+            break;
+            }
+        }
+    return success;
+    }
+
+bool OovDatabase::beginTransaction(size_t maxTransactionBytes)
+    {
+    mMaxTransactionBytes = maxTransactionBytes;
+    mTransactionBytes = 0;
+    bool success = exec("begin");
+    mInTransaction = success;
+    return success;
+    }
+
+bool OovDatabase::endTransaction()
+    {
+    bool success = true;
+    if(mInTransaction)
+        {
+        mInTransaction = false;
+        success = exec("end");
+        }
+    return success;
+    }
+
+bool OovDatabase::execStatement(eStatements stmtIndex,
+        std::initializer_list<DbBindValue> values)
+    {
+    sqlite3_stmt *stmt = mStatements[stmtIndex];
+    bool success = true;
+    size_t numBytes = 0;
+    int paramIndex = 1;
+    for(auto const &val : values)
+        {
+        if(val.mIsText)
+            {
+            success = bindDbText(stmt, paramIndex, val.mText);
+            if(val.mText)
+                {
+                numBytes += strlen(val.mText);
+                }
+            }
+        else
+            {
+            success = bindDbInt(stmt, paramIndex, val.mInt);
+            numBytes += sizeof(val.mInt);
+            }
+        if(!success)
+            {
+            break;
+            }
+        paramIndex++;
+        }
+    if(success)
+        {
+        success = stepDb(stmt);
+        }
+    if(!success)
+        {
+        OovString errStr = "Unable to write record : ";
+        errStr += mSqlError;
+        setLastError(errStr);
+        }
+    // A large transaction is much faster than many small transactions, but
+    // it uses more memory, so the transaction is split.
+    if(success && mInTransaction)
+        {
+        mTransactionBytes += numBytes;
+        if(mTransactionBytes >= mMaxTransactionBytes)
+            {
+            mTransactionBytes = 0;
+            success = exec("end");
+            if(success)
+                {
+                success = exec("begin");
+                }
+            }
+        }
+    return success;
+    }
+
+void OovDatabase::setMissingError(OovStringRef table, OovStringRef name)
+    {
+    OovString str = "Missing id for table ";
+    str += table;
+    str += " name ";
+    str += name;
+    setLastError(str);
+    }
+
+bool OovDatabase::getNameId(NameIds const &ids, OovStringRef table,
+    OovStringRef name, bool failMissing, int &id)
+    {
+    bool success = true;
+    auto const &iter = ids.find(name.getStr());
+    if(iter != ids.end())
+        {
+        id = (*iter).second;
+        }
+    else
+        {
+        id = UNDEFINED_INT;
+        if(failMissing)
+            {
+            setMissingError(table, name);
+            success = false;
+            }
         }
     return success;
     }
 
+bool OovDatabase::addNameRecord(NameIds &ids, eStatements stmtIndex,
+    OovStringRef name, std::initializer_list<DbBindValue> values, int &id)
+    {
+    bool success = true;
+    auto const &iter = ids.find(name.getStr());
+    if(iter != ids.end())
+        {
+        id = (*iter).second;
+        }
+    else
+        {
+        id = UNDEFINED_INT;
+        success = execStatement(stmtIndex, values);
+        if(success)
+            {
+            id = getDbLastInsertRowId();
+            ids[name.getStr()] = id;
+            }
+        }
+    return success;
+    }
 
 bool OovDatabase::createTables()
     {
@@ -165,71 +350,45 @@ bool OovDatabase::createTables()
             success = exec("end");
             }
         }
-    return success;
-    }
-
-bool OovDatabase::addRecord(OovStringRef colIdName, OovStringRef tableName,
-    OovStringRef srchColName, OovStringRef srchColVal,
-    DbNames insertColNames, DbValues insertColValues, int &retId)
-    {
-    bool success = execSelectId(colIdName, tableName, srchColName, srchColVal,
-        false, retId);
-    if(success && retId == UNDEFINED_INT)
+    if(success)
         {
-        DbString ins;
-        ins.INSERT(tableName).INTO(insertColNames).VALUES(insertColValues);
-        success = exec(ins.getDbStr());
-        if(success)
-            {
-            success = execSelectLastInsertedRowId(retId);
-            }
+        success = prepareStatements();
         }
     return success;
     }
 
-bool OovDatabase::addName(OovStringRef colIdName, OovStringRef tableName,
-    OovStringRef nameColName, OovStringRef nameValName, int &retId)
-    {
-    return addRecord(colIdName, tableName, nameColName, nameValName,
-        {colIdName, nameColName}, {nullptr, nameValName.getStr()}, retId);
-    }
-
 bool OovDatabase::addComponent(OovStringRef name, int &componentId)
     {
-    return addName("idComponent", "Component", "name", name, componentId);
+    return addNameRecord(mComponentIds, S_InsertComponent, name,
+        { name.getStr() }, componentId);
     }
 
 bool OovDatabase::updateModuleWithComponent(OovStringRef name, int componentId)
     {
     int moduleId;
     bool success = getModuleId(name, false, moduleId);
-    if(success)
+    if(success && moduleId != UNDEFINED_INT)
         {
-        DbString dbStr;
-        dbStr.UPDATE("Module").SET({"idOwningComponent"},
-                {componentId}).WHERE("idModule", "=", moduleId);
-        success = exec(dbStr.getDbStr());
+        success = execStatement(S_UpdateModuleComponent, { componentId, moduleId });
         }
     return success;
     }
 
 bool OovDatabase::getModuleId(OovStringRef name, bool failMissing, int &moduleId)
     {
-    return execSelectId("idModule", "Module", "name", name, failMissing, moduleId);
+    return getNameId(mModuleIds, "Module", name, failMissing, moduleId);
     }
 
 bool OovDatabase::addModule(OovStringRef name, int &moduleId, int codeLines,
     int commentLines, int moduleLines)
     {
-    return addRecord("idModule", "Module", "name", name,
-        {"idModule", "name", "codeLines", "commentLines", "moduleLines"},
-        { nullptr, name.getStr(), codeLines, commentLines, moduleLines },
-        moduleId);
+    return addNameRecord(mModuleIds, S_InsertModule, name,
+        { name.getStr(), codeLines, commentLines, moduleLines }, moduleId);
     }
 
 bool OovDatabase::getTypeId(OovStringRef name, bool failMissing, int &typeId)
     {
-    return execSelectId("idType", "Type", "name", name, failMissing, typeId);
+    return getNameId(mTypeIds, "Type", name, failMissing, typeId);
     }
 
 bool OovDatabase::addType(OovStringRef name, int moduleId, int lineNum,
@@ -238,15 +397,22 @@ bool OovDatabase::addType(OovStringRef name, int moduleId, int lineNum,
     bool success = getTypeId(name, false, typeId);
     if(success && typeId == UNDEFINED_INT)
         {
-        DbString ins;
-        ins.INSERT("Type").INTO({"idType","name","idOwningModule","lineNumber"}).
-                VALUES({nullptr, name.getStr(), moduleId, lineNum});
-        success = exec(ins.getDbStr());
+        success = addNameRecord(mTypeIds, S_InsertType, name,
+            { name.getStr(), moduleId, lineNum }, typeId);
         if(success)
             {
-            success = execSelectLastInsertedRowId(typeId);
+            mTypeModuleIds[typeId] = moduleId;
             }
         }
+    // When a model is written one file at a time, a type can be used in
+    // files before the files that define the type. The module is from the
+    // last definition the same as when the XMI files are loaded into a model.
+    else if(success && moduleId != UNDEFINED_INT &&
+            mTypeModuleIds[typeId] != moduleId)
+        {
+        mTypeModuleIds[typeId] = moduleId;
+        success = execStatement(S_UpdateTypeModule, { moduleId, lineNum, typeId });
+        }
     return success;
     }
 
@@ -255,18 +421,15 @@ bool OovDatabase::addTypeRelation(OovStringRef supplierName, OovStringRef consum
     {
     int idSupplier = UNDEFINED_INT;
     int idConsumer = UNDEFINED_INT;
-    bool success = execSelectId("idType", "Type", "name", supplierName, true, idSupplier);
-    if(success && idSupplier != UNDEFINED_INT)
+    bool success = getTypeId(supplierName, true, idSupplier);
+    if(success)
         {
-        success = execSelectId("idType", "Type", "name", consumerName, true, idConsumer);
+        success = getTypeId(consumerName, true, idConsumer);
         }
-    if(success && idSupplier != UNDEFINED_INT && idConsumer != UNDEFINED_INT)
+    if(success)
         {
-        DbString ins;
-        ins.INSERT("TypeRelation").INTO({"idTypeRelation",
-            "typeRelationDescription","visibility","idSupplierType","idConsumerType"}).
-            VALUES({nullptr, tr, visibility, idSupplier, idConsumer});
-        success = exec(ins.getDbStr());
+        success = execStatement(S_InsertTypeRelation,
+            { tr, visibility, idSupplier, idConsumer });
         }
     return success;
     }
@@ -277,71 +440,82 @@ bool OovDatabase::addModuleRelation(OovStringRef supplierName, OovStringRef cons
     int idConsumer = UNDEFINED_INT;
     // At the moment, the external project includes are not added previously,
     // so they will not be found to add relations.
-    bool success = execSelectId("idModule", "Module", "name", supplierName, false, idSupplier);
+    bool success = getModuleId(supplierName, false, idSupplier);
     if(success && idSupplier != UNDEFINED_INT)
         {
-        success = execSelectId("idModule", "Module", "name", consumerName, false, idConsumer);
+        success = getModuleId(consumerName, false, idConsumer);
         }
     if(success && idSupplier != UNDEFINED_INT && idConsumer != UNDEFINED_INT)
         {
-        DbString ins;
-        ins.INSERT("ModuleRelation").INTO({"idModuleRelation",
-            "idSupplierModule","idConsumerModule"}).
-            VALUES({nullptr, idSupplier, idConsumer});
-        success = exec(ins.getDbStr());
+        success = execStatement(S_InsertModuleRelation, { idSupplier, idConsumer });
         }
     return success;
     }
 
 bool OovDatabase::getMethodId(int idClass, OovStringRef name, bool failMissing, int &methodId)
     {
-    return execSelectId("idMethod", "Method", "name", name, failMissing, methodId);
+    bool success = true;
+    auto const &iter = mMethodIds.find(std::make_pair(idClass, std::string(name)));
+    if(iter != mMethodIds.end())
+        {
+        methodId = (*iter).second;
+        }
+    else
+        {
+        methodId = UNDEFINED_INT;
+        if(failMissing)
+            {
+            setMissingError("Method", name);
+            success = false;
+            }
+        }
+    return success;
     }
 
 bool OovDatabase::addMethod(OovStringRef name, int lineNum, int visibility,
     bool isConst, bool isVirt, int owningTypeId, int owningModuleId, int &methodId)
     {
-    DbString ins;
-    methodId = UNDEFINED_INT;
     bool success = getMethodId(owningTypeId, name, false, methodId);
     if(success && methodId == UNDEFINED_INT)
         {
-        ins.INSERT("Method").INTO({"idMethod","name","lineNumber",
-            "visibility", "const", "virtual", "idOwningType", "idOwningModule"}).
-            VALUES({nullptr, name.getStr(), lineNum, visibility, isConst, isVirt,
-            owningTypeId, owningModuleId});
-        success = exec(ins.getDbStr());
+        success = execStatement(S_InsertMethod, { name.getStr(), lineNum,
+            visibility, isConst, isVirt, owningTypeId, owningModuleId });
         if(success)
             {
-            success = execSelectLastInsertedRowId(methodId);
+            methodId = getDbLastInsertRowId();
+            mMethodIds[std::make_pair(owningTypeId, std::string(name))] = methodId;
+            if(owningModuleId == UNDEFINED_INT)
+                {
+                mMethodsWithoutModule.insert(methodId);
+                }
             }
         }
+    // The method may be declared in a file that is written before the
+    // file that defines the method.
+    else if(success && owningModuleId != UNDEFINED_INT &&
+            mMethodsWithoutModule.erase(methodId) > 0)
+        {
+        success = execStatement(S_UpdateMethodModule,
+            { owningModuleId, lineNum, methodId });
+        }
     return success;
     }
 
 bool OovDatabase::addMethodTypeRef(OovStringRef identName, eVarRelations varRel,
     int idOwningMethod, int idSupplierType)
     {
-    DbString ins;
-    ins.INSERT("MethodTypeRef").INTO({"idMethodTypeRef","name",
-        "varRelationDescription","idOwningMethod", "idSupplierType"}).
-        VALUES({nullptr, identName.getStr(), varRel, idOwningMethod, idSupplierType});
-    return exec(ins.getDbStr());
+    return execStatement(S_InsertMethodTypeRef, { identName.getStr(), varRel,
+        idOwningMethod, idSupplierType });
     }
 
 bool OovDatabase::addStatement(int statementType, int lineNum, int idOwningMethod,
     int idSupplierClass, int idSupplierMethod)
     {
-    DbString ins;
-    ins.INSERT("Statement").INTO({"idStatement", "statementDescription",
-        "lineNumber","idOwningMethod","idSupplierClass", "idSupplierMethod"}).
-        VALUES({nullptr,statementType, lineNum, idOwningMethod,
-        idSupplierClass, idSupplierMethod});
-    return exec(ins.getDbStr());
+    return execStatement(S_InsertStatement, { statementType, lineNum,
+        idOwningMethod, idSupplierClass, idSupplierMethod });
     }
 
 
-
 /// Old interface code for ODBC and MySql
 /*
 #if(0)
@@ -9,20 +9,60 @@
 
 #include "SQLiteImport.h"
 #include "DbString.h"           // For DbNames and DbValues
+#include <unordered_map>
+#include <unordered_set>
+#include <map>
+#include <initializer_list>
 
 #define UNDEFINED_INT -1
 
+/// A value that is bound to a parameter of a prepared statement.
+class DbBindValue
+    {
+    public:
+        DbBindValue(int val):
+            mText(nullptr), mInt(val), mIsText(false)
+            {}
+        /// @param val Use nullptr to indicate NULL. The string is not
+        ///            copied, so it must exist until the statement is run.
+        DbBindValue(char const *val):
+            mText(val), mInt(0), mIsText(true)
+            {}
+        char const *mText;
+        int mInt;
+        bool mIsText;
+    };
+
+/// This writes records using prepared statements. The IDs of the modules,
+/// types, methods and components are kept in memory, so the database
+/// does not have to be queried to find them. This requires that the
+/// database is only written by this class after the tables are created.
 class OovDatabase:public SQLite, public SQLiteListener
     {
     public:
-        OovDatabase()
+        OovDatabase():
+            mStatements(), mInTransaction(false), mMaxTransactionBytes(0),
+            mTransactionBytes(0)
             {
             setListener(this);
             }
         virtual ~OovDatabase()
             {}
-        /// Create all of the tables needed for the database.
+        /// The database is only a report that is created again every time
+        /// it is written, so this turns off the journal and the disk
+        /// synchronization. If the program stops while writing, the
+        /// database may be corrupt.
+        bool setFastWriteMode();
+        /// Create all of the tables needed for the database, and prepare
+        /// the statements that are used to add records.
         bool createTables();
+        /// Start a transaction that is ended and started again after about
+        /// maxTransactionBytes of data have been added.
+        /// @param maxTransactionBytes The size of the data in the records
+        ///     that are added in each transaction.
+        bool beginTransaction(size_t maxTransactionBytes);
+        /// End the transaction that was started with beginTransaction.
+        bool endTransaction();
 //        bool initIntegrity()
 //            { return exec("PRAGMA foreign_keys = ON"); }
         /// Query the Module table by name to find the module ID.
@@ -53,7 +93,8 @@ class OovDatabase:public SQLite, public SQLiteListener
         /// @param failMissing Set true to set an error string and fail the return.
         /// @param id The returned type ID.
         bool getTypeId(OovStringRef name, bool failMissing, int &id);
-        /// Add a type to the Type table.
+        /// Add a type to the Type table. If the type was already added
+        /// with a different module, the module and line number are updated.
         /// @param name The name of the type to add.
         /// @param moduleId The module ID of the type's definition.
         /// @param lineNum The line number in the module where the type is defined.
@@ -82,7 +123,8 @@ class OovDatabase:public SQLite, public SQLiteListener
         /// @param failMissing Set true to set an error string and fail the return.
         /// @param id The returned method id.
         bool getMethodId(int idClass, OovStringRef name, bool failMissing, int &id);
-        /// Add a method to the Method table.
+        /// Add a method to the Method table. If the method was already added
+        /// without a module, the module and line number are updated.
         /// @param name The name of the method to add.
         /// @param lineNum The line number where the method is defined.
         /// @param visibility The Visibility values are defined in the
@@ -129,10 +171,6 @@ class OovDatabase:public SQLite, public SQLiteListener
         /// @param id The returned ID.
         bool execSelectId(OovStringRef idColName, OovStringRef table,
                 OovStringRef srchColName, OovStringRef srchColVal, bool failMissing, int &id);
-        /// Run the last_insert_rowid() function from the database to get
-        /// the last inserted row ID.
-        /// @param id The ID of the last record that was inserted.
-        bool execSelectLastInsertedRowId(int &id);
         /// Get the last error that was set when an error occurred.
         OovStringRef getLastError() const
             { return mLastError; }
@@ -144,15 +182,41 @@ class OovDatabase:public SQLite, public SQLiteListener
             { return(mLastResults.size() > 0); }
 
     private:
+        enum eStatements { S_InsertModule, S_InsertType, S_InsertMethod,
+            S_InsertTypeRelation, S_InsertModuleRelation, S_InsertMethodTypeRef,
+            S_InsertStatement, S_InsertComponent, S_UpdateModuleComponent,
+            S_UpdateTypeModule, S_UpdateMethodModule, S_NumStatements };
+        typedef std::unordered_map<std::string, int> NameIds;
         std::vector<OovString> mLastResults;
         OovString mLastError;
         OovString mSqlError;
+        sqlite3_stmt *mStatements[S_NumStatements];
+        NameIds mModuleIds;
+        NameIds mTypeIds;
+        NameIds mComponentIds;
+        /// The key is the class ID and the method name.
+        std::map<std::pair<int, std::string>, int> mMethodIds;
+        /// The key is the type ID, and the value is the module ID.
+        std::unordered_map<int, int> mTypeModuleIds;
+        /// The methods that were added without a module.
+        std::unordered_set<int> mMethodsWithoutModule;
+        bool mInTransaction;
+        size_t mMaxTransactionBytes;
+        size_t mTransactionBytes;
 
-        bool addName(OovStringRef colIdName, OovStringRef tableName,
-                OovStringRef nameColName, OovStringRef nameValName, int &retId);
-        bool addRecord(OovStringRef colIdName, OovStringRef tableName,
-            OovStringRef srchColName, OovStringRef srchColVal,
-            DbNames insertColNames, DbValues insertColValues, int &retId);
+        bool prepareStatements();
+        /// Bind the values to the parameters of a prepared statement and
+        /// execute it.
+        bool execStatement(eStatements stmtIndex,
+            std::initializer_list<DbBindValue> values);
+        /// Find an ID in one of the ID maps.
+        bool getNameId(NameIds const &ids, OovStringRef table,
+            OovStringRef name, bool failMissing, int &id);
+        /// Add a record to a table if the name is not in the ID map.
+        bool addNameRecord(NameIds &ids, eStatements stmtIndex,
+            OovStringRef name, std::initializer_list<DbBindValue> values,
+            int &id);
+        void setMissingError(OovStringRef table, OovStringRef name);
         virtual void SQLError(int retCode, char const *errMsg) override
             {
             mSqlError = errMsg;
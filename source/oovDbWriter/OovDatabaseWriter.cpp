@@ -12,6 +12,8 @@
 #include "ModelObjects.h"
 #include "FilePath.h"   // For FileDelete.
 #include "OovDatabaseWriter.h"
+#include <unordered_set>
+#include <limits>
 
 // SQL possible order of evaluation:
 //    FROM
@@ -51,6 +53,10 @@
 
 /////////////////
 
+// All records are written in transactions of about this size. The sizes
+// of the records are estimated from the sizes of the bound values.
+static size_t const sMaxTransactionBytes = 4 * 1024 * 1024;
+
 class DbWriter
     {
     public:
@@ -58,8 +64,11 @@ class DbWriter
             mModelData(nullptr)
             {}
         // The project directory is used to find the place to store the output.
+        // The modelData can be null if writeModel is used.
         bool openDatabase(char const *projectDir, ModelData const *modelData);
-        bool writeTypes(int passIndex, int &typeIndex, int maxTypesPerTransaction);
+        bool writeTypes(int passIndex, int &typeIndex, int maxTypes);
+        // Write all types of a model that was loaded from some of the files.
+        bool writeModel(int passIndex, ModelData const *modelData);
         bool writeComponentsInfo(ComponentTypesFile const* compTypesFile,
                 ScannedComponentInfo const *scannedCompInfo);
         bool writeModuleRelations(IncDirDependencyMapReader const* incMapFile);
@@ -70,10 +79,15 @@ class DbWriter
     private:
         OovDatabase mDb;
         ModelData const *mModelData;
+        // A method can be in many models when the models are written one
+        // file at a time, so these prevent writing the references of a
+        // method more than once.
+        std::unordered_set<int> mWrittenMethodParams;
+        std::unordered_set<int> mWrittenMethodBodies;
 
-        bool writeTypesAndMethods(int &typeIndex, int maxTypesPerTransaction);
+        bool writeTypesAndMethods(int &typeIndex, int maxTypes);
         // Write all type refs for the types specified by the index. Except associations.
-        bool writeTypeRefs(int &typeIndex, int maxTypesPerTransaction);
+        bool writeTypeRefs(int &typeIndex, int maxTypes);
         // Writes inheritance relations.
         bool writeAssociations();
         // Write aggregation and composition.
@@ -94,6 +108,8 @@ bool DbWriter::openDatabase(char const *projectDir, ModelData const *modelData)
     {
     Project::setProjectDirectory(projectDir);
     mModelData = modelData;
+    mWrittenMethodParams.clear();
+    mWrittenMethodBodies.clear();
     mDb.close();
     FilePath dbFn = Project::getOutputDir();
     dbFn.appendFile("OovReports.db");
@@ -113,7 +129,15 @@ bool DbWriter::openDatabase(char const *projectDir, ModelData const *modelData)
         success = mDb.openDb(dbFn.getStr());
         if(success)
             {
-            success = mDb.createTables();
+            success = mDb.setFastWriteMode();
+            if(success)
+                {
+                success = mDb.createTables();
+                }
+            if(success)
+                {
+                success = mDb.beginTransaction(sMaxTransactionBytes);
+                }
             }
         else
             {
@@ -137,7 +161,6 @@ bool DbWriter::writeComponentsInfo(ComponentTypesFile const* compTypesFile,
     bool success = true;
     if(compTypesFile)
         {
-        success = mDb.exec("begin");
         OovStringVec compNames = compTypesFile->getDefinedComponentNames();
         for(auto const &compName : compNames)
             {
@@ -164,10 +187,6 @@ bool DbWriter::writeComponentsInfo(ComponentTypesFile const* compTypesFile,
                 break;
                 }
             }
-        if(success)
-            {
-            success = mDb.exec("end");
-            }
         }
     return success;
     }
@@ -177,53 +196,56 @@ bool DbWriter::writeModuleRelations(IncDirDependencyMapReader const* incMapFile)
     bool success = true;
     if(incMapFile)
         {
-        success = mDb.exec("begin");
-        if(success)
+        std::set<OovString> allFiles = incMapFile->getAllFiles();
+        for(auto const &consFile : allFiles)
             {
-            std::set<OovString> allFiles = incMapFile->getAllFiles();
-            for(auto const &consFile : allFiles)
+            std::set<IncludedPath> incFiles;
+            incMapFile->getImmediateIncludeFilesUsedBySourceFile(consFile, incFiles);
+            for(auto const &supFile : incFiles)
                 {
-                std::set<IncludedPath> incFiles;
-                incMapFile->getImmediateIncludeFilesUsedBySourceFile(consFile, incFiles);
-                for(auto const &supFile : incFiles)
+                success = mDb.addModuleRelation(supFile.getFullPath(), consFile);
+                if(!success)
                     {
-                    success = mDb.addModuleRelation(supFile.getFullPath(), consFile);
-                    if(!success)
-                        {
-                        break;
-                        }
+                    break;
                     }
                 }
-            }
-        if(success)
-            {
-            success = mDb.exec("end");
+            if(!success)
+                {
+                break;
+                }
             }
         }
     return success;
     }
 
-bool DbWriter::writeTypes(int passIndex, int &typeIndex, int maxTypesPerTransaction)
+bool DbWriter::writeTypes(int passIndex, int &typeIndex, int maxTypes)
     {
     bool success = true;
     if(passIndex == 0)
         {
-        success = writeTypesAndMethods(typeIndex, maxTypesPerTransaction);
+        success = writeTypesAndMethods(typeIndex, maxTypes);
         }
     else if(passIndex == 1)
         {
-        success = writeTypeRefs(typeIndex, maxTypesPerTransaction);
+        success = writeTypeRefs(typeIndex, maxTypes);
         }
     else
         {
         typeIndex++;
         }
     return success;
+    }
+
+bool DbWriter::writeModel(int passIndex, ModelData const *modelData)
+    {
+    mModelData = modelData;
+    int typeIndex = 0;
+    return writeTypes(passIndex, typeIndex, std::numeric_limits<int>::max());
     }
 
-bool DbWriter::writeTypesAndMethods(int &typeIndex, int maxTypesPerTransaction)
+bool DbWriter::writeTypesAndMethods(int &typeIndex, int maxTypes)
     {
-    bool success = mDb.exec("begin");
+    bool success = true;
     size_t highestIndex = 0;
     for(size_t i=typeIndex; i<mModelData->mTypes.size() && success; i++)
         {
@@ -276,15 +298,11 @@ bool DbWriter::writeTypesAndMethods(int &typeIndex, int maxTypesPerTransaction)
                     }
                 }
             }
-        if(--maxTypesPerTransaction <= 0)
+        if(--maxTypes <= 0)
             {
             break;
             }
         }
-    if(success)
-        {
-        success = mDb.exec("end");
-        }
     if(success)
         {
         typeIndex = highestIndex;
@@ -393,14 +411,17 @@ bool DbWriter::writeStatement(ModelStatement const &stmt, int idMethod, int stat
 bool DbWriter::writeMethodTypeRefs(int idMethod, ModelOperation const *oper)
     {
     bool success = true;
-    success = writeTypeRefs(idMethod, oper->getParams(), OovDatabase::VR_Parameter);
-    if(success)
+    if(mWrittenMethodParams.insert(idMethod).second)
         {
-        success = writeTypeRefs(idMethod, oper->getBodyVarDeclarators(),
-            OovDatabase::VR_BodyVariable);
+        success = writeTypeRefs(idMethod, oper->getParams(), OovDatabase::VR_Parameter);
         }
-    if(success)
+    // Only the definition of a method has a body.
+    bool haveBody = (oper->getBodyVarDeclarators().size() > 0 ||
+        oper->getStatements().size() > 0);
+    if(success && haveBody && mWrittenMethodBodies.insert(idMethod).second)
         {
+        success = writeTypeRefs(idMethod, oper->getBodyVarDeclarators(),
+            OovDatabase::VR_BodyVariable);
         for(size_t i=0; i<oper->getStatements().size() && success; i++)
             {
             auto const &stmt = oper->getStatements()[i];
@@ -414,9 +435,9 @@ bool DbWriter::writeMethodTypeRefs(int idMethod, ModelOperation const *oper)
     return success;
     }
 
-bool DbWriter::writeTypeRefs(int &typeIndex, int maxTypesPerTransaction)
+bool DbWriter::writeTypeRefs(int &typeIndex, int maxTypes)
     {
-    bool success = mDb.exec("begin");
+    bool success = true;
     size_t highestIndex = 0;
     if(success && typeIndex == 0)
         {
@@ -455,16 +476,12 @@ bool DbWriter::writeTypeRefs(int &typeIndex, int maxTypesPerTransaction)
                         }
                     }
                 }
-            if(--maxTypesPerTransaction <= 0)
+            if(--maxTypes <= 0)
                 {
                 break;
                 }
             }
         }
-    if(success)
-        {
-        success = mDb.exec("end");
-        }
     if(success)
         {
         typeIndex = highestIndex;
@@ -475,8 +492,6 @@ bool DbWriter::writeTypeRefs(int &typeIndex, int maxTypesPerTransaction)
 bool DbWriter::writeAssociations()
     {
     bool success = true;
-// The outer calling method already does a begin/end
-//    bool success = mDb.exec("begin");
     for(size_t i=0; i<mModelData->mAssociations.size() && success; i++)
         {
         ModelAssociation *assoc = mModelData->mAssociations[i].get();
@@ -485,15 +500,17 @@ bool DbWriter::writeAssociations()
         success = mDb.addTypeRelation(parent->getName(), child->getName(),
             assoc->getAccess().getVis(), OovDatabase::TR_Inheritance);
         }
-    if(success)
-        {
-//        success = mDb.exec("end");
-        }
     return success;
     }
 
 void DbWriter::closeDatabase()
     {
+    // The records that were written after the last full transaction are
+    // written here.
+    if(!mDb.endTransaction())
+        {
+        OovError::report(ET_Error, mDb.getLastError());
+        }
     mDb.closeDb();
     }
 
@@ -504,8 +521,13 @@ SHAREDSHARED_EXPORT bool OpenDb(char const *projectDir, void const *modelData)
     return sDbWriter.openDatabase(projectDir, static_cast<ModelData const*>(
         modelData));
     }
-SHAREDSHARED_EXPORT bool WriteDb(int passIndex, int &typeIndex, int maxTypesPerTransaction)
-    { return sDbWriter.writeTypes(passIndex, typeIndex, maxTypesPerTransaction); }
+SHAREDSHARED_EXPORT bool WriteDb(int passIndex, int &typeIndex, int maxTypes)
+    { return sDbWriter.writeTypes(passIndex, typeIndex, maxTypes); }
+SHAREDSHARED_EXPORT bool WriteDbModel(int passIndex, void const *modelData)
+    {
+    return sDbWriter.writeModel(passIndex, static_cast<ModelData const*>(
+        modelData));
+    }
 SHAREDSHARED_EXPORT bool WriteDbComponentTypes(void const *compTypesFile,
     void const *scannedCompInfoFile)
     {
@@ -18,10 +18,18 @@
 
 extern "C"
 {
+/// modelData can be null if only WriteDbModel is used.
 SHAREDSHARED_EXPORT bool OpenDb(char const *projectDir, void const *modelData);
 /// typeIndex is updated to the last successfully written index.
-SHAREDSHARED_EXPORT bool WriteDb(int passIndex, int &typeIndex,
-    int maxTypesPerTransaction);
+/// maxTypes is the number of types written by each call. The records are
+/// written to the database in transactions that are sized by the amount of
+/// data, and the last transaction is written when CloseDb is called.
+SHAREDSHARED_EXPORT bool WriteDb(int passIndex, int &typeIndex, int maxTypes);
+/// Write all types of a model that was loaded from some of the XMI files.
+/// This allows writing a project one XMI file at a time, so that the whole
+/// project does not have to be loaded. Pass 0 must be written for the
+/// models of all files before pass 1 is written for any of them.
+SHAREDSHARED_EXPORT bool WriteDbModel(int passIndex, void const *modelData);
 SHAREDSHARED_EXPORT bool WriteDbComponentTypes(void const *compTypesFile,
     void const *scannedCompInfoFile);
 SHAREDSHARED_EXPORT bool WriteDbModuleRelations(void const *includeMapFile);
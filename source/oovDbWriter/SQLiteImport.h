@@ -12,12 +12,15 @@
 // The OovLibrary contains a minimal wrapper for loading run time libraries
 // on Linux or Windows.
 #include "OovLibrary.h"
+#include <vector>
 
 // This is the C style interface to the run-time library.
 extern "C"
 {
 typedef struct sqlite3 sqlite3;
+typedef struct sqlite3_stmt sqlite3_stmt;
 typedef int (*SQLite_callback)(void*,int,char**,char**);
+typedef void (*SQLite_destructor)(void*);
 
 struct SQLiteInterface
     {
@@ -27,12 +30,28 @@ struct SQLiteInterface
         SQLite_callback callback, void *callback_data,
         char **errmsg);
     void (*sqlite3_free)(void*);
+    int (*sqlite3_prepare_v2)(sqlite3 *pDb, const char *sql, int numBytes,
+        sqlite3_stmt **ppStmt, const char **pzTail);
+    int (*sqlite3_bind_int)(sqlite3_stmt *pStmt, int index, int val);
+    int (*sqlite3_bind_text)(sqlite3_stmt *pStmt, int index, const char *val,
+        int numBytes, SQLite_destructor destructor);
+    int (*sqlite3_bind_null)(sqlite3_stmt *pStmt, int index);
+    int (*sqlite3_step)(sqlite3_stmt *pStmt);
+    int (*sqlite3_reset)(sqlite3_stmt *pStmt);
+    int (*sqlite3_finalize)(sqlite3_stmt *pStmt);
+    long long (*sqlite3_last_insert_rowid)(sqlite3 *pDb);
+    const char *(*sqlite3_errmsg)(sqlite3 *pDb);
     };
 };
 
 // This is normally defined in sqlite3.h, so if more error codes are needed,
 // get them from there.
 #define SQLITE_OK 0
+#define SQLITE_ROW 100
+#define SQLITE_DONE 101
+// The bound value is not copied, and must exist until the statement is
+// stepped.
+#define SQLITE_STATIC ((SQLite_destructor)0)
 
 /// This loads the symbols from the DLL into the interface.
 class SQLiteImporter:public SQLiteInterface, public OovLibrary
@@ -45,6 +64,16 @@ class SQLiteImporter:public SQLiteInterface, public OovLibrary
             loadModuleSymbol("sqlite3_exec", (OovProcPtr*)&sqlite3_exec);
             // This must be called for returned error strings.
             loadModuleSymbol("sqlite3_free", (OovProcPtr*)&sqlite3_free);
+            loadModuleSymbol("sqlite3_prepare_v2", (OovProcPtr*)&sqlite3_prepare_v2);
+            loadModuleSymbol("sqlite3_bind_int", (OovProcPtr*)&sqlite3_bind_int);
+            loadModuleSymbol("sqlite3_bind_text", (OovProcPtr*)&sqlite3_bind_text);
+            loadModuleSymbol("sqlite3_bind_null", (OovProcPtr*)&sqlite3_bind_null);
+            loadModuleSymbol("sqlite3_step", (OovProcPtr*)&sqlite3_step);
+            loadModuleSymbol("sqlite3_reset", (OovProcPtr*)&sqlite3_reset);
+            loadModuleSymbol("sqlite3_finalize", (OovProcPtr*)&sqlite3_finalize);
+            loadModuleSymbol("sqlite3_last_insert_rowid",
+                (OovProcPtr*)&sqlite3_last_insert_rowid);
+            loadModuleSymbol("sqlite3_errmsg", (OovProcPtr*)&sqlite3_errmsg);
             }
     };
 
@@ -104,12 +133,65 @@ class SQLite:public SQLiteImporter
                 }
             return success;
             }
+        /// Compile an SQL statement so that it can be executed many times
+        /// with different parameter values. The statement is owned by this
+        /// class, and is finalized when the database is closed.
+        /// Returns nullptr if there is an error.
+        sqlite3_stmt *prepareDb(const char *sql)
+            {
+            sqlite3_stmt *stmt = nullptr;
+            int retCode = sqlite3_prepare_v2(mDb, sql, -1, &stmt, nullptr);
+            if(handleRetCode(retCode, sqlite3_errmsg(mDb)))
+                {
+                mStatements.push_back(stmt);
+                }
+            return stmt;
+            }
+        /// Bind an integer to a parameter of a prepared statement. The
+        /// parameter index starts at one.
+        bool bindDbInt(sqlite3_stmt *stmt, int index, int val)
+            {
+            int retCode = sqlite3_bind_int(stmt, index, val);
+            return handleRetCode(retCode, sqlite3_errmsg(mDb));
+            }
+        /// Bind a string to a parameter of a prepared statement. The string
+        /// is not copied, so it must exist until stepDb is called.
+        /// @param val Use nullptr to bind NULL.
+        bool bindDbText(sqlite3_stmt *stmt, int index, char const *val)
+            {
+            int retCode = val ? sqlite3_bind_text(stmt, index, val, -1, SQLITE_STATIC) :
+                sqlite3_bind_null(stmt, index);
+            return handleRetCode(retCode, sqlite3_errmsg(mDb));
+            }
+        /// Execute a prepared statement that does not return results, and
+        /// reset it so that it can be executed again.
+        bool stepDb(sqlite3_stmt *stmt)
+            {
+            int retCode = sqlite3_step(stmt);
+            if(retCode == SQLITE_DONE || retCode == SQLITE_ROW)
+                {
+                retCode = SQLITE_OK;
+                }
+            bool success = handleRetCode(retCode, sqlite3_errmsg(mDb));
+            sqlite3_reset(stmt);
+            return success;
+            }
+        /// Get the row ID of the last record that was inserted.
+        int getDbLastInsertRowId()
+            {
+            return static_cast<int>(sqlite3_last_insert_rowid(mDb));
+            }
         /// This is called from the destructor, so does not need an additional
         /// call unless it must be closed early.
         void closeDb()
             {
             if(mDb)
                 {
+                for(auto const &stmt : mStatements)
+                    {
+                    sqlite3_finalize(stmt);
+                    }
+                mStatements.clear();
                 sqlite3_close(mDb);
                 mDb = nullptr;
                 }
@@ -118,6 +200,7 @@ class SQLite:public SQLiteImporter
     private:
         sqlite3 *mDb;
         SQLiteListener *mListener;
+        std::vector<sqlite3_stmt*> mStatements;
 
         /// This is called from the sqlite3_exec call, and sends the results to
         /// the listener.
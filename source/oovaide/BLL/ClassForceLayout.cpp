@@ -0,0 +1,466 @@
+/*
+ * ClassForceLayout.cpp
+ *
+ *  \copyright 2016 DCBlaha.  Distributed under the GPL.
+ */
+
+#include "ClassForceLayout.h"
+#include <math.h>
+#include <algorithm>
+#include <random>
+
+static const int NumIterations = 150;
+// A cell is approximated as a single node if the cell size divided by the
+// distance to the cell is less than this.
+static const double BarnesHutTheta = 0.8;
+// Keeps nodes that are not connected from moving away from the diagram.
+static const double Gravity = 0.2;
+
+
+int ForceQuadTree::addCell(double centerX, double centerY, double halfSize)
+    {
+    Cell cell;
+    cell.mCenterX = centerX;
+    cell.mCenterY = centerY;
+    cell.mHalfSize = halfSize;
+    cell.mMass = 0;
+    cell.mSumX = 0;
+    cell.mSumY = 0;
+    for(auto &child : cell.mChildren)
+        {
+        child = -1;
+        }
+    cell.mNode = -1;
+    mCells.push_back(cell);
+    return static_cast<int>(mCells.size() - 1);
+    }
+
+int ForceQuadTree::getChild(int cellIndex, double x, double y)
+    {
+    Cell const &cell = mCells[cellIndex];
+    int quadrant = ((x >= cell.mCenterX) ? 1 : 0) + ((y >= cell.mCenterY) ? 2 : 0);
+    int child = cell.mChildren[quadrant];
+    if(child == -1)
+        {
+        double halfSize = cell.mHalfSize / 2;
+        double childX = cell.mCenterX + ((quadrant & 1) ? halfSize : -halfSize);
+        double childY = cell.mCenterY + ((quadrant & 2) ? halfSize : -halfSize);
+        // The cell reference is not valid after a cell is added.
+        child = addCell(childX, childY, halfSize);
+        mCells[cellIndex].mChildren[quadrant] = child;
+        }
+    return child;
+    }
+
+void ForceQuadTree::build(std::vector<double> const &x, std::vector<double> const &y)
+    {
+    mCells.clear();
+    if(x.size() > 0)
+        {
+        double minX = *std::min_element(x.begin(), x.end());
+        double maxX = *std::max_element(x.begin(), x.end());
+        double minY = *std::min_element(y.begin(), y.end());
+        double maxY = *std::max_element(y.begin(), y.end());
+        double halfSize = std::max(std::max(maxX - minX, maxY - minY) / 2, 1.0);
+        addCell((minX + maxX) / 2, (minY + maxY) / 2, halfSize);
+        for(size_t ni=0; ni<x.size(); ni++)
+            {
+            int cellIndex = 0;
+            while(cellIndex != -1)
+                {
+                Cell &cell = mCells[cellIndex];
+                cell.mMass++;
+                cell.mSumX += x[ni];
+                cell.mSumY += y[ni];
+                bool hasChildren = (cell.mChildren[0] != -1 ||
+                    cell.mChildren[1] != -1 || cell.mChildren[2] != -1 ||
+                    cell.mChildren[3] != -1);
+                if(hasChildren)
+                    {
+                    cellIndex = getChild(cellIndex, x[ni], y[ni]);
+                    }
+                else if(cell.mMass == 1)
+                    {
+                    cell.mNode = static_cast<int>(ni);
+                    cellIndex = -1;
+                    }
+                else if(cell.mHalfSize < 0.5 || cell.mNode == -1)
+                    {
+                    // Nodes at almost the same position are kept in one cell.
+                    cell.mNode = -1;
+                    cellIndex = -1;
+                    }
+                else
+                    {
+                    // Move the node in this cell into a child.
+                    int otherNode = cell.mNode;
+                    cell.mNode = -1;
+                    int otherChild = getChild(cellIndex, x[otherNode], y[otherNode]);
+                    Cell &otherCell = mCells[otherChild];
+                    otherCell.mMass = 1;
+                    otherCell.mSumX = x[otherNode];
+                    otherCell.mSumY = y[otherNode];
+                    otherCell.mNode = otherNode;
+                    cellIndex = getChild(cellIndex, x[ni], y[ni]);
+                    }
+                }
+            }
+        }
+    }
+
+void ForceQuadTree::addRepulsion(double x, double y, double idealDistSquared,
+        double &forceX, double &forceY) const
+    {
+    std::vector<int> cellStack;
+    if(mCells.size() > 0)
+        {
+        cellStack.push_back(0);
+        }
+    while(cellStack.size() > 0)
+        {
+        Cell const &cell = mCells[cellStack.back()];
+        cellStack.pop_back();
+        double dx = x - cell.mSumX / cell.mMass;
+        double dy = y - cell.mSumY / cell.mMass;
+        double distSquared = dx * dx + dy * dy;
+        double cellSize = cell.mHalfSize * 2;
+        bool hasChildren = (cell.mChildren[0] != -1 ||
+            cell.mChildren[1] != -1 || cell.mChildren[2] != -1 ||
+            cell.mChildren[3] != -1);
+        if(!hasChildren || cellSize * cellSize <
+            BarnesHutTheta * BarnesHutTheta * distSquared)
+            {
+            // The node does not repel itself, or nodes at the same position.
+            if(distSquared > 0.01)
+                {
+                double force = idealDistSquared * cell.mMass / distSquared;
+                forceX += dx * force;
+                forceY += dy * force;
+                }
+            }
+        else
+            {
+            for(int child : cell.mChildren)
+                {
+                if(child != -1)
+                    {
+                    cellStack.push_back(child);
+                    }
+                }
+            }
+        }
+    }
+
+
+void ClassForceLayout::initialize(std::vector<GraphPoint> const &positions,
+        std::vector<GraphSize> const &sizes, std::vector<bool> const &hasPositions,
+        std::vector<std::pair<int, int>> const &connections, int avgNodeSize)
+    {
+    size_t numNodes = sizes.size();
+    mIdealDist = std::max(static_cast<double>(avgNodeSize), 10.0);
+    mSizes = sizes;
+    mCenterX.clear();
+    mCenterY.clear();
+    size_t numPositioned = static_cast<size_t>(std::count(hasPositions.begin(),
+        hasPositions.end(), true));
+    for(size_t ni=0; ni<numNodes; ni++)
+        {
+        mCenterX.push_back(positions[ni].x + sizes[ni].x / 2.0);
+        mCenterY.push_back(positions[ni].y + sizes[ni].y / 2.0);
+        }
+    mPlaceNewNodesOnly = (numPositioned > 0 && numPositioned < numNodes);
+    mFixed.clear();
+    for(size_t ni=0; ni<numNodes; ni++)
+        {
+        mFixed.push_back(mPlaceNewNodesOnly && hasPositions[ni]);
+        }
+    mConnections.clear();
+    for(auto const &conn : connections)
+        {
+        if(conn.first != conn.second)
+            {
+            mConnections.push_back(conn);
+            }
+        }
+    }
+
+void ClassForceLayout::setStartPositions()
+    {
+    std::default_random_engine generator;
+    std::uniform_real_distribution<double> jitter(-0.25, 0.25);
+    size_t numNodes = mSizes.size();
+    if(mPlaceNewNodesOnly)
+        {
+        // Put new nodes near the nodes they are connected to that have
+        // positions, or to the right of the diagram.
+        double maxX = 0;
+        double minY = 0;
+        bool firstFixed = true;
+        for(size_t ni=0; ni<numNodes; ni++)
+            {
+            if(mFixed[ni])
+                {
+                if(firstFixed || mCenterX[ni] > maxX)
+                    maxX = mCenterX[ni];
+                if(firstFixed || mCenterY[ni] < minY)
+                    minY = mCenterY[ni];
+                firstFixed = false;
+                }
+            }
+        std::vector<bool> placed = mFixed;
+        double nextFreeY = minY;
+        for(size_t ni=0; ni<numNodes; ni++)
+            {
+            if(!placed[ni])
+                {
+                double sumX = 0;
+                double sumY = 0;
+                int numNeighbors = 0;
+                for(auto const &conn : mConnections)
+                    {
+                    int other = -1;
+                    if(conn.first == static_cast<int>(ni))
+                        other = conn.second;
+                    else if(conn.second == static_cast<int>(ni))
+                        other = conn.first;
+                    if(other != -1 && placed[other])
+                        {
+                        sumX += mCenterX[other];
+                        sumY += mCenterY[other];
+                        numNeighbors++;
+                        }
+                    }
+                if(numNeighbors > 0)
+                    {
+                    mCenterX[ni] = sumX / numNeighbors + jitter(generator) * mIdealDist;
+                    mCenterY[ni] = sumY / numNeighbors + jitter(generator) * mIdealDist;
+                    }
+                else
+                    {
+                    mCenterX[ni] = maxX + mIdealDist;
+                    mCenterY[ni] = nextFreeY;
+                    nextFreeY += mIdealDist;
+                    }
+                placed[ni] = true;
+                }
+            }
+        }
+    else
+        {
+        // Start with the nodes in a grid.
+        size_t numColumns = static_cast<size_t>(ceil(sqrt(numNodes)));
+        for(size_t ni=0; ni<numNodes; ni++)
+            {
+            mCenterX[ni] = (ni % numColumns + jitter(generator)) * mIdealDist;
+            mCenterY[ni] = (ni / numColumns + jitter(generator)) * mIdealDist;
+            }
+        }
+    }
+
+void ClassForceLayout::moveNodes(double temperature)
+    {
+    size_t numNodes = mSizes.size();
+    double idealDistSquared = mIdealDist * mIdealDist;
+    std::vector<double> forceX(numNodes);
+    std::vector<double> forceY(numNodes);
+    ForceQuadTree tree;
+    tree.build(mCenterX, mCenterY);
+    double sumX = 0;
+    double sumY = 0;
+    for(size_t ni=0; ni<numNodes; ni++)
+        {
+        sumX += mCenterX[ni];
+        sumY += mCenterY[ni];
+        }
+    double centerX = sumX / numNodes;
+    double centerY = sumY / numNodes;
+    for(size_t ni=0; ni<numNodes; ni++)
+        {
+        if(!mFixed[ni])
+            {
+            tree.addRepulsion(mCenterX[ni], mCenterY[ni], idealDistSquared,
+                forceX[ni], forceY[ni]);
+            forceX[ni] -= (mCenterX[ni] - centerX) * Gravity;
+            forceY[ni] -= (mCenterY[ni] - centerY) * Gravity;
+            }
+        }
+    for(auto const &conn : mConnections)
+        {
+        double dx = mCenterX[conn.second] - mCenterX[conn.first];
+        double dy = mCenterY[conn.second] - mCenterY[conn.first];
+        double dist = sqrt(dx * dx + dy * dy);
+        double force = dist / mIdealDist;
+        forceX[conn.first] += dx * force;
+        forceY[conn.first] += dy * force;
+        forceX[conn.second] -= dx * force;
+        forceY[conn.second] -= dy * force;
+        }
+    for(size_t ni=0; ni<numNodes; ni++)
+        {
+        if(!mFixed[ni])
+            {
+            double force = sqrt(forceX[ni] * forceX[ni] + forceY[ni] * forceY[ni]);
+            if(force > 0)
+                {
+                double dist = std::min(force, temperature);
+                mCenterX[ni] += forceX[ni] / force * dist;
+                mCenterY[ni] += forceY[ni] / force * dist;
+                }
+            }
+        }
+    }
+
+void ClassForceLayout::removeOverlaps()
+    {
+    size_t numNodes = mSizes.size();
+    std::vector<size_t> order(numNodes);
+    bool moved = true;
+    for(int pass=0; pass<200 && moved; pass++)
+        {
+        moved = false;
+        // Sweep and prune using the left edges of the nodes.
+        for(size_t ni=0; ni<numNodes; ni++)
+            {
+            order[ni] = ni;
+            }
+        std::sort(order.begin(), order.end(), [this](size_t n1, size_t n2)
+            {
+            return(mCenterX[n1] - mSizes[n1].x / 2.0 <
+                mCenterX[n2] - mSizes[n2].x / 2.0);
+            });
+        for(size_t i1=0; i1<numNodes; i1++)
+            {
+            size_t n1 = order[i1];
+            for(size_t i2=i1+1; i2<numNodes; i2++)
+                {
+                size_t n2 = order[i2];
+                // The nodes are moved one past touching so that they are
+                // not found to overlap again because of rounding.
+                double overlapX = (mSizes[n1].x + mSizes[n2].x) / 2.0 + 1 -
+                    fabs(mCenterX[n1] - mCenterX[n2]);
+                if(mCenterX[n2] - mSizes[n2].x / 2.0 >=
+                    mCenterX[n1] + mSizes[n1].x / 2.0)
+                    {
+                    break;
+                    }
+                double overlapY = (mSizes[n1].y + mSizes[n2].y) / 2.0 + 1 -
+                    fabs(mCenterY[n1] - mCenterY[n2]);
+                if(overlapX > 0 && overlapY > 0 && !(mFixed[n1] && mFixed[n2]))
+                    {
+                    // Move the nodes apart in the direction that is the
+                    // shortest move.
+                    double share1 = mFixed[n1] ? 0 : (mFixed[n2] ? 1 : 0.5);
+                    double share2 = 1 - share1;
+                    if(overlapX < overlapY)
+                        {
+                        double dir = (mCenterX[n1] < mCenterX[n2] ||
+                            (mCenterX[n1] == mCenterX[n2] && n1 < n2)) ? -1 : 1;
+                        mCenterX[n1] += dir * overlapX * share1;
+                        mCenterX[n2] -= dir * overlapX * share2;
+                        }
+                    else
+                        {
+                        double dir = (mCenterY[n1] < mCenterY[n2] ||
+                            (mCenterY[n1] == mCenterY[n2] && n1 < n2)) ? -1 : 1;
+                        mCenterY[n1] += dir * overlapY * share1;
+                        mCenterY[n2] -= dir * overlapY * share2;
+                        }
+                    moved = true;
+                    }
+                }
+            }
+        }
+    if(moved)
+        {
+        // Put nodes that could not be moved apart below the right side of
+        // the diagram.
+        double right = 0;
+        double bottom = 0;
+        for(size_t ni=0; ni<numNodes; ni++)
+            {
+            right = std::max(right, mCenterX[ni] + mSizes[ni].x / 2.0);
+            bottom = std::max(bottom, mCenterY[ni] + mSizes[ni].y / 2.0);
+            }
+        for(size_t n1=0; n1<numNodes; n1++)
+            {
+            bool overlap = false;
+            for(size_t n2=0; n2<numNodes && !overlap && !mFixed[n1]; n2++)
+                {
+                overlap = (n1 != n2 &&
+                    fabs(mCenterX[n1] - mCenterX[n2]) < (mSizes[n1].x + mSizes[n2].x) / 2.0 &&
+                    fabs(mCenterY[n1] - mCenterY[n2]) < (mSizes[n1].y + mSizes[n2].y) / 2.0);
+                }
+            if(overlap)
+                {
+                mCenterX[n1] = right - mSizes[n1].x / 2.0;
+                mCenterY[n1] = bottom + mSizes[n1].y / 2.0;
+                bottom += mSizes[n1].y;
+                }
+            }
+        }
+    }
+
+GraphPoint ClassForceLayout::getPosition(size_t ni) const
+    {
+    return GraphPoint(static_cast<int>(floor(mCenterX[ni] - mSizes[ni].x / 2.0 + 0.5)),
+        static_cast<int>(floor(mCenterY[ni] - mSizes[ni].y / 2.0 + 0.5)));
+    }
+
+void ClassForceLayout::updatePositions(OovTaskStatusListener *listener,
+        OovTaskContinueListener &contListener)
+    {
+    OovTaskStatusListenerId taskId = 0;
+    if(listener)
+        {
+        taskId = listener->startTask("Positioning nodes.", NumIterations);
+        }
+    setStartPositions();
+    // The temperature limits how far nodes move, and is lowered so that
+    // the positions settle.
+    size_t numMoving = static_cast<size_t>(std::count(mFixed.begin(),
+        mFixed.end(), false));
+    double startTemperature = mIdealDist * std::max(sqrt(numMoving), 1.0);
+    bool keepGoing = true;
+    for(int i=0; i<NumIterations && keepGoing; i++)
+        {
+        moveNodes(startTemperature * (NumIterations - i) / NumIterations);
+        keepGoing = contListener.continueProcessingItem();
+        if(keepGoing && listener && (i % 10) == 0)
+            {
+            keepGoing = listener->updateProgressIteration(taskId, i, nullptr);
+            }
+        }
+    removeOverlaps();
+    if(listener)
+        {
+        listener->endTask(taskId);
+        }
+    }
+
+std::vector<GraphPoint> ClassForceLayout::getPositions() const
+    {
+    // Keep all positions positive. If only new nodes were placed, this only
+    // moves the other nodes if a new node is above or left of the diagram.
+    GraphPoint minPos(0, 0);
+    for(size_t ni=0; ni<mSizes.size(); ni++)
+        {
+        GraphPoint pos = getPosition(ni);
+        if(ni == 0 || pos.x < minPos.x)
+            minPos.x = pos.x;
+        if(ni == 0 || pos.y < minPos.y)
+            minPos.y = pos.y;
+        }
+    if(mPlaceNewNodesOnly)
+        {
+        minPos.x = std::min(minPos.x, 0);
+        minPos.y = std::min(minPos.y, 0);
+        }
+    std::vector<GraphPoint> positions;
+    for(size_t ni=0; ni<mSizes.size(); ni++)
+        {
+        GraphPoint pos = getPosition(ni);
+        pos.sub(minPos);
+        positions.push_back(pos);
+        }
+    return positions;
+    }
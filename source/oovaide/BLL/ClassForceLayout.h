@@ -0,0 +1,105 @@
+/*
+ * ClassForceLayout.h
+ *
+ *  \copyright 2016 DCBlaha.  Distributed under the GPL.
+ */
+
+#ifndef CLASSFORCELAYOUT_H_
+#define CLASSFORCELAYOUT_H_
+
+#include "Graph.h"
+#include "OovProcess.h"
+#include <vector>
+
+/// This is a quadtree of node centers that is used to find the repulsion
+/// between all nodes in about N log N time. Nodes that are far away are
+/// treated as a single node at their center. (Barnes-Hut)
+class ForceQuadTree
+    {
+    public:
+        void build(std::vector<double> const &x, std::vector<double> const &y);
+        /// Add the repulsion from all nodes to a force.
+        /// @param x The position that has the force.
+        /// @param y The position that has the force.
+        /// @param idealDistSquared The square of the distance between nodes
+        ///     where the repulsion and attraction of connected nodes are equal.
+        /// @param forceX The X force to add to.
+        /// @param forceY The Y force to add to.
+        void addRepulsion(double x, double y, double idealDistSquared,
+            double &forceX, double &forceY) const;
+
+    private:
+        struct Cell
+            {
+            double mCenterX;
+            double mCenterY;
+            double mHalfSize;
+            double mMass;
+            double mSumX;
+            double mSumY;
+            int mChildren[4];
+            /// The node that is in a cell that does not have children.
+            int mNode;
+            };
+        std::vector<Cell> mCells;
+
+        int addCell(double centerX, double centerY, double halfSize);
+        int getChild(int cellIndex, double x, double y);
+    };
+
+/// This uses a force directed layout (Fruchterman-Reingold) to place the
+/// nodes of the class diagram. Connected nodes attract each other, and all
+/// nodes repel each other. This is much faster than the genetic algorithm
+/// for large diagrams.
+///
+/// Nodes that already have positions are not moved if any nodes do not have
+/// positions, so that adding classes to a diagram only places the new
+/// classes.
+///
+/// This only uses the rectangles and connections of the nodes, so that it
+/// does not depend on the class graph.
+class ClassForceLayout
+    {
+    public:
+        /// Set up the nodes for the layout.
+        /// @param positions The top left of each node.
+        /// @param sizes The size of each node, including padding.
+        /// @param hasPositions Set for the nodes that were already positioned.
+        /// @param connections The indices of nodes that are connected.
+        /// @param avgNodeSize The average size of the nodes.
+        void initialize(std::vector<GraphPoint> const &positions,
+                std::vector<GraphSize> const &sizes,
+                std::vector<bool> const &hasPositions,
+                std::vector<std::pair<int, int>> const &connections,
+                int avgNodeSize);
+        /// Do some iterations. The positions are then available from
+        /// getPositions.
+        void updatePositions(OovTaskStatusListener *listener,
+                OovTaskContinueListener &contListener);
+        /// Get the top left of each node. The positions are moved so that
+        /// none are negative.
+        std::vector<GraphPoint> getPositions() const;
+
+    private:
+        /// The centers of the nodes.
+        std::vector<double> mCenterX;
+        std::vector<double> mCenterY;
+        /// The sizes of the nodes, including padding.
+        std::vector<GraphSize> mSizes;
+        std::vector<bool> mFixed;
+        std::vector<std::pair<int, int>> mConnections;
+        double mIdealDist;
+        bool mPlaceNewNodesOnly;
+
+        /// Set the starting positions of the nodes that are not fixed.
+        void setStartPositions();
+        /// Move the nodes that are not fixed by the forces.
+        /// @param temperature The maximum distance to move a node.
+        void moveNodes(double temperature);
+        /// Move nodes that are not fixed so the rectangles do not overlap.
+        void removeOverlaps();
+        /// Get the position of a node from the center.
+        GraphPoint getPosition(size_t ni) const;
+    };
+
+#endif
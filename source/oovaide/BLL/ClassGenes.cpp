@@ -8,6 +8,7 @@
 #include "ClassGenes.h"
 #include "ClassGraph.h"
 #include <stdlib.h>     // For abs
+#include <algorithm>
 #include "Debug.h"
 #include "Gui.h"
 
@@ -35,6 +36,18 @@ void ClassGenes::initialize(const ClassGraph &graph, int avgNodeSize)
     int geneBytes = numNodes * sizePos * numPos;
     int maxPos = static_cast<int>(sqrt(numNodes) * (avgNodeSize* 1.5));
     GenePool::initialize(geneBytes, numGenes, 0.35, 0.005, 0, maxPos);
+
+    mNodeSizes.clear();
+    for(int ni=0; ni<numNodes; ni++)
+        {
+        mNodeSizes.push_back(graph.getNodeSizeWithPadding(ni));
+        }
+    mConnections.clear();
+    for(auto const &nodePair : graph.getConnections())
+        {
+        mConnections.push_back(std::make_pair(nodePair.first.n1,
+            nodePair.first.n2));
+        }
     }
 
 #define LINES_OVERLAP 1
@@ -77,24 +90,49 @@ bool linesOverlap(DiagramLine a, DiagramLine b)
     return false;
     }
 
-void ClassGenes::getLineForNodes(int geneIndex, int node1, int node2, DiagramLine &line) const
+bool ClassGenes::lineNodeOverlap(GeneNodeRects const &rects, int ni,
+        DiagramLine const &line)
     {
-    GraphRect r1;
-    GraphRect r2;
-    getNodeRect(geneIndex, node1, r1);
-    getNodeRect(geneIndex, node2, r2);
-    DiagramLine l(r1.centerx(), r1.centery(), r2.centerx(), r2.centery());
-    line = l;
+    int startx = rects.mStartX[ni];
+    int starty = rects.mStartY[ni];
+    int endx = rects.mEndX[ni];
+    int endy = rects.mEndY[ni];
+    return linesOverlap(DiagramLine(startx, starty, endx, starty), line) ||
+        linesOverlap(DiagramLine(endx, starty, endx, endy), line) ||
+        linesOverlap(DiagramLine(endx, endy, startx, endy), line) ||
+        linesOverlap(DiagramLine(startx, endy, startx, starty), line);
     }
 
-bool ClassGenes::lineNodeOverlap(int geneIndex, int ni, DiagramLine const &line) const
+int ClassGenes::getLineNodesOverlapCount(GeneNodeRects const &rects) const
     {
-    GraphRect rect;
-    getNodeRect(geneIndex, ni, rect);
-    return linesOverlap(DiagramLine(rect.start.x, rect.start.y, rect.endx(), rect.start.y), line) ||
-        linesOverlap(DiagramLine(rect.endx(), rect.start.y, rect.endx(), rect.endy()), line) ||
-        linesOverlap(DiagramLine(rect.endx(), rect.endy(), rect.start.x, rect.endy()), line) ||
-        linesOverlap(DiagramLine(rect.start.x, rect.endy(), rect.start.x, rect.start.y), line);
+    int lineNodeOverlapCount = 0;
+    int numNodes = static_cast<int>(rects.size());
+    for(auto const &conn : mConnections)
+        {
+        int n1 = conn.first;
+        int n2 = conn.second;
+        DiagramLine line(
+            rects.mStartX[n1] + (rects.mEndX[n1] - rects.mStartX[n1]) / 2,
+            rects.mStartY[n1] + (rects.mEndY[n1] - rects.mStartY[n1]) / 2,
+            rects.mStartX[n2] + (rects.mEndX[n2] - rects.mStartX[n2]) / 2,
+            rects.mStartY[n2] + (rects.mEndY[n2] - rects.mStartY[n2]) / 2);
+        int minx = std::min(line.s.x, line.e.x);
+        int maxx = std::max(line.s.x, line.e.x);
+        int miny = std::min(line.s.y, line.e.y);
+        int maxy = std::max(line.s.y, line.e.y);
+        for(int ni=0; ni<numNodes; ni++)
+            {
+            // The line can only touch an edge of the node if the line is
+            // within the rectangle of the node.
+            if(rects.mEndX[ni] >= minx && rects.mStartX[ni] <= maxx &&
+                rects.mEndY[ni] >= miny && rects.mStartY[ni] <= maxy &&
+                lineNodeOverlap(rects, ni, line))
+                {
+                lineNodeOverlapCount++;
+                }
+            }
+        }
+    return lineNodeOverlapCount;
     }
 
 #else
@@ -125,9 +163,11 @@ void ClassGenes::setupQualityEachGeneration()
     {
     // Go through all genes and find largest size to use to scale size quality
     mDiagramSize.clear();
+    GeneNodeRects rects;
     for(size_t gi=0; gi<numgenes; gi++)
         {
-        GraphSize size = getSize(gi);
+        getNodeRects(gi, rects);
+        GraphSize size = getSize(rects);
         if(size.x > mDiagramSize.x)
             mDiagramSize.x = size.x;
         if(size.y > mDiagramSize.y)
@@ -135,56 +175,39 @@ void ClassGenes::setupQualityEachGeneration()
         }
     }
 
-GraphSize ClassGenes::getSize(int geneIndex) const
+GraphSize ClassGenes::getSize(GeneNodeRects const &rects)
     {
     GraphSize size;
-    for(size_t ni=0; ni<mGraph->getNodes().size(); ni++)
+    for(size_t ni=0; ni<rects.size(); ni++)
         {
-        GraphRect rect;
-        getNodeRect(geneIndex, ni, rect);
-        if(rect.endx() > size.x)
-            size.x = rect.endx();
-        if(rect.endy() > size.y)
-            size.y = rect.endy();
+        if(rects.mEndX[ni] > size.x)
+            size.x = rects.mEndX[ni];
+        if(rects.mEndY[ni] > size.y)
+            size.y = rects.mEndY[ni];
         }
     return size;
     }
 
 QualityType ClassGenes::calculateSingleGeneQuality(size_t geneIndex) const
     {
-    int nodesOverlapCount = 0;
+    GeneNodeRects rects;
+    getNodeRects(geneIndex, rects);
+    int numNodes = static_cast<int>(rects.size());
+    int nodesOverlapCount = getNodesOverlapCount(rects);
 #if(LINES_OVERLAP)
-    int lineNodeOverlapCount = 0;
+    int lineNodeOverlapCount = getLineNodesOverlapCount(rects);
 #else
     int distCount = 0;
-#endif
-    int numNodes = mGraph->getNodes().size();
     for(int ni1=0; ni1<numNodes; ni1++)
         {
         for(int ni2=ni1+1; ni2<numNodes; ni2++)
             {
-            if(nodesOverlap(geneIndex, ni1, ni2))
-                nodesOverlapCount++;
-#if(LINES_OVERLAP)
-#else
             if(isDistanceGoodQuality(geneIndex, ni1, ni2))
                 distCount++;
-#endif
-            }
-        }
-#if(LINES_OVERLAP)
-    int numConnections = mGraph->getConnections().size();
-    for(auto const &nodePair : mGraph->getConnections())
-        {
-        DiagramLine line;
-        getLineForNodes(geneIndex, nodePair.first.n1, nodePair.first.n2, line);
-        for(int ni=0; ni<numNodes; ni++)
-            {
-            if(lineNodeOverlap(geneIndex, ni, line))
-                lineNodeOverlapCount++;
             }
         }
 #endif
+    int numConnections = static_cast<int>(mConnections.size());
     int totalNodesQ = (numNodes * (numNodes-1)) / 2;
     QualityType nodesQ = totalNodesQ - nodesOverlapCount;
 
@@ -194,7 +217,7 @@ QualityType ClassGenes::calculateSingleGeneQuality(size_t geneIndex) const
 #else
     QualityType lineQ = distCount;
 #endif
-    GraphSize geneSize = getSize(geneIndex);
+    GraphSize geneSize = getSize(rects);
     QualityType sizeQ = 0;
     if(geneSize.x + geneSize.y > 0)
         {
@@ -223,24 +246,65 @@ QualityType ClassGenes::calculateSingleGeneQuality(size_t geneIndex) const
 // - The right edge of B is to the right of left edge of R.
 // - The bottom edge of B is below the R upper edge.
 //Then we can say that rectangles are overlapping.
-bool ClassGenes::nodesOverlap(int geneIndex, int node1, int node2) const
+int ClassGenes::getNodesOverlapCount(GeneNodeRects const &rects)
     {
-    GraphRect rect1;
-    getNodeRect(geneIndex, node1, rect1);
-    GraphRect rect2;
-    getNodeRect(geneIndex, node2, rect2);
-    bool overlap = ((rect1.endx() >= rect2.start.x) &&
-            (rect1.endy() >= rect2.start.y) &&
-            (rect1.start.x <= rect2.endx()) &&
-            (rect1.start.y <= rect2.endy()));
-    return overlap;
+    size_t numNodes = rects.size();
+    std::vector<int> order(numNodes);
+    for(size_t ni=0; ni<numNodes; ni++)
+        {
+        order[ni] = static_cast<int>(ni);
+        }
+    std::sort(order.begin(), order.end(), [&rects](int n1, int n2)
+        { return rects.mStartX[n1] < rects.mStartX[n2]; });
+    GeneNodeRects sorted;
+    sorted.resize(numNodes);
+    for(size_t i=0; i<numNodes; i++)
+        {
+        int ni = order[i];
+        sorted.mStartX[i] = rects.mStartX[ni];
+        sorted.mStartY[i] = rects.mStartY[ni];
+        sorted.mEndX[i] = rects.mEndX[ni];
+        sorted.mEndY[i] = rects.mEndY[ni];
+        }
+    int nodesOverlapCount = 0;
+    for(size_t i1=0; i1<numNodes; i1++)
+        {
+        // The nodes after this node start at or after the left edge of
+        // this node, so only the nodes that start before the right edge
+        // of this node can overlap in the X direction.
+        size_t endI2 = static_cast<size_t>(std::upper_bound(
+            sorted.mStartX.begin() + i1 + 1, sorted.mStartX.end(),
+            sorted.mEndX[i1]) - sorted.mStartX.begin());
+        int starty = sorted.mStartY[i1];
+        int endy = sorted.mEndY[i1];
+        for(size_t i2=i1+1; i2<endI2; i2++)
+            {
+            nodesOverlapCount += (endy >= sorted.mStartY[i2] &&
+                starty <= sorted.mEndY[i2]);
+            }
+        }
+    return nodesOverlapCount;
+    }
+
+void ClassGenes::getNodeRects(int geneIndex, GeneNodeRects &rects) const
+    {
+    rects.resize(mNodeSizes.size());
+    for(size_t ni=0; ni<mNodeSizes.size(); ni++)
+        {
+        GraphPoint pos;
+        getPosition(geneIndex, ni, pos);
+        rects.mStartX[ni] = pos.x;
+        rects.mStartY[ni] = pos.y;
+        rects.mEndX[ni] = pos.x + mNodeSizes[ni].x;
+        rects.mEndY[ni] = pos.y + mNodeSizes[ni].y;
+        }
     }
 
 void ClassGenes::getNodeRect(int geneIndex, int nodeIndex,
         GraphRect &rect) const
     {
     // Get the size from the node, and the position from the gene pool.
-    rect.size = mGraph->getNodeSizeWithPadding(nodeIndex);
+    rect.size = mNodeSizes[nodeIndex];
     getPosition(geneIndex, nodeIndex, rect.start);
     }
 
@@ -258,6 +322,7 @@ void ClassGenes::updatePositionsInGraph(class ClassGraph &graph,
         {
         taskId = listener->startTask("Optimizing layout.", NumGenerations);
         }
+    startQualityThreads();
     for(int i=0; i<NumGenerations && contListener.continueProcessingItem(); i++)
         {
         singleGeneration();
@@ -266,6 +331,7 @@ void ClassGenes::updatePositionsInGraph(class ClassGraph &graph,
             break;
             }
         }
+    stopQualityThreads();
     int bestGeneI = getBestGeneIndex();
 #if(DEBUG_GENES)
     sDisplayGene = true;
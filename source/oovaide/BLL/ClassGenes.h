@@ -26,6 +26,25 @@ struct DiagramLine
     };
 
 
+/// The rectangles of the nodes for one gene. The values are kept in separate
+/// arrays so that the comparisons between many nodes can be vectorized.
+struct GeneNodeRects
+    {
+    void resize(size_t numNodes)
+        {
+        mStartX.resize(numNodes);
+        mStartY.resize(numNodes);
+        mEndX.resize(numNodes);
+        mEndY.resize(numNodes);
+        }
+    size_t size() const
+        { return mStartX.size(); }
+    std::vector<int> mStartX;
+    std::vector<int> mStartY;
+    std::vector<int> mEndX;
+    std::vector<int> mEndY;
+    };
+
 /// This defines functionality to use a genetic algorithm used to layout the
 /// class positions for the class diagram. Since the objects are all different
 /// sizes, the genetic algorithm will place the objects so that they do not
@@ -41,17 +60,25 @@ class ClassGenes:public GenePool
     private:
         const class ClassGraph *mGraph;
         GraphSize mDiagramSize;
+        // The node sizes and connections do not change while the layout is
+        // optimized, so they are only read once from the graph.
+        std::vector<GraphSize> mNodeSizes;
+        std::vector<std::pair<int, int>> mConnections;
 
         virtual void setupQualityEachGeneration() override;
         virtual QualityType calculateSingleGeneQuality(size_t geneIndex) const override;
         // GeneIndex contains the positions
-        bool nodesOverlap(int geneIndex, int node1, int node2) const;
-        bool lineNodeOverlap(int geneIndex, int ni, DiagramLine const &line) const;
-        void getLineForNodes(int geneIndex, int node1, int node2, DiagramLine &line) const;
+        void getNodeRects(int geneIndex, GeneNodeRects &rects) const;
+        /// Uses sweep and prune to only compare nodes that overlap in the
+        /// X direction.
+        static int getNodesOverlapCount(GeneNodeRects const &rects);
+        int getLineNodesOverlapCount(GeneNodeRects const &rects) const;
+        static bool lineNodeOverlap(GeneNodeRects const &rects, int ni,
+            DiagramLine const &line);
         void getNodeRect(int geneIndex, int nodeIndex, class GraphRect &rect) const;
         void getPosition(int geneIndex, int nodeIndex, class GraphPoint &pos) const;
         bool isDistanceGoodQuality(int geneIndex, int ni1, int ni2) const;
-        GraphSize getSize(int geneIndex) const;
+        static GraphSize getSize(GeneNodeRects const &rects);
     };
 
 #endif
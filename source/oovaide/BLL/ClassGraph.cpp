@@ -11,6 +11,9 @@
 #include "Debug.h"
 #include <algorithm>
 
+// The genetic algorithm gets slow for more nodes than this.
+static const size_t MaxGeneLayoutNodes = 100;
+
 #define DEBUG_ADD 0
 #if(DEBUG_ADD)
     static DebugFile sLog("DebugClassAddNode.txt");
@@ -76,8 +79,19 @@ void ClassGraph::updateGenes(const ModelData &modelData,
     updateConnections(modelData);
     if(mNodes.size() > 1)
         {
-        mGenes.initialize(*this, getAvgNodeSize());
-        mGenes.updatePositionsInGraph(*this, mBackgroundTaskStatusListener, *this);
+        size_t numPositioned = static_cast<size_t>(std::count_if(mNodes.begin(),
+            mNodes.end(), [](ClassNode const &node)
+            { return node.hasPosition(); }));
+        bool placeNewNodes = (numPositioned > 0 && numPositioned < mNodes.size());
+        if(placeNewNodes || mNodes.size() > MaxGeneLayoutNodes)
+            {
+            updateForceLayout();
+            }
+        else
+            {
+            mGenes.initialize(*this, getAvgNodeSize());
+            mGenes.updatePositionsInGraph(*this, mBackgroundTaskStatusListener, *this);
+            }
         }
     else
         {
@@ -85,6 +99,33 @@ void ClassGraph::updateGenes(const ModelData &modelData,
         }
     }
 
+void ClassGraph::updateForceLayout()
+    {
+    std::vector<GraphPoint> positions;
+    std::vector<GraphSize> sizes;
+    std::vector<bool> hasPositions;
+    for(size_t ni=0; ni<mNodes.size(); ni++)
+        {
+        positions.push_back(mNodes[ni].getPosition());
+        sizes.push_back(getNodeSizeWithPadding(static_cast<int>(ni)));
+        hasPositions.push_back(mNodes[ni].hasPosition());
+        }
+    std::vector<std::pair<int, int>> connections;
+    for(auto const &nodePair : mConnectMap)
+        {
+        connections.push_back(std::make_pair(nodePair.first.n1,
+            nodePair.first.n2));
+        }
+    mForceLayout.initialize(positions, sizes, hasPositions, connections,
+        getAvgNodeSize());
+    mForceLayout.updatePositions(mBackgroundTaskStatusListener, *this);
+    positions = mForceLayout.getPositions();
+    for(size_t ni=0; ni<mNodes.size(); ni++)
+        {
+        mNodes[ni].setPosition(positions[ni]);
+        }
+    }
+
 size_t ClassGraph::getNodeIndex(const ModelType *type) const
     {
     size_t nodeIndex = NO_INDEX;
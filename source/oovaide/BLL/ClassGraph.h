@@ -10,6 +10,7 @@
 
 #include "ModelObjects.h"
 #include "ClassGenes.h"
+#include "ClassForceLayout.h"
 #include "DiagramDrawer.h"
 #include "OovThreadedBackgroundQueue.h"
 #include <map>
@@ -58,7 +59,7 @@ class ClassNode
     public:
         // @param type Is null for relation key.
         ClassNode(const ModelType *type, const ClassNodeDrawOptions &options):
-            mType(type),  mNodeOptions(options)
+            mType(type),  mNodeOptions(options), mHasPosition(false)
             {}
         bool isKey() const
             { return(mType == nullptr);}
@@ -68,9 +69,16 @@ class ClassNode
         GraphSize getSize() const
             { return rect.size; }
         void setPosition(const GraphPoint &pos)
-            { rect.start = pos; }
+            {
+            rect.start = pos;
+            mHasPosition = true;
+            }
         GraphPoint getPosition() const
             { return rect.start; }
+        /// Returns false if the node was added, and has not been positioned
+        /// by a layout, loaded or moved.
+        bool hasPosition() const
+            { return mHasPosition; }
         void setSize(GraphSize &size)
             { rect.size = size; }
         GraphRect const &getRect() const
@@ -84,6 +92,7 @@ class ClassNode
         const ModelType *mType;
         GraphRect rect;
         ClassNodeDrawOptions mNodeOptions;
+        bool mHasPosition;
     };
 
 struct nodePair
@@ -269,6 +278,7 @@ class ClassGraph:public ThreadedWorkBackgroundQueue<ClassGraph, ClassGraphBackgr
         std::vector<ClassNode> mNodes;
         std::map<nodePair_t, ClassConnectItem> mConnectMap;
         ClassGenes mGenes;
+        ClassForceLayout mForceLayout;
         GraphSize mPad;
         bool mModified;
         int mBackgroundTaskLevel;
@@ -282,10 +292,13 @@ class ClassGraph:public ThreadedWorkBackgroundQueue<ClassGraph, ClassGraphBackgr
 
         void removeNode(const ClassNode &node);
 
-        /// This updates quality information, runs the genetic algorithm for
-        /// placing the nodes, and then draws them.
+        /// This updates quality information, runs the genetic algorithm or
+        /// the force directed layout for placing the nodes, and then draws
+        /// them. The force directed layout is used for large graphs, and to
+        /// place new nodes without moving the nodes that have positions.
         void updateGenes(const ModelData &modelData,
             DiagramDrawer &nullDrawer);
+        void updateForceLayout();
 
         /// Update connections between nodes.
         void updateConnections(const ModelData &modelData);
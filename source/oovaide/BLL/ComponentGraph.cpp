@@ -8,6 +8,7 @@
 #include "Project.h"
 #include "BuildConfigReader.h"
 #include "IncludeMap.h"
+#include "GraphReachability.h"
 #include <algorithm>
 
 void ComponentGraph::updateGraph(const ComponentDrawOptions &options)
@@ -145,54 +146,30 @@ fflush(stdout);
         pruneConnections();
     }
 
-void ComponentGraph::findNumPaths(size_t consumerIndex, size_t supplierIndex,
-    size_t &numPaths)
+// A connection is implied if the supplier can also be reached through some
+// other component. This is done for all connections at once instead of
+// counting paths for each connection, since counting paths takes exponential
+// time for large projects, and never ends if there are cycles.
+void ComponentGraph::pruneConnections()
     {
+    std::vector<GraphEdge> edges;
+    edges.reserve(mConnections.size());
     for(auto const &connection : mConnections)
         {
-        if(connection.mNodeConsumer == consumerIndex)
-            {
-            if(connection.mNodeSupplier == supplierIndex)
-                {
-                numPaths++;
-                }
-            else
-                findNumPaths(connection.mNodeSupplier, supplierIndex, numPaths);
-            }
+        edges.push_back(GraphEdge(connection.mNodeConsumer, connection.mNodeSupplier));
         }
-    }
-
-void ComponentGraph::pruneConnections()
-    {
+    GraphReachability reach;
+    reach.build(mNodes.size(), edges);
     for(auto & constConn : mConnections)
         {
         // The begin() iterator is const only in the <set> header file. Since
         // the set sorting is not dependent on the mImpliedDependency, this code is ok.
         ComponentConnection &connection = const_cast<ComponentConnection &>(constConn);
-        size_t numPaths = 0;
-        findNumPaths(connection.mNodeConsumer, connection.mNodeSupplier, numPaths);
-        if(numPaths > 1)
+        if(reach.isImpliedEdge(connection.mNodeConsumer, connection.mNodeSupplier))
             {
             connection.setImpliedDependency(true);
             }
         }
-    /*
-    std::set<ComponentConnection>::iterator iter = mConnections.begin();
-    while(iter != mConnections.end())
-        {
-        ComponentConnection const &connection = *iter;
-        int numPaths = 0;
-        findNumPaths(connection.mNodeConsumer, connection.mNodeSupplier, numPaths);
-        if(numPaths > 1)
-            {
-            mConnections.erase(iter++);
-            }
-        else
-            {
-            iter++;
-            }
-        }
-*/
     }
 
 size_t ComponentGraph::getComponentIndex(OovStringVec const &compPaths,
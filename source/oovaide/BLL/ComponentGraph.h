@@ -124,7 +124,6 @@ class ComponentGraph
         size_t getComponentIndex(OovStringVec const &compPaths,
                 OovStringRef const dir);
         void pruneConnections();
-        void findNumPaths(size_t consumerIndex, size_t supplierIndex, size_t &numPaths);
     };
 
 
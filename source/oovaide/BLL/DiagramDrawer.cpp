@@ -354,10 +354,12 @@ size_t DiagramDependencyGenes::getMaxNodesInColumn() const
 
 void DiagramDependencyGenes::updatePositionsInDrawer()
     {
+    startQualityThreads();
     for(int i=0; i<NumGenerations; i++)
         {
         singleGeneration();
         }
+    stopQualityThreads();
     size_t bestGeneI = getBestGeneIndex();
 //printf("Best %d\n", bestGeneI);
 //fflush(stdout);
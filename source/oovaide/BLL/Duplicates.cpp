@@ -7,116 +7,92 @@
 #include "DirList.h"
 #include "Duplicates.h"
 #include "OovError.h"
-#include <memory.h>
+#include "OovThreadedWaitQueue.h"
+#include <algorithm>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>     // For strtoul
+#include <ctype.h>
 
-
-/// This prevents output of duplicate comparisons. For example:
-/// File1         File2
-/// ..ABCD...    ..........ABCD...BCE.
-/// HashIndices
-///              ..........2345...34..
-///
-/// The comparison should not output: ABCD, BCD, CD, D,    BC, C
-class FilterOutputHashIndices
-    {
-    public:
-        void init(size_t size);
-        void markAlreadyOutput(size_t startIndexFile1, size_t len,
-            size_t startIndexFile2);
-        bool isAlreadyOutput(size_t startIndexFile1, size_t startIndexFile2);
-
-    private:
-        std::vector<size_t> mFile2HashIndices;
-    };
-
-class HashItem
-    {
-    public:
-        HashItem():
-            mHash(0), mLineNum(0)
-            {}
-    size_t mHash;
-    size_t mLineNum;
-    };
+// Each place is only compared with this many of the following places that
+// have the same hash sequence. Repetitive code such as tables can have
+// thousands of places with the same sequence, and comparing all of them
+// would take time and find runs proportional to the square of the places.
+static const size_t MaxSamePlaceCompares = 8;
+// The places that have the same hash sequence are sorted by at most this
+// many of the following hash items.
+static const size_t MaxSortCompareLen = 256;
 
 class HashFile
     {
     public:
+        /// Reads a binary hash file, or an older text hash file.
         bool readHashFile(OovStringRef filePath);
-        void compareHashFiles(HashFile const &refFile,
-            FilterOutputHashIndices &outHashIndices,
-            DuplicateOptions const &options, std::vector<DuplicateLineInfo> &mDupLineInfo);
+        std::vector<uint64_t> const &getHashes() const
+            { return mHashes; }
+        std::vector<uint32_t> const &getLineNums() const
+            { return mLineNums; }
+        OovString getRelativeFileName() const;
 
     private:
         OovString mFilePath;
-        std::vector<HashItem> mHashItems;
+        // The hashes are kept separate from the line numbers so that more
+        // hashes fit in the cache when they are compared.
+        std::vector<uint64_t> mHashes;
+        /// A line number of zero is a break between functions.
+        std::vector<uint32_t> mLineNums;
 
-        /// Returns the number of hash lines that match.
-        size_t getDupLinesLength(size_t thisStartIndex, HashFile const &refFile,
-            size_t refFileStartIndex);
+        bool readBinaryHashes(unsigned char const *data, size_t size);
+        bool readTextHashes(char const *data, size_t size);
         OovString getActualFileName() const;
-        OovString getRelativeFileName() const;
     };
 
-
-void FilterOutputHashIndices::init(size_t size)
+/// Reads the hash files using multiple threads. Each file is read into a
+/// separate HashFile, so the threads do not share any data.
+class HashFilesLoader:public ThreadedWorkWaitQueue<size_t, HashFilesLoader>
     {
-    if(size > mFile2HashIndices.size())
-        {
-        mFile2HashIndices.resize(size);
-        }
-    memset(&mFile2HashIndices[0], 0, size);
-    }
+    public:
+        HashFilesLoader(std::vector<std::string> const &filePaths,
+                std::vector<HashFile> &hashFiles):
+            mFilePaths(filePaths), mHashFiles(hashFiles)
+            {}
+        /// This waits until all files are read.
+        void loadFiles();
 
-void FilterOutputHashIndices::markAlreadyOutput(
-        size_t startIndexFile1, size_t len,
-    size_t startIndexFile2)
-    {
-    for(size_t i=0; i<len; i++)
-        {
-        mFile2HashIndices[startIndexFile2+i] = startIndexFile1+i;
-        }
-    }
+        /// Called by ThreadedWorkWaitQueue
+        bool processItem(size_t const &fileIndex)
+            {
+            mHashFiles[fileIndex].readHashFile(mFilePaths[fileIndex]);
+            return true;
+            }
 
-bool FilterOutputHashIndices::isAlreadyOutput(size_t startIndexFile1, size_t startIndexFile2)
-    {
-    return(mFile2HashIndices[startIndexFile2] == startIndexFile1);
-    }
+    private:
+        std::vector<std::string> const &mFilePaths;
+        std::vector<HashFile> &mHashFiles;
+    };
 
 
 bool HashFile::readHashFile(OovStringRef const filePath)
     {
     mFilePath = filePath;
-    File file;
-    OovStatus status = file.open(filePath.getStr(), "r");
-    if(status.ok())
+    MappedFile file;
+    bool success = file.open(filePath);
+    if(success)
         {
-        char buf[60];
-        while(file.getString(buf, sizeof(buf), status))
+        unsigned char const *data = file.getData();
+        size_t size = file.getSize();
+        if(size >= DupsHashFileIdSize &&
+                memcmp(data, DupsHashFileId, DupsHashFileIdSize) == 0)
             {
-            HashItem item;
-            if(strlen(buf) > 0)
-                {
-                int iHash;
-                int iLineNum;
-                char dummyC;
-                int matchCount = sscanf(buf, "%x %u %c", &iHash, &iLineNum, &dummyC);
-                if(matchCount == 2)
-                    {
-                    item.mHash = iHash;
-                    item.mLineNum = iLineNum;
-                    }
-                else if(matchCount > 0)        // Allow empty whitespace.
-                    {
-                    status.set(false, SC_Logic);
-                    break;
-                    }
-                }
-            /// @todo - This could be more efficient if we knew the
-            /// file size.
-            mHashItems.push_back(item);
+            success = readBinaryHashes(data + DupsHashFileIdSize,
+                size - DupsHashFileIdSize);
+            }
+        else
+            {
+            success = readTextHashes(reinterpret_cast<char const *>(data), size);
             }
         }
+    OovStatus status(success, SC_File);
     if(status.needReport())
         {
         OovString str = "Unable to read hash file: ";
@@ -126,75 +102,80 @@ bool HashFile::readHashFile(OovStringRef const filePath)
     return(status.ok());
     }
 
-void HashFile::compareHashFiles(HashFile const &refFile,
-    FilterOutputHashIndices &outHashIndices, DuplicateOptions const &options,
-    std::vector<DuplicateLineInfo> &mDupLineInfo)
+bool HashFile::readBinaryHashes(unsigned char const *data, size_t size)
     {
-//    fprintf(outFile.getFp(), "Compare %s\n   %s\n", mFilePath.getStr(),
-//          refFile.mFilePath.getStr());
-    outHashIndices.init(refFile.mHashItems.size());
-    for(size_t i1=0; i1<mHashItems.size(); i1++)
+    size_t const headerSize = 2 * sizeof(uint32_t);
+    bool success = (size >= headerSize);
+    if(success)
         {
-        size_t i2=i1;
-        while(i2<refFile.mHashItems.size())
+        uint32_t numItems;
+        memcpy(&numItems, data, sizeof(numItems));
+        size_t hashesSize = numItems * sizeof(uint64_t);
+        size_t lineNumsSize = numItems * sizeof(uint32_t);
+        success = (size == headerSize + hashesSize + lineNumsSize);
+        if(success)
             {
-            size_t inc=1;
-            bool samePlace = false;
-            if(options.mFindDupsInLines)
-                samePlace = ((this == &refFile) && (i1 == i2));
-            else
-                samePlace = ((this == &refFile) && mHashItems[i1].mLineNum == mHashItems[i2].mLineNum);
-            if(!samePlace)
+            mHashes.resize(numItems);
+            mLineNums.resize(numItems);
+            if(numItems > 0)
                 {
-                inc = getDupLinesLength(i1, refFile, i2);
-                if(inc > options.mNumTokenMatches)
-                    {
-                    if(!outHashIndices.isAlreadyOutput(i1, i2))
-                        {
-                        outHashIndices.markAlreadyOutput(i1, inc, i2);
-                        size_t totalLines = (mHashItems[i1+inc-1].mLineNum - mHashItems[i1].mLineNum) + 1;
-                        DuplicateLineInfo info;
-                        info.mTotalDupLines = static_cast<int>(totalLines);
-                        info.mFile1 = getRelativeFileName().getStr();
-                        info.mFile1StartLine = static_cast<int>(mHashItems[i1].mLineNum);
-                        info.mFile2 = refFile.getRelativeFileName().getStr();
-                        info.mFile2StartLine = static_cast<int>(refFile.mHashItems[i2].mLineNum);
-                        mDupLineInfo.push_back(info);
-                        }
-                    }
-                else
-                    inc = 1;
+                memcpy(&mHashes[0], data + headerSize, hashesSize);
+                memcpy(&mLineNums[0], data + headerSize + hashesSize,
+                    lineNumsSize);
                 }
-
-            i2 += inc;
             }
         }
+    return success;
     }
 
-size_t HashFile::getDupLinesLength(size_t thisStartIndex, HashFile const &refFile,
-    size_t refFileStartIndex)
+bool HashFile::readTextHashes(char const *data, size_t size)
     {
-    size_t matchLen = 0;
-    while(mHashItems[thisStartIndex].mHash == refFile.mHashItems[refFileStartIndex].mHash)
+    bool success = true;
+    // The lines are copied so that they are null terminated.
+    OovString line;
+    size_t pos = 0;
+    while(pos < size && success)
         {
-        if(mHashItems[thisStartIndex].mLineNum == 0 ||
-                refFile.mHashItems[refFileStartIndex].mLineNum == 0)
-            {
-            break;
-            }
-        if(thisStartIndex < mHashItems.size() &&
-                refFileStartIndex < refFile.mHashItems.size())
-            {
-            matchLen++;
-            thisStartIndex++;
-            refFileStartIndex++;
-            }
-        else
+        char const *lineStart = data + pos;
+        char const *lineEnd = static_cast<char const *>(
+            memchr(lineStart, '\n', size - pos));
+        size_t lineLen = lineEnd ? static_cast<size_t>(lineEnd - lineStart) :
+            size - pos;
+        line.assign(lineStart, lineLen);
+        pos += lineLen + 1;
+
+        uint64_t hash = 0;
+        uint32_t lineNum = 0;
+        char const *str = line.getStr();
+        char *end;
+        unsigned long val = strtoul(str, &end, 16);
+        // A line without a hash is a break.
+        if(end != str)
             {
-            break;
+            hash = static_cast<uint32_t>(val);
+            str = end;
+            val = strtoul(str, &end, 10);
+            success = (end != str);
+            lineNum = static_cast<uint32_t>(val);
+            for(str = end; *str != '\0' && success; str++)
+                {
+                success = isspace(static_cast<unsigned char>(*str));
+                }
             }
+        mHashes.push_back(hash);
+        mLineNums.push_back(lineNum);
         }
-    return matchLen;
+    return success;
+    }
+
+void HashFilesLoader::loadFiles()
+    {
+    setupQueue(getNumHardwareThreads());
+    for(size_t i=0; i<mFilePaths.size(); i++)
+        {
+        addTask(i);
+        }
+    waitForCompletion();
     }
 
 OovString HashFile::getActualFileName() const
@@ -214,6 +195,279 @@ OovString HashFile::getRelativeFileName() const
     }
 
 
+/// This is the hash of a sequence of hash items that starts at an index
+/// of the DuplicateIndex.
+class KGramItem
+    {
+    public:
+        KGramItem(uint64_t hash, size_t index):
+            mHash(hash), mIndex(index)
+            {}
+        bool operator<(KGramItem const &item) const
+            {
+            return((mHash < item.mHash) ||
+                (mHash == item.mHash && mIndex < item.mIndex));
+            }
+        uint64_t mHash;
+        size_t mIndex;
+    };
+
+/// A duplicate run of hash items that was found between two places in
+/// the DuplicateIndex.
+class DuplicateRun
+    {
+    public:
+        DuplicateRun(size_t file1, size_t index1, size_t file2, size_t index2,
+                size_t len):
+            mFile1(file1), mIndex1(index1), mFile2(file2), mIndex2(index2),
+            mLen(len)
+            {}
+        bool operator<(DuplicateRun const &run) const
+            {
+            bool less;
+            if(mFile1 != run.mFile1)
+                less = (mFile1 < run.mFile1);
+            else if(mFile2 != run.mFile2)
+                less = (mFile2 < run.mFile2);
+            else if(mIndex1 != run.mIndex1)
+                less = (mIndex1 < run.mIndex1);
+            else
+                less = (mIndex2 < run.mIndex2);
+            return less;
+            }
+        size_t mFile1;
+        size_t mIndex1;
+        size_t mFile2;
+        size_t mIndex2;
+        size_t mLen;
+    };
+
+/// This keeps the hash items of all files in a single sequence so that
+/// duplicates can be found without comparing every file with every other
+/// file.
+///
+/// Every run of duplicate hash items that is long enough to be reported
+/// starts with a sequence of (mNumTokenMatches + 1) hash items that is
+/// identical in both places. The hashes of these sequences are sorted so
+/// that the places that have the same sequence are next to each other,
+/// then only those places are compared. A run is only reported at its
+/// start, so the shorter runs that are part of a reported run are not
+/// output. The time is about N log N for N hash items, plus the length of
+/// the duplicates that are found.
+///
+/// The places that have the same sequence are sorted by the hash items that
+/// follow them, so the places with the longest duplicates are next to each
+/// other, and each place is only compared with the next MaxSamePlaceCompares
+/// places in this order. When more places than this have the same code, a
+/// place is only reported with some of the other places.
+class DuplicateIndex
+    {
+    public:
+        void addFile(HashFile const &file);
+        /// Find the duplicate runs that are longer than mNumTokenMatches.
+        /// The runs are sorted by file, then by the location in the file.
+        void findDuplicates(DuplicateOptions const &options,
+            std::vector<DuplicateRun> &runs) const;
+        size_t getFileIndex(size_t index) const;
+        size_t getLineNum(size_t index) const
+            { return mLineNums[index]; }
+
+    private:
+        /// The hash items of all files. The files are separated with break
+        /// items, which have a line number of zero.
+        std::vector<uint64_t> mHashes;
+        std::vector<uint32_t> mLineNums;
+        std::vector<size_t> mFileStartIndices;
+
+        bool isBreak(size_t index) const
+            { return(mLineNums[index] == 0); }
+        /// Returns true if two places are in the same part of a file,
+        /// and should not be compared.
+        bool isSamePlace(size_t index1, size_t index2,
+            DuplicateOptions const &options) const;
+        /// Returns true if the items before both places are duplicates, so
+        /// the duplicate run does not start at these places.
+        bool isRunContinued(size_t index1, size_t index2,
+            DuplicateOptions const &options) const;
+        /// Returns the number of hash items that match.
+        size_t getDupLength(size_t index1, size_t index2) const;
+        /// Compares the hash items that start at both places, up to
+        /// MaxSortCompareLen items. Places that have the same items are
+        /// ordered by index.
+        bool isFollowingLess(size_t index1, size_t index2) const;
+    };
+
+void DuplicateIndex::addFile(HashFile const &file)
+    {
+    std::vector<uint64_t> const &hashes = file.getHashes();
+    std::vector<uint32_t> const &lineNums = file.getLineNums();
+    mFileStartIndices.push_back(mHashes.size());
+    mHashes.insert(mHashes.end(), hashes.begin(), hashes.end());
+    mHashes.push_back(0);
+    mLineNums.insert(mLineNums.end(), lineNums.begin(), lineNums.end());
+    mLineNums.push_back(0);
+    }
+
+size_t DuplicateIndex::getFileIndex(size_t index) const
+    {
+    auto iter = std::upper_bound(mFileStartIndices.begin(),
+        mFileStartIndices.end(), index);
+    return static_cast<size_t>(iter - mFileStartIndices.begin()) - 1;
+    }
+
+bool DuplicateIndex::isSamePlace(size_t index1, size_t index2,
+        DuplicateOptions const &options) const
+    {
+    bool samePlace = (index1 == index2);
+    if(!samePlace && !options.mFindDupsInLines)
+        {
+        samePlace = (mLineNums[index1] == mLineNums[index2] &&
+            getFileIndex(index1) == getFileIndex(index2));
+        }
+    return samePlace;
+    }
+
+bool DuplicateIndex::isRunContinued(size_t index1, size_t index2,
+        DuplicateOptions const &options) const
+    {
+    bool continued = false;
+    if(index1 > 0 && index2 > 0)
+        {
+        size_t prev1 = index1 - 1;
+        size_t prev2 = index2 - 1;
+        continued = (!isBreak(prev1) && !isBreak(prev2) &&
+            mHashes[prev1] == mHashes[prev2] &&
+            !isSamePlace(prev1, prev2, options));
+        }
+    return continued;
+    }
+
+size_t DuplicateIndex::getDupLength(size_t index1, size_t index2) const
+    {
+    // The last item is always a break, so this does not go past the end.
+    size_t matchLen = 0;
+    while(!isBreak(index1 + matchLen) && !isBreak(index2 + matchLen) &&
+            mHashes[index1 + matchLen] == mHashes[index2 + matchLen])
+        {
+        matchLen++;
+        }
+    return matchLen;
+    }
+
+bool DuplicateIndex::isFollowingLess(size_t index1, size_t index2) const
+    {
+    // The last item is always a break, so this does not go past the end.
+    bool less = (index1 < index2);
+    for(size_t i=0; i<MaxSortCompareLen; i++)
+        {
+        bool break1 = isBreak(index1 + i);
+        bool break2 = isBreak(index2 + i);
+        if(break1 || break2)
+            {
+            // A break is ordered after all hash items, so the places in a
+            // run of the same item stay in index order.
+            if(break1 != break2)
+                {
+                less = break2;
+                }
+            break;
+            }
+        uint64_t hash1 = mHashes[index1 + i];
+        uint64_t hash2 = mHashes[index2 + i];
+        if(hash1 != hash2)
+            {
+            less = (hash1 < hash2);
+            break;
+            }
+        }
+    return less;
+    }
+
+void DuplicateIndex::findDuplicates(DuplicateOptions const &options,
+        std::vector<DuplicateRun> &runs) const
+    {
+    size_t const kGramLen = options.mNumTokenMatches + 1;
+    // Make a rolling hash of every sequence of kGramLen items that does not
+    // contain a break.
+    uint64_t const multiplier = 0x100000001B3ULL;
+    uint64_t highMultiplier = 1;
+    for(size_t i=1; i<kGramLen; i++)
+        {
+        highMultiplier *= multiplier;
+        }
+    std::vector<KGramItem> kGrams;
+    kGrams.reserve(mHashes.size());
+    uint64_t hash = 0;
+    size_t seqLen = 0;
+    for(size_t i=0; i<mHashes.size(); i++)
+        {
+        if(isBreak(i))
+            {
+            hash = 0;
+            seqLen = 0;
+            }
+        else
+            {
+            if(seqLen == kGramLen)
+                {
+                hash -= mHashes[i-kGramLen] * highMultiplier;
+                }
+            else
+                {
+                seqLen++;
+                }
+            hash = hash * multiplier + mHashes[i];
+            if(seqLen == kGramLen)
+                {
+                kGrams.push_back(KGramItem(hash, i+1-kGramLen));
+                }
+            }
+        }
+    std::sort(kGrams.begin(), kGrams.end());
+
+    // Compare the places that have the same hash sequence.
+    for(size_t groupStart=0; groupStart<kGrams.size(); )
+        {
+        size_t groupEnd = groupStart + 1;
+        while(groupEnd < kGrams.size() &&
+                kGrams[groupEnd].mHash == kGrams[groupStart].mHash)
+            {
+            groupEnd++;
+            }
+        if(groupEnd - groupStart > MaxSamePlaceCompares + 1)
+            {
+            std::sort(kGrams.begin() + static_cast<int>(groupStart),
+                kGrams.begin() + static_cast<int>(groupEnd),
+                [this](KGramItem const &item1, KGramItem const &item2)
+                { return isFollowingLess(item1.mIndex, item2.mIndex); });
+            }
+        for(size_t i1=groupStart; i1<groupEnd; i1++)
+            {
+            size_t compareEnd = std::min(groupEnd, i1 + 1 + MaxSamePlaceCompares);
+            for(size_t i2=i1+1; i2<compareEnd; i2++)
+                {
+                size_t index1 = std::min(kGrams[i1].mIndex, kGrams[i2].mIndex);
+                size_t index2 = std::max(kGrams[i1].mIndex, kGrams[i2].mIndex);
+                if(!isSamePlace(index1, index2, options) &&
+                        !isRunContinued(index1, index2, options))
+                    {
+                    // Different sequences can have the same hash, so the
+                    // length must be checked.
+                    size_t len = getDupLength(index1, index2);
+                    if(len > options.mNumTokenMatches)
+                        {
+                        runs.push_back(DuplicateRun(getFileIndex(index1), index1,
+                            getFileIndex(index2), index2, len));
+                        }
+                    }
+                }
+            }
+        groupStart = groupEnd;
+        }
+    std::sort(runs.begin(), runs.end());
+    }
+
+
 class Duplicates
     {
     public:
@@ -224,30 +478,43 @@ class Duplicates
 
     private:
         std::vector<HashFile> mHashFiles;
-        // This is here to reduce the number of memory allocations.
-        FilterOutputHashIndices mFilterOutputHashIndices;
+        DuplicateIndex mDuplicateIndex;
     };
 
 
 Duplicates::Duplicates(std::vector<std::string> const &filePaths):
     mHashFiles(filePaths.size())
     {
-    for(size_t i=0; i<filePaths.size(); i++)
+    HashFilesLoader loader(filePaths, mHashFiles);
+    loader.loadFiles();
+    for(auto const &file : mHashFiles)
         {
-        mHashFiles[i].readHashFile(filePaths[i]);
+        mDuplicateIndex.addFile(file);
         }
     }
 
 void Duplicates::compareAllFiles(DuplicateOptions const &options,
         std::vector<DuplicateLineInfo> &dupLineInfo)
     {
-    for(size_t i1=0; i1<mHashFiles.size(); i1++)
+    std::vector<DuplicateRun> runs;
+    mDuplicateIndex.findDuplicates(options, runs);
+    OovStringVec relativeFileNames;
+    for(auto const &file : mHashFiles)
         {
-        for(size_t i2=i1; i2<mHashFiles.size(); i2++)
-            {
-            mHashFiles[i1].compareHashFiles(mHashFiles[i2],
-                mFilterOutputHashIndices, options, dupLineInfo);
-            }
+        relativeFileNames.push_back(file.getRelativeFileName());
+        }
+    for(auto const &run : runs)
+        {
+        size_t firstLine = mDuplicateIndex.getLineNum(run.mIndex1);
+        size_t lastLine = mDuplicateIndex.getLineNum(run.mIndex1 + run.mLen - 1);
+        DuplicateLineInfo info;
+        info.mTotalDupLines = static_cast<int>(lastLine - firstLine + 1);
+        info.mFile1 = relativeFileNames[run.mFile1];
+        info.mFile1StartLine = static_cast<int>(firstLine);
+        info.mFile2 = relativeFileNames[run.mFile2];
+        info.mFile2StartLine = static_cast<int>(
+            mDuplicateIndex.getLineNum(run.mIndex2));
+        dupLineInfo.push_back(info);
         }
     }
 
@@ -8,6 +8,10 @@
 #include <ctype.h>
 #include <random>
 #include <float.h>      // For DBL_MAX
+#include <algorithm>
+#include <thread>
+
+#define MULTI_THREAD 1
 
 /// Generate a random number including 0 to maxpossible
 static size_t randmax(size_t maxpossible)
@@ -80,10 +84,91 @@ void GenePool::singleGeneration()
     mutate();
     }
 
+void GenePool::startQualityThreads()
+    {
+#if(MULTI_THREAD)
+    if(mQualityThreads.size() == 0)
+        {
+        size_t numThreads = std::min<size_t>(std::thread::hardware_concurrency(),
+            numgenes);
+        mNumQualityThreads = std::max<size_t>(numThreads, 1);
+        mQualityGeneration = 0;
+        mQuitQualityThreads = false;
+        for(size_t threadIndex=1; threadIndex<mNumQualityThreads; threadIndex++)
+            {
+            mQualityThreads.push_back(std::thread(
+                [this, threadIndex]()
+                {
+                qualityThreadProc(threadIndex);
+                }));
+            }
+        }
+#endif
+    }
+
+void GenePool::stopQualityThreads()
+    {
+    if(mQualityThreads.size() > 0)
+        {
+        std::unique_lock<std::mutex> lock(mQualityMutex);
+        mQuitQualityThreads = true;
+        lock.unlock();
+        mQualityStartSignal.notify_all();
+        for(auto &thread : mQualityThreads)
+            {
+            thread.join();
+            }
+        mQualityThreads.clear();
+        }
+    }
+
+void GenePool::qualityThreadProc(size_t firstGene)
+    {
+    size_t generation = 0;
+    std::unique_lock<std::mutex> lock(mQualityMutex);
+    while(!mQuitQualityThreads)
+        {
+        mQualityStartSignal.wait(lock, [this, &generation]
+            { return(mQuitQualityThreads || mQualityGeneration != generation); });
+        if(!mQuitQualityThreads)
+            {
+            generation = mQualityGeneration;
+            lock.unlock();
+            computeQuality(firstGene, mNumQualityThreads);
+            lock.lock();
+            mNumQualityThreadsDone++;
+            mQualityDoneSignal.notify_one();
+            }
+        }
+    }
+
 void GenePool::computeQuality()
     {
     setupQualityEachGeneration();
-    for(size_t i=0; i<numgenes; i++)
+    if(mQualityThreads.size() > 0)
+        {
+        // The quality of each gene only depends on the gene, and each gene
+        // quality is a separate location in memory, so no locks are needed
+        // while the qualities are computed.
+        std::unique_lock<std::mutex> lock(mQualityMutex);
+        mNumQualityThreadsDone = 0;
+        mQualityGeneration++;
+        lock.unlock();
+        mQualityStartSignal.notify_all();
+        computeQuality(0, mNumQualityThreads);
+        lock.lock();
+        mQualityDoneSignal.wait(lock, [this]
+            { return(mNumQualityThreadsDone == mQualityThreads.size()); });
+        }
+    else
+        {
+        computeQuality(0, 1);
+        }
+    }
+
+void GenePool::computeQuality(size_t firstGene, size_t stride)
+    {
+    for(size_t i=firstGene; i<numgenes; i+=stride)
         {
         setGeneQuality(i, calculateSingleGeneQuality(i));
         }
@@ -12,6 +12,9 @@
 #define FASTGENE_H
 
 #include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <stdint.h>
 #include <memory.h>
 
@@ -41,8 +44,12 @@ class GenePool
         GeneValue min;                  /// Minimum gene value
         GeneValue max;
 
-        /// This fills the quality value in all of the genes.
+        /// This fills the quality value in all of the genes. The genes are
+        /// split between the quality threads if they are started.
         void computeQuality();
+        /// This fills the quality value of every stride gene, starting at
+        /// the first gene.
+        void computeQuality(size_t firstGene, size_t stride);
         /// Crossover a pair of good genes and put the results into some bad genes.
         /// This does a GeneValue sized crossover. (Not bitwise)
         void crossover();
@@ -52,23 +59,32 @@ class GenePool
         void buildBestWorstList();
 
         GenePool():
-            numgenes(0), genesize(0), muterate(.1), min(0), max(0)
+            numgenes(0), genesize(0), muterate(.1), min(0), max(0),
+            mNumQualityThreads(0), mQualityGeneration(0),
+            mNumQualityThreadsDone(0), mQuitQualityThreads(false)
             {}
         virtual ~GenePool()
-            {}
+            { stopQualityThreads(); }
         /// Get a gene pool. This allocates memory for the gene pool and initializes the
         /// genes with random data.
         /// @param genebytes Length of each gene in bytes, not including quality
         /// @param numgenes Number of genes to have in pool
         void initialize(size_t genebytes, size_t numgenes, double crossoverrate=0.35,
             double mutaterate=0.005, GeneValue minrand=0, GeneValue maxrand=255);
+        /// Starts the threads that compute the gene qualities. This is
+        /// called before many generations so that the threads are not
+        /// created for every generation.
+        void startQualityThreads();
+        /// Stops the threads that were started with startQualityThreads.
+        void stopQualityThreads();
 
     protected:
         /// Called before calculating single genes.
         virtual void setupQualityEachGeneration()
             {}
         /// This function is called for every gene. It is passed the gene to
-        /// test and returns the quality of the gene.
+        /// test and returns the quality of the gene. This is called by
+        /// multiple threads at the same time for different genes.
         virtual QualityType calculateSingleGeneQuality(size_t geneIndex) const = 0;
         virtual void randomizeGene(size_t geneIndex);
         /// Offset is byte based.
@@ -108,6 +124,24 @@ class GenePool
         /// This may resize the histogram.
         void getQualityHistogram(QualityHistogram &qualities) const;
         size_t getBestGeneIndex();
+
+    private:
+        /// The threads that help the thread that calls singleGeneration.
+        std::vector<std::thread> mQualityThreads;
+        /// The stride between genes, which is the number of helper threads
+        /// plus the calling thread.
+        size_t mNumQualityThreads;
+        std::mutex mQualityMutex;
+        /// A signal that a new generation is ready or that the threads
+        /// should quit.
+        std::condition_variable mQualityStartSignal;
+        /// A signal that a thread finished a generation.
+        std::condition_variable mQualityDoneSignal;
+        size_t mQualityGeneration;
+        size_t mNumQualityThreadsDone;
+        bool mQuitQualityThreads;
+
+        void qualityThreadProc(size_t firstGene);
     };
 
 #endif
@@ -0,0 +1,164 @@
+/*
+ * GraphReachability.cpp
+ *
+ *  \copyright 2016 DCBlaha.  Distributed under the GPL.
+ */
+
+#include "GraphReachability.h"
+#include <algorithm>
+
+static const size_t NO_INDEX = static_cast<size_t>(-1);
+
+// This is Tarjan's algorithm without recursion, since a deep dependency
+// chain could overflow the stack. The components are numbered in reverse
+// topological order, so the components that a component depends on
+// always have lower numbers.
+void GraphReachability::findComponents(size_t numNodes,
+    std::vector<std::vector<size_t>> const &nodeEdges)
+    {
+    struct SearchItem
+        {
+        SearchItem(size_t node):
+            mNode(node), mEdgeIndex(0)
+            {}
+        size_t mNode;
+        size_t mEdgeIndex;
+        };
+    std::vector<size_t> visitOrder(numNodes, NO_INDEX);
+    std::vector<size_t> lowLink(numNodes, 0);
+    std::vector<bool> onStack(numNodes, false);
+    std::vector<size_t> componentStack;
+    std::vector<SearchItem> searchStack;
+    size_t numVisited = 0;
+    size_t numComponents = 0;
+    mNodeComponents.assign(numNodes, NO_INDEX);
+    for(size_t startNode=0; startNode<numNodes; startNode++)
+        {
+        if(visitOrder[startNode] == NO_INDEX)
+            {
+            searchStack.push_back(SearchItem(startNode));
+            while(searchStack.size() > 0)
+                {
+                SearchItem &item = searchStack.back();
+                size_t node = item.mNode;
+                if(item.mEdgeIndex == 0 && visitOrder[node] == NO_INDEX)
+                    {
+                    visitOrder[node] = numVisited;
+                    lowLink[node] = numVisited;
+                    numVisited++;
+                    componentStack.push_back(node);
+                    onStack[node] = true;
+                    }
+                if(item.mEdgeIndex < nodeEdges[node].size())
+                    {
+                    size_t destNode = nodeEdges[node][item.mEdgeIndex++];
+                    if(visitOrder[destNode] == NO_INDEX)
+                        {
+                        // This invalidates the item reference.
+                        searchStack.push_back(SearchItem(destNode));
+                        }
+                    else if(onStack[destNode])
+                        {
+                        lowLink[node] = std::min(lowLink[node], visitOrder[destNode]);
+                        }
+                    }
+                else
+                    {
+                    if(lowLink[node] == visitOrder[node])
+                        {
+                        size_t compNode;
+                        do
+                            {
+                            compNode = componentStack.back();
+                            componentStack.pop_back();
+                            onStack[compNode] = false;
+                            mNodeComponents[compNode] = numComponents;
+                            } while(compNode != node);
+                        numComponents++;
+                        }
+                    searchStack.pop_back();
+                    if(searchStack.size() > 0)
+                        {
+                        size_t parentNode = searchStack.back().mNode;
+                        lowLink[parentNode] = std::min(lowLink[parentNode],
+                            lowLink[node]);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+void GraphReachability::build(size_t numNodes, std::vector<GraphEdge> const &edges)
+    {
+    std::vector<std::vector<size_t>> nodeEdges(numNodes);
+    for(auto const &edge : edges)
+        {
+        nodeEdges[edge.mSrcNode].push_back(edge.mDestNode);
+        }
+    findComponents(numNodes, nodeEdges);
+
+    size_t numComponents = 0;
+    for(auto const &comp : mNodeComponents)
+        {
+        numComponents = std::max(numComponents, comp + 1);
+        }
+    // Get the edges between components without duplicates.
+    std::vector<std::vector<size_t>> compEdges(numComponents);
+    for(auto const &edge : edges)
+        {
+        size_t srcComp = mNodeComponents[edge.mSrcNode];
+        size_t destComp = mNodeComponents[edge.mDestNode];
+        if(srcComp != destComp)
+            {
+            compEdges[srcComp].push_back(destComp);
+            }
+        }
+    for(auto &destComps : compEdges)
+        {
+        std::sort(destComps.begin(), destComps.end());
+        destComps.erase(std::unique(destComps.begin(), destComps.end()),
+            destComps.end());
+        }
+
+    // The components that a component depends on have lower numbers, so
+    // they are done before the component.
+    mNumWords = (numComponents + 63) / 64;
+    mReach.assign(numComponents * mNumWords, 0);
+    mIndirectReach.assign(numComponents * mNumWords, 0);
+    // The components that can be reached through at least one edge.
+    std::vector<uint64_t> strictReach(numComponents * mNumWords, 0);
+    for(size_t comp=0; comp<numComponents; comp++)
+        {
+        size_t compWord = comp * mNumWords;
+        for(auto const &destComp : compEdges[comp])
+            {
+            size_t destWord = destComp * mNumWords;
+            for(size_t wi=0; wi<mNumWords; wi++)
+                {
+                strictReach[compWord + wi] |= mReach[destWord + wi];
+                mIndirectReach[compWord + wi] |= strictReach[destWord + wi];
+                }
+            }
+        for(size_t wi=0; wi<mNumWords; wi++)
+            {
+            mReach[compWord + wi] = strictReach[compWord + wi];
+            }
+        mReach[compWord + comp/64] |= static_cast<uint64_t>(1) << (comp%64);
+        }
+    }
+
+bool GraphReachability::isReachable(size_t srcNode, size_t destNode) const
+    {
+    size_t srcComp = mNodeComponents[srcNode];
+    size_t destComp = mNodeComponents[destNode];
+    return isBitSet(mReach, srcComp * mNumWords, destComp);
+    }
+
+bool GraphReachability::isImpliedEdge(size_t srcNode, size_t destNode) const
+    {
+    size_t srcComp = mNodeComponents[srcNode];
+    size_t destComp = mNodeComponents[destNode];
+    return(srcComp != destComp &&
+        isBitSet(mIndirectReach, srcComp * mNumWords, destComp));
+    }
@@ -0,0 +1,78 @@
+/*
+ * GraphReachability.h
+ *
+ *  \copyright 2016 DCBlaha.  Distributed under the GPL.
+ */
+
+#ifndef GRAPHREACHABILITY_H_
+#define GRAPHREACHABILITY_H_
+
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+/// A directed edge between two node indices. For dependency graphs, the
+/// source is the consumer and the destination is the supplier.
+struct GraphEdge
+    {
+    GraphEdge(size_t srcNode, size_t destNode):
+        mSrcNode(srcNode), mDestNode(destNode)
+        {}
+    size_t mSrcNode;
+    size_t mDestNode;
+    };
+
+/// This finds which nodes of a directed graph can be reached from other
+/// nodes, and which edges are implied by other paths (the edges that are
+/// removed by a transitive reduction). This does not know about the type of
+/// graph, so it can be used for component, include or zone dependencies.
+///
+/// The nodes of each cycle (strongly connected component) are combined, so
+/// cycles do not cause infinite searches. The nodes that can be reached from
+/// each component are kept as a bit set, and are found in reverse
+/// topological order, so building takes time proportional to
+/// edges * components / 64.
+///
+/// Each bit set takes components * components / 8 bytes of memory. Two are
+/// kept and a third is used while building, so a graph of 100000 nodes
+/// that are not in cycles needs almost 4GB. This should not be used for
+/// very large graphs, such as the include graph of a large project.
+class GraphReachability
+    {
+    public:
+        GraphReachability():
+            mNumWords(0)
+            {}
+        /// Find the reachability of all nodes.
+        /// @param numNodes The number of nodes. All edges must use indices
+        ///     that are less than this.
+        /// @param edges The edges of the graph.
+        void build(size_t numNodes, std::vector<GraphEdge> const &edges);
+        /// Returns true if there is a path from the source to the destination.
+        /// A node can always reach itself.
+        bool isReachable(size_t srcNode, size_t destNode) const;
+        /// Returns true if there is a path from the source to the destination
+        /// through other nodes, so that an edge between them is not needed
+        /// to show the dependency. Edges between nodes that are in the same
+        /// cycle are never implied.
+        bool isImpliedEdge(size_t srcNode, size_t destNode) const;
+
+    private:
+        /// The component index for each node.
+        std::vector<size_t> mNodeComponents;
+        size_t mNumWords;
+        /// For each component, the bits of the components that can be
+        /// reached, including itself.
+        std::vector<uint64_t> mReach;
+        /// For each component, the bits of the components that can be
+        /// reached through at least one other component.
+        std::vector<uint64_t> mIndirectReach;
+
+        void findComponents(size_t numNodes,
+            std::vector<std::vector<size_t>> const &nodeEdges);
+        static bool isBitSet(std::vector<uint64_t> const &bits, size_t wordIndex,
+            size_t bit)
+            { return((bits[wordIndex + bit/64] >> (bit%64)) & 1); }
+    };
+
+#endif /* GRAPHREACHABILITY_H_ */
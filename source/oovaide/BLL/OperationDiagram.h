@@ -54,7 +54,7 @@ class OperationDiagram:public Diagram
         void addOperCallers(const OperationCall &call)
             { mOpGraph.addOperCallers(*mModelData, call); }
         void addVariableReferencesFromGraphNodes(OperationNode const *node)
-            { mOpGraph.addVariableReferencesFromGraphNodes(node); }
+            { mOpGraph.addVariableReferencesFromGraphNodes(*mModelData, node); }
         OovStringRef getNodeName(const OperationCall &opCall) const
             { return mOpGraph.getNodeName(opCall); }
 
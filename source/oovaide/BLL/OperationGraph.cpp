@@ -597,50 +597,28 @@ void OperationGraph::addOperDefinition(const OperationCall &opcall)
         }
     }
 
-void OperationGraph::addOperCallers(const ModelStatements &stmts,
-        const ModelClassifier &srcCls, const ModelOperation &oper,
-        const OperationCall &callee)
+void OperationGraph::addOperCallers(const ModelData &model, const OperationCall &callee)
     {
     OperationClass const *calleeClass = callee.getDestNode()->getClass();
     if(calleeClass)
         {
-        for(auto const &stmt : stmts)
+        ModelOperReferences const &callers = model.getOperCallers(
+            calleeClass->getType(), callee.getOperation().getName());
+        for(auto const &caller : callers)
             {
-            if(stmt.getStatementType() == ST_Call)
-                {
-                const ModelClassifier *callerCls = ModelClassifier::getClass(
-                    stmt.getClassDecl().getDeclType());
-                if(stmt.operMatch(callee.getOperation().getName()) &&
-                        callerCls == calleeClass->getType())
-                    {
-                    addRelatedOperations(srcCls, oper, OperationGraph::AO_All, 1);
-                    }
-                }
+            addRelatedOperations(*caller.mClass, *caller.mOper,
+                OperationGraph::AO_All, 1);
             }
         }
     }
 
-void OperationGraph::addOperCallers(const ModelData &model, const OperationCall &callee)
-    {
-    for(const auto &type : model.mTypes)
-        {
-        const ModelClassifier *srcCls = ModelClassifier::getClass(type.get());
-        if(srcCls)
-            {
-            for(const auto &oper : srcCls->getOperations())
-                {
-                addOperCallers(oper->getStatements(), *srcCls, *oper, callee);
-                }
-            }
-        }
-    }
-
-void OperationGraph::addVariableReferencesFromGraphNodes(OperationNode const *node)
+void OperationGraph::addVariableReferencesFromGraphNodes(const ModelData &model,
+        OperationNode const *node)
     {
     struct ClsOper
         {
         ModelClassifier const *cls;
-        ModelOperation *oper;
+        ModelOperation const *oper;
 
         bool operator<(ClsOper const &clsOper) const
             { return(cls<clsOper.cls ||
@@ -648,36 +626,28 @@ void OperationGraph::addVariableReferencesFromGraphNodes(OperationNode const *no
         };
     std::set<ClsOper> newOpers;
     OperationVariable const *var = node->getVariable();
-    if(var)
+    ModelClassifier const *varClass = var ? var->getOwnerClass() : nullptr;
+    if(varClass)
         {
+        std::set<ModelClassifier const *> graphClasses;
         for(auto const &node : mNodes)
             {
             OperationClass *opClass = node->getClass();
             if(opClass)
                 {
-                const ModelClassifier *cls = ModelClassifier::getClass(opClass->getType());
-                for(auto const &oper : cls->getOperations())
-                    {
-                    ModelStatements &stmts = oper->getStatements();
-                    for(auto const &stmt : stmts)
-                        {
-                        if(stmt.getStatementType() == ST_VarRef)
-                            {
-                            ModelClassifier const *varClass = var->getOwnerClass();
-                            if(varClass)
-                                {
-                                if(stmt.getClassDecl().getDeclType() == varClass &&
-                                    stmt.getAttrName() == var->getAttrName())
-                                    {
-                                    ClsOper clsOp;
-                                    clsOp.cls = cls;
-                                    clsOp.oper = oper.get();
-                                    newOpers.insert(clsOp);
-                                    }
-                                }
-                            }
-                        }
-                    }
+                graphClasses.insert(ModelClassifier::getClass(opClass->getType()));
+                }
+            }
+        ModelOperReferences const &refs = model.getAttrReferences(varClass,
+            var->getAttrName());
+        for(auto const &ref : refs)
+            {
+            if(ref.mVarRef && graphClasses.find(ref.mClass) != graphClasses.end())
+                {
+                ClsOper clsOp;
+                clsOp.cls = ref.mClass;
+                clsOp.oper = ref.mOper;
+                newOpers.insert(clsOp);
                 }
             }
         }
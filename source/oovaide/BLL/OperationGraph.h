@@ -306,7 +306,8 @@ class OperationGraph
         void addOperDefinition(const OperationCall &call);
         void addOperCallers(const ModelData &model, const OperationCall &call);
         // Adds references from all of the classes in the operation graph.
-        void addVariableReferencesFromGraphNodes(OperationNode const *node);
+        void addVariableReferencesFromGraphNodes(const ModelData &model,
+                OperationNode const *node);
         void removeOperDefinition(const OperationCall &opcall);
         bool isOperCalled(const OperationCall &opcall) const;
         OperationDefinition *getOperDefinition(const OperationCall &opcall) const;
@@ -323,8 +324,6 @@ class OperationGraph
         static const size_t NO_INDEX = static_cast<size_t>(-1);
 
         void addDefinition(OperationNode const *destNode, ModelOperation const &oper);
-        void addOperCallers(ModelStatements const &stmts, ModelClassifier const &srcCls,
-                ModelOperation const &oper, OperationCall const &callee);
         enum eGetClass { GC_AddClasses, FT_OnlyGetClasses };
         size_t addOrGetClass(ModelClassifier const *cls, eGetClass gc);
         size_t addOrGetVariable(ModelClassifier const *cls, OovStringRef varName,
@@ -89,7 +89,7 @@ void PortionGraph::addConnections(ModelClassifier const *cls)
     // Operation to attribute connections
     for(auto const &attr : cls->getAttributes())
         {
-        addAttrOperConnections(cls, attr->getName(), cls->getOperations());
+        addAttrOperConnections(cls, attr->getName());
         }
     // Operation to operation connections.
     for(auto const &oper : cls->getOperations())
@@ -101,16 +101,16 @@ void PortionGraph::addConnections(ModelClassifier const *cls)
     }
 
 void PortionGraph::addAttrOperConnections(ModelClassifier const *cls,
-        OovStringRef attrName,
-        std::vector<std::unique_ptr<ModelOperation>> const &opers)
+        OovStringRef attrName)
     {
-    for(auto const &oper : opers)
+    // The references are in the order of the operations of each class.
+    ModelOperReferences const &refs = mModel->getAttrReferences(cls, attrName);
+    for(auto const &ref : refs)
         {
-        ModelStatements const &statements = oper->getStatements();
-        if(statements.checkAttrUsed(cls, attrName))
+        if(ref.mClass == cls)
             {
             PortionNode const *attrNode = getNode(attrName, PNT_Attribute);
-            PortionNode const *operNode = getNode(oper->getOverloadFuncName(),
+            PortionNode const *operNode = getNode(ref.mOper->getOverloadFuncName(),
                     PNT_Operation);
             if(attrNode && operNode)
                 {
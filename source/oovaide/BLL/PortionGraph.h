@@ -109,8 +109,8 @@ class PortionGraph
         PortionDrawOptions mDrawOptions;
 
         void addConnections(ModelClassifier const *cls);
-        void addAttrOperConnections(ModelClassifier const *cls, OovStringRef attrName,
-                std::vector<std::unique_ptr<ModelOperation>> const &opers);
+        // Add connections from the operations of this class that use the attribute.
+        void addAttrOperConnections(ModelClassifier const *cls, OovStringRef attrName);
         // Add connections between all operations of this class.
         void addOperationConnections(ModelClassifier const *classifier,
                 ModelStatements const &statements, PortionNode const *operNode);
@@ -41,6 +41,17 @@ void Contexts::init(OovTaskStatusListener &taskStatusListener)
 void Contexts::clear()
     {
     mProject.clearAnalysis();
+    clearViews();
+    }
+
+void Contexts::unloadAnalysis()
+    {
+    mProject.unloadAnalysis();
+    clearViews();
+    }
+
+void Contexts::clearViews()
+    {
     mJournal.clear();
     mComponentList.clear();
     mIncludeList.clear();
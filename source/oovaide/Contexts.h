@@ -63,6 +63,9 @@ class Contexts:public JournalListener, public EditorListener
             { mJournal.stopAndWaitForBackgroundComplete(); }
 
         void clear();
+        /// Clears the views, but keeps the model so that only the changed
+        /// XMI files are loaded after analysis completes.
+        void unloadAnalysis();
         /// Oovaide performs the analysis, then calls this after analysis completes.
         /// Then this updates the component list, and starts loading the project files.
         void updateContextAfterAnalysisCompletes();
@@ -137,6 +140,7 @@ class Contexts:public JournalListener, public EditorListener
             {
             mComponentList.clearSelection();
             }
+        void clearViews();
         /// Reads from the journal and updates the GUI journal list.
         void updateJournalList();
         void updateIncludeList();
@@ -24,7 +24,8 @@ struct DatabaseWriterInterface
     ///         type information and methods. The second pass looks at
     ///         each methods statements to find related types and methods.
     /// *param typeIndex The index of the type to save from ModelData::mTypes.
-    bool (*WriteDb)(int passIndex, int &typeIndex, int maxTypesPerTransaction);
+    /// @param maxTypes The number of types to write for each call.
+    bool (*WriteDb)(int passIndex, int &typeIndex, int maxTypes);
     /// This writes the component information that is used by the modules table.
     bool (*WriteDbComponentTypes)(void const *compTypesFile, void const *scannedCompInfo);
     /// This writes the module relations for include or import.
@@ -0,0 +1,781 @@
+/*
+ * ModelCache.cpp
+ *
+ *  \copyright 2016 DCBlaha.  Distributed under the GPL.
+ */
+
+#include "ModelCache.h"
+#include "File.h"
+#include "FilePath.h"
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <stdint.h>
+
+// This must be changed whenever the format of the file changes.
+static char const sCacheSignature[] = "OovModelCache 2";
+
+// The numbers are written as variable length integers with seven bits per
+// byte, where the high bit indicates that more bytes follow.
+static void appendUnsigned(std::string &buf, uint64_t val)
+    {
+    while(val >= 0x80)
+        {
+        buf += static_cast<char>((val & 0x7F) | 0x80);
+        val >>= 7;
+        }
+    buf += static_cast<char>(val);
+    }
+
+// Signed values are zigzag encoded so that small negative values such as
+// UNDEFINED_ID are small.
+static void appendSigned(std::string &buf, int64_t val)
+    {
+    appendUnsigned(buf, (static_cast<uint64_t>(val) << 1) ^
+        static_cast<uint64_t>(val >> 63));
+    }
+
+static void appendString(std::string &buf, std::string const &str)
+    {
+    appendUnsigned(buf, str.length());
+    buf += str;
+    }
+
+/// Writes the model. Strings are written to a string table, and the
+/// model refers to them by index.
+class ModelCacheWriter
+    {
+    public:
+        ModelCacheWriter(ModelData const &model);
+        void writeModel();
+        void writeFileContents(XmiFileContents const &contents);
+        std::string const &getStrings() const
+            { return mStrings; }
+        size_t getNumStrings() const
+            { return mStringIds.size(); }
+        std::string const &getModelBuf() const
+            { return mModelBuf; }
+
+    private:
+        ModelData const &mModel;
+        std::unordered_map<std::string, size_t> mStringIds;
+        std::unordered_map<ModelType const*, size_t> mTypeIndices;
+        std::unordered_map<ModelModule const*, size_t> mModuleIndices;
+        std::string mStrings;
+        std::string mModelBuf;
+
+        void writeStringId(std::string const &str);
+        // Zero is used for null, otherwise this is the index plus one.
+        void writeTypeIndex(ModelType const *type);
+        void writeModuleIndex(ModelModule const *module);
+        void writeTypeRef(ModelTypeRef const &ref);
+        void writeDeclarator(ModelDeclarator const &decl);
+        void writeOperation(ModelOperation const &oper);
+        void writeClassifier(ModelClassifier const &classifier);
+    };
+
+ModelCacheWriter::ModelCacheWriter(ModelData const &model):
+    mModel(model)
+    {
+    for(size_t i=0; i<model.mTypes.size(); i++)
+        {
+        mTypeIndices[model.mTypes[i].get()] = i;
+        }
+    for(size_t i=0; i<model.mModules.size(); i++)
+        {
+        mModuleIndices[model.mModules[i].get()] = i;
+        }
+    }
+
+void ModelCacheWriter::writeStringId(std::string const &str)
+    {
+    auto result = mStringIds.insert(std::make_pair(str, mStringIds.size()));
+    if(result.second)
+        {
+        appendString(mStrings, str);
+        }
+    appendUnsigned(mModelBuf, (*result.first).second);
+    }
+
+void ModelCacheWriter::writeTypeIndex(ModelType const *type)
+    {
+    size_t index = 0;
+    auto iter = mTypeIndices.find(type);
+    if(iter != mTypeIndices.end())
+        {
+        index = (*iter).second + 1;
+        }
+    appendUnsigned(mModelBuf, index);
+    }
+
+void ModelCacheWriter::writeModuleIndex(ModelModule const *module)
+    {
+    size_t index = 0;
+    auto iter = mModuleIndices.find(module);
+    if(iter != mModuleIndices.end())
+        {
+        index = (*iter).second + 1;
+        }
+    appendUnsigned(mModelBuf, index);
+    }
+
+void ModelCacheWriter::writeTypeRef(ModelTypeRef const &ref)
+    {
+    writeTypeIndex(ref.getDeclType());
+    appendSigned(mModelBuf, ref.getDeclTypeModelId());
+    appendUnsigned(mModelBuf, ref.isConst() | (ref.isRefer() << 1));
+    }
+
+void ModelCacheWriter::writeDeclarator(ModelDeclarator const &decl)
+    {
+    writeStringId(decl.getName());
+    appendSigned(mModelBuf, decl.getModelId());
+    writeTypeRef(decl);
+    }
+
+void ModelCacheWriter::writeOperation(ModelOperation const &oper)
+    {
+    writeStringId(oper.getName());
+    appendSigned(mModelBuf, oper.getModelId());
+    writeStringId(oper.getOverloadKey());
+    appendUnsigned(mModelBuf, oper.getAccess().getVis());
+    appendUnsigned(mModelBuf, oper.isConst() | (oper.isVirtual() << 1));
+    writeModuleIndex(oper.getModule());
+    appendUnsigned(mModelBuf, oper.getLineNum());
+    writeTypeRef(oper.getReturnType());
+    appendUnsigned(mModelBuf, oper.getParams().size());
+    for(auto const &param : oper.getParams())
+        {
+        writeDeclarator(*param);
+        }
+    appendUnsigned(mModelBuf, oper.getBodyVarDeclarators().size());
+    for(auto const &vd : oper.getBodyVarDeclarators())
+        {
+        writeDeclarator(*vd);
+        }
+    appendUnsigned(mModelBuf, oper.getStatements().size());
+    for(auto const &stmt : oper.getStatements())
+        {
+        appendUnsigned(mModelBuf, stmt.getStatementType());
+        writeStringId(stmt.getFullName());
+        writeTypeRef(stmt.getClassDecl());
+        writeTypeRef(stmt.getVarDecl());
+        appendUnsigned(mModelBuf, stmt.getVarAccessWrite());
+        }
+    }
+
+void ModelCacheWriter::writeClassifier(ModelClassifier const &classifier)
+    {
+    writeModuleIndex(classifier.getModule());
+    appendUnsigned(mModelBuf, classifier.getLineNum());
+    appendUnsigned(mModelBuf, classifier.getAttributes().size());
+    for(auto const &attr : classifier.getAttributes())
+        {
+        writeDeclarator(*attr);
+        appendUnsigned(mModelBuf, attr->getAccess().getVis());
+        }
+    appendUnsigned(mModelBuf, classifier.getOperations().size());
+    for(auto const &oper : classifier.getOperations())
+        {
+        writeOperation(*oper);
+        }
+    }
+
+void ModelCacheWriter::writeModel()
+    {
+    appendUnsigned(mModelBuf, mModel.mModules.size());
+    for(auto const &mod : mModel.mModules)
+        {
+        writeStringId(mod->getModulePath());
+        appendSigned(mModelBuf, mod->getModelId());
+        appendUnsigned(mModelBuf, mod->mLineStats.mNumCodeLines);
+        appendUnsigned(mModelBuf, mod->mLineStats.mNumCommentLines);
+        appendUnsigned(mModelBuf, mod->mLineStats.mNumModuleLines);
+        }
+    // All types are written before the classes so that references to
+    // types can be resolved while reading.
+    appendUnsigned(mModelBuf, mModel.mTypes.size());
+    for(auto const &type : mModel.mTypes)
+        {
+        appendUnsigned(mModelBuf, type->getDataType());
+        writeStringId(type->getName());
+        appendSigned(mModelBuf, type->getModelId());
+        }
+    for(auto const &type : mModel.mTypes)
+        {
+        ModelClassifier const *classifier = ModelClassifier::getClass(type.get());
+        if(classifier)
+            {
+            writeClassifier(*classifier);
+            }
+        }
+    appendUnsigned(mModelBuf, mModel.mAssociations.size());
+    for(auto const &assoc : mModel.mAssociations)
+        {
+        writeTypeIndex(assoc->getChild());
+        writeTypeIndex(assoc->getParent());
+        appendSigned(mModelBuf, assoc->getChildModelId());
+        appendSigned(mModelBuf, assoc->getParentModelId());
+        appendUnsigned(mModelBuf, assoc->getAccess().getVis());
+        writeModuleIndex(assoc->getModule());
+        }
+    }
+
+void ModelCacheWriter::writeFileContents(XmiFileContents const &contents)
+    {
+    writeModuleIndex(contents.mModule);
+    appendUnsigned(mModelBuf, contents.mTypeNames.size());
+    for(auto const &name : contents.mTypeNames)
+        {
+        writeStringId(name);
+        }
+    }
+
+
+/// Reads the model. Any read past the end of the buffer or any invalid
+/// index causes the read to fail.
+class ModelCacheReader
+    {
+    public:
+        ModelCacheReader(char const *buf, size_t size):
+            mPos(buf), mEnd(buf + size), mOk(true)
+            {}
+        uint64_t readUnsigned();
+        int64_t readSigned()
+            {
+            uint64_t val = readUnsigned();
+            return static_cast<int64_t>(val >> 1) ^ -static_cast<int64_t>(val & 1);
+            }
+        /// Reads a count of items. Each item must take at least one byte.
+        size_t readCount();
+        /// Reads a value such as an enum that must not be above maxVal.
+        unsigned int readLimited(unsigned int maxVal);
+        std::string readString();
+        bool readStrings();
+        bool readModel(ModelData &model);
+        bool readFileContents(XmiFileContents &contents);
+        bool isOk() const
+            { return mOk; }
+        bool isAtEnd() const
+            { return(mPos == mEnd); }
+
+    private:
+        char const *mPos;
+        char const *mEnd;
+        bool mOk;
+        std::vector<OovString> mStrings;
+        std::vector<ModelType*> mTypes;
+        std::vector<ModelModule const*> mModules;
+
+        OovString const &readStringId();
+        ModelType *readTypeIndex();
+        ModelModule const *readModuleIndex();
+        void readTypeRef(ModelTypeRef &ref);
+        void readDeclarator(ModelDeclarator &decl);
+        std::unique_ptr<ModelOperation> readOperation();
+        void readClassifier(ModelClassifier &classifier);
+    };
+
+uint64_t ModelCacheReader::readUnsigned()
+    {
+    uint64_t val = 0;
+    int shift = 0;
+    bool more = true;
+    while(more && mOk)
+        {
+        if(mPos < mEnd && shift < 64)
+            {
+            unsigned char byte = static_cast<unsigned char>(*mPos++);
+            val |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            shift += 7;
+            more = (byte & 0x80) != 0;
+            }
+        else
+            {
+            mOk = false;
+            }
+        }
+    return val;
+    }
+
+size_t ModelCacheReader::readCount()
+    {
+    uint64_t count = readUnsigned();
+    if(count > static_cast<uint64_t>(mEnd - mPos))
+        {
+        mOk = false;
+        count = 0;
+        }
+    return static_cast<size_t>(count);
+    }
+
+unsigned int ModelCacheReader::readLimited(unsigned int maxVal)
+    {
+    uint64_t val = readUnsigned();
+    if(val > maxVal)
+        {
+        mOk = false;
+        val = 0;
+        }
+    return static_cast<unsigned int>(val);
+    }
+
+std::string ModelCacheReader::readString()
+    {
+    std::string str;
+    size_t len = readCount();
+    if(mOk)
+        {
+        str.assign(mPos, len);
+        mPos += len;
+        }
+    return str;
+    }
+
+bool ModelCacheReader::readStrings()
+    {
+    size_t numStrings = readCount();
+    mStrings.reserve(numStrings);
+    for(size_t i=0; i<numStrings && mOk; i++)
+        {
+        mStrings.push_back(readString());
+        }
+    return mOk;
+    }
+
+OovString const &ModelCacheReader::readStringId()
+    {
+    static OovString const emptyStr;
+    uint64_t id = readUnsigned();
+    if(id >= mStrings.size())
+        {
+        mOk = false;
+        }
+    return(mOk ? mStrings[static_cast<size_t>(id)] : emptyStr);
+    }
+
+ModelType *ModelCacheReader::readTypeIndex()
+    {
+    ModelType *type = nullptr;
+    uint64_t index = readUnsigned();
+    if(index > mTypes.size())
+        {
+        mOk = false;
+        }
+    else if(index != 0)
+        {
+        type = mTypes[static_cast<size_t>(index-1)];
+        }
+    return type;
+    }
+
+ModelModule const *ModelCacheReader::readModuleIndex()
+    {
+    ModelModule const *module = nullptr;
+    uint64_t index = readUnsigned();
+    if(index > mModules.size())
+        {
+        mOk = false;
+        }
+    else if(index != 0)
+        {
+        module = mModules[static_cast<size_t>(index-1)];
+        }
+    return module;
+    }
+
+void ModelCacheReader::readTypeRef(ModelTypeRef &ref)
+    {
+    ref.setDeclType(readTypeIndex());
+    ref.setDeclTypeModelId(static_cast<int>(readSigned()));
+    uint64_t flags = readUnsigned();
+    ref.setConst((flags & 1) != 0);
+    ref.setRefer((flags & 2) != 0);
+    }
+
+void ModelCacheReader::readDeclarator(ModelDeclarator &decl)
+    {
+    decl.setName(readStringId());
+    decl.setModelId(static_cast<int>(readSigned()));
+    readTypeRef(decl);
+    }
+
+std::unique_ptr<ModelOperation> ModelCacheReader::readOperation()
+    {
+    OovString const &name = readStringId();
+    int modelId = static_cast<int>(readSigned());
+    OovString const &overloadKey = readStringId();
+    Visibility access(static_cast<Visibility::VisType>(
+        readLimited(Visibility::Private)));
+    uint64_t flags = readUnsigned();
+    /// @todo - use make_unique when supported.
+    std::unique_ptr<ModelOperation> oper(new ModelOperation(name, access,
+        (flags & 1) != 0, (flags & 2) != 0));
+    oper->setModelId(modelId);
+    oper->setOverloadKeyFromKey(overloadKey);
+    oper->setModule(readModuleIndex());
+    oper->setLineNum(static_cast<unsigned int>(readUnsigned()));
+    readTypeRef(oper->getReturnType());
+    size_t numParams = readCount();
+    for(size_t i=0; i<numParams && mOk; i++)
+        {
+        std::unique_ptr<ModelFuncParam> param(new ModelFuncParam("", nullptr));
+        readDeclarator(*param);
+        oper->addMethodParameter(std::move(param));
+        }
+    size_t numVars = readCount();
+    for(size_t i=0; i<numVars && mOk; i++)
+        {
+        std::unique_ptr<ModelBodyVarDecl> var(new ModelBodyVarDecl("", nullptr));
+        readDeclarator(*var);
+        oper->addBodyVarDeclarator(std::move(var));
+        }
+    size_t numStmts = readCount();
+    ModelStatements &stmts = oper->getStatements();
+    stmts.reserve(numStmts);
+    for(size_t i=0; i<numStmts && mOk; i++)
+        {
+        eModelStatementTypes stmtType = static_cast<eModelStatementTypes>(
+            readLimited(ST_VarRef));
+        ModelStatement stmt(readStringId(), stmtType);
+        readTypeRef(stmt.getClassDecl());
+        readTypeRef(stmt.getVarDecl());
+        stmt.setVarAccessWrite(readUnsigned() != 0);
+        stmts.addStatement(stmt);
+        }
+    return oper;
+    }
+
+void ModelCacheReader::readClassifier(ModelClassifier &classifier)
+    {
+    classifier.setModule(readModuleIndex());
+    classifier.setLineNum(static_cast<unsigned int>(readUnsigned()));
+    size_t numAttrs = readCount();
+    for(size_t i=0; i<numAttrs && mOk; i++)
+        {
+        /// @todo - use make_unique when supported.
+        std::unique_ptr<ModelAttribute> attr(new ModelAttribute("", nullptr,
+            Visibility()));
+        readDeclarator(*attr);
+        attr->setAccess(Visibility(static_cast<Visibility::VisType>(
+            readLimited(Visibility::Private))));
+        classifier.addAttribute(std::move(attr));
+        }
+    size_t numOpers = readCount();
+    for(size_t i=0; i<numOpers && mOk; i++)
+        {
+        classifier.addOperation(readOperation());
+        }
+    }
+
+bool ModelCacheReader::readModel(ModelData &model)
+    {
+    size_t numModules = readCount();
+    for(size_t i=0; i<numModules && mOk; i++)
+        {
+        ModelModule *module = new ModelModule();
+        /// @todo - use make_unique when supported.
+        model.mModules.push_back(std::unique_ptr<ModelModule>(module));
+        module->setModulePath(readStringId());
+        module->setModelId(static_cast<int>(readSigned()));
+        module->mLineStats.mNumCodeLines = static_cast<unsigned int>(readUnsigned());
+        module->mLineStats.mNumCommentLines = static_cast<unsigned int>(readUnsigned());
+        module->mLineStats.mNumModuleLines = static_cast<unsigned int>(readUnsigned());
+        mModules.push_back(module);
+        }
+    size_t numTypes = readCount();
+    mTypes.reserve(numTypes);
+    for(size_t i=0; i<numTypes && mOk; i++)
+        {
+        ModelType *type = nullptr;
+        unsigned int dataType = readLimited(DT_Class);
+        OovString const &name = readStringId();
+        if(dataType == DT_Class)
+            {
+            type = new ModelClassifier(name);
+            }
+        else
+            {
+            type = new ModelType(name);
+            }
+        type->setModelId(static_cast<int>(readSigned()));
+        /// @todo - use make_unique when supported.
+        model.addType(std::unique_ptr<ModelType>(type));
+        mTypes.push_back(type);
+        }
+    for(size_t i=0; i<mTypes.size() && mOk; i++)
+        {
+        ModelClassifier *classifier = ModelClassifier::getClass(mTypes[i]);
+        if(classifier)
+            {
+            readClassifier(*classifier);
+            }
+        }
+    size_t numAssocs = readCount();
+    for(size_t i=0; i<numAssocs && mOk; i++)
+        {
+        ModelClassifier const *child = ModelClassifier::getClass(readTypeIndex());
+        ModelClassifier const *parent = ModelClassifier::getClass(readTypeIndex());
+        ModelAssociation *assoc = new ModelAssociation(child, parent,
+            Visibility());
+        /// @todo - use make_unique when supported.
+        model.mAssociations.push_back(std::unique_ptr<ModelAssociation>(assoc));
+        assoc->setChildModelId(static_cast<int>(readSigned()));
+        assoc->setParentModelId(static_cast<int>(readSigned()));
+        assoc->setAccess(Visibility(static_cast<Visibility::VisType>(
+            readLimited(Visibility::Private))));
+        assoc->setModule(readModuleIndex());
+        }
+    return mOk;
+    }
+
+bool ModelCacheReader::readFileContents(XmiFileContents &contents)
+    {
+    contents.mModule = readModuleIndex();
+    size_t numNames = readCount();
+    contents.mTypeNames.reserve(numNames);
+    for(size_t i=0; i<numNames && mOk; i++)
+        {
+        contents.mTypeNames.push_back(readStringId());
+        }
+    return mOk;
+    }
+
+
+OovStatusReturn ModelCache::readFileStamps(std::vector<std::string> const &xmiFileNames)
+    {
+    OovStatus status(true, SC_File);
+    mFileStamps.clear();
+    for(auto const &fn : xmiFileNames)
+        {
+        time_t modifyTime = 0;
+        status = FileGetFileTime(fn, modifyTime);
+        if(!status.ok())
+            {
+            break;
+            }
+        mFileStamps.push_back(FileStamp(fn, modifyTime));
+        }
+    return status;
+    }
+
+bool ModelCache::load(OovStringRef const cacheFn, ModelData &model)
+    {
+    bool loaded = false;
+    File file;
+    OovStatus status = file.open(cacheFn, "rb");
+    int size = 0;
+    if(status.ok())
+        {
+        status = file.getFileSize(size);
+        }
+    std::vector<char> buf;
+    if(status.ok() && size > 0)
+        {
+        buf.resize(static_cast<size_t>(size));
+        status = file.read(&buf[0], size);
+        }
+    if(status.ok() && buf.size() > 0)
+        {
+        ModelCacheReader reader(&buf[0], buf.size());
+        bool valid = (reader.readString() == sCacheSignature);
+        size_t numFiles = reader.readCount();
+        valid = valid && reader.isOk() && numFiles == mFileStamps.size();
+        for(size_t i=0; i<numFiles && valid; i++)
+            {
+            std::string fn = reader.readString();
+            time_t modifyTime = static_cast<time_t>(reader.readSigned());
+            valid = (reader.isOk() && fn == mFileStamps[i].mFileName &&
+                modifyTime == mFileStamps[i].mModifyTime);
+            }
+        if(valid)
+            {
+            model.clear();
+            loaded = reader.readStrings() && reader.readModel(model);
+            for(size_t i=0; i<mFileStamps.size() && loaded; i++)
+                {
+                loaded = reader.readFileContents(mFileStamps[i].mContents);
+                }
+            loaded = loaded && reader.isAtEnd();
+            if(loaded)
+                {
+                model.sortTypes();
+                model.indexTypeReferences();
+                }
+            }
+        }
+    if(!loaded)
+        {
+        model.clear();
+        }
+    if(status.needReport())
+        {
+        // The cache is optional, so a missing file is not an error.
+        status.reported();
+        }
+    return loaded;
+    }
+
+OovStatusReturn ModelCache::save(OovStringRef const cacheFn, ModelData const &model)
+    {
+    std::string buf;
+    appendString(buf, sCacheSignature);
+    appendUnsigned(buf, mFileStamps.size());
+    for(auto const &stamp : mFileStamps)
+        {
+        appendString(buf, stamp.mFileName);
+        appendSigned(buf, stamp.mModifyTime);
+        }
+    ModelCacheWriter writer(model);
+    writer.writeModel();
+    for(auto const &stamp : mFileStamps)
+        {
+        writer.writeFileContents(stamp.mContents);
+        }
+    appendUnsigned(buf, writer.getNumStrings());
+    buf += writer.getStrings();
+    buf += writer.getModelBuf();
+
+    // Write to a temporary file so that a partially written file is
+    // never used.
+    OovString tempFn = cacheFn;
+    tempFn += ".tmp";
+    File file;
+    OovStatus status = file.open(tempFn, "wb");
+    if(status.ok())
+        {
+        status = file.write(buf.data(), static_cast<int>(buf.size()));
+        file.close();
+        }
+    if(status.ok())
+        {
+        status = FileDelete(cacheFn);
+        }
+    if(status.ok())
+        {
+        status = FileRename(tempFn, cacheFn);
+        }
+    return status;
+    }
+
+void ModelCache::setFileContents(size_t fileIndex, XmiFileContents &contents)
+    {
+    // The stamps may not be complete if a file could not be read.
+    if(fileIndex < mFileStamps.size())
+        {
+        mFileStamps[fileIndex].mContents = std::move(contents);
+        }
+    }
+
+bool ModelCache::eraseChangedFiles(ModelCache const &loadedFiles,
+        ModelData &model, std::vector<size_t> &changedFileIndices)
+    {
+    changedFileIndices.clear();
+    std::unordered_map<std::string, FileStamp const*> loadedStamps;
+    std::unordered_map<ModelModule const*, FileStamp const*> moduleStamps;
+    for(auto const &stamp : loadedFiles.mFileStamps)
+        {
+        loadedStamps[stamp.mFileName] = &stamp;
+        if(stamp.mContents.mModule)
+            {
+            moduleStamps[stamp.mContents.mModule] = &stamp;
+            }
+        }
+    // The loaded files that are the same, and their index in this cache.
+    std::unordered_map<FileStamp const*, size_t> sameStamps;
+    for(size_t i=0; i<mFileStamps.size(); i++)
+        {
+        auto iter = loadedStamps.find(mFileStamps[i].mFileName);
+        if(iter != loadedStamps.end() &&
+                (*iter).second->mModifyTime == mFileStamps[i].mModifyTime)
+            {
+            sameStamps[(*iter).second] = i;
+            }
+        else
+            {
+            changedFileIndices.push_back(i);
+            }
+        }
+    std::unordered_set<ModelModule const*> erasedModules;
+    for(auto const &stamp : loadedFiles.mFileStamps)
+        {
+        if(sameStamps.find(&stamp) == sameStamps.end())
+            {
+            erasedModules.insert(stamp.mContents.mModule);
+            }
+        }
+    // An operation definition replaces the declaration from the file that
+    // defines the class, so that file is also loaded again in case the
+    // definition was removed.
+    for(auto const &type : model.mTypes)
+        {
+        ModelClassifier const *classifier = ModelClassifier::getClass(type.get());
+        if(classifier && classifier->getModule() &&
+                erasedModules.find(classifier->getModule()) == erasedModules.end())
+            {
+            auto const &opers = classifier->getOperations();
+            if(std::any_of(opers.begin(), opers.end(),
+                [&erasedModules](std::unique_ptr<ModelOperation> const &oper)
+                { return(erasedModules.find(oper->getModule()) != erasedModules.end()); }))
+                {
+                auto moduleIter = moduleStamps.find(classifier->getModule());
+                if(moduleIter != moduleStamps.end())
+                    {
+                    auto sameIter = sameStamps.find((*moduleIter).second);
+                    if(sameIter != sameStamps.end())
+                        {
+                        changedFileIndices.push_back((*sameIter).second);
+                        sameStamps.erase(sameIter);
+                        }
+                    }
+                }
+            }
+        }
+    // The files are loaded in the same order as when all files are loaded.
+    std::sort(changedFileIndices.begin(), changedFileIndices.end());
+    size_t numErasedFiles = loadedFiles.mFileStamps.size() - sameStamps.size();
+    // Loading all files uses all threads and does not need to erase
+    // anything, so it is used when most files changed.
+    bool update = (loadedFiles.mFileStamps.size() > 0 &&
+        (changedFileIndices.size() + numErasedFiles) * 2 <= mFileStamps.size());
+    if(update)
+        {
+        std::unordered_set<std::string> keptTypeNames;
+        for(auto const &same : sameStamps)
+            {
+            XmiFileContents const &contents = same.first->mContents;
+            mFileStamps[same.second].mContents = contents;
+            keptTypeNames.insert(contents.mTypeNames.begin(),
+                contents.mTypeNames.end());
+            }
+        std::vector<FileStamp const*> erasedStamps;
+        for(auto const &stamp : loadedFiles.mFileStamps)
+            {
+            if(sameStamps.find(&stamp) == sameStamps.end())
+                {
+                erasedStamps.push_back(&stamp);
+                if(stamp.mContents.mModule)
+                    {
+                    model.eraseModule(stamp.mContents.mModule);
+                    }
+                }
+            }
+        // The types are erased after all modules are erased, so that the
+        // objects from the erased modules do not refer to the types.
+        for(auto const &stamp : erasedStamps)
+            {
+            for(auto const &name : stamp->mContents.mTypeNames)
+                {
+                if(keptTypeNames.find(name) == keptTypeNames.end())
+                    {
+                    model.eraseUnreferencedType(name);
+                    }
+                }
+            }
+        }
+    else
+        {
+        changedFileIndices.clear();
+        }
+    return update;
+    }
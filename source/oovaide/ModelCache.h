@@ -0,0 +1,87 @@
+/*
+ * ModelCache.h
+ *
+ *  \copyright 2016 DCBlaha.  Distributed under the GPL.
+ */
+
+#ifndef MODELCACHE_H_
+#define MODELCACHE_H_
+
+#include "ModelObjects.h"
+#include "Xmi2Object.h"
+#include "OovError.h"
+#include <string>
+#include <vector>
+#include <time.h>
+
+/// This saves a resolved model in a binary file so that a project can be
+/// reopened without parsing the XMI files and resolving the model again.
+///
+/// The cache file contains the name and modify time of each XMI file that
+/// the model was loaded from. If any XMI file is added, removed or changed,
+/// the cache is not used. Strings are only stored once in the file, and
+/// references between objects are stored as indices.
+///
+/// The cache also keeps the objects that each XMI file added to the model,
+/// so that when some XMI files change, the objects of the old files can be
+/// erased, and only the changed files must be loaded.
+class ModelCache
+    {
+    public:
+        /// Get the modify times of the XMI files. This must be called before
+        /// the XMI files are loaded so that a file that changes while the
+        /// model is loaded makes the saved cache invalid.
+        /// @param xmiFileNames The XMI files that the model is loaded from.
+        OovStatusReturn readFileStamps(std::vector<std::string> const &xmiFileNames);
+
+        /// Load the model from the cache file. The model is only loaded if
+        /// the XMI files in the cache match the file stamps. The loaded
+        /// model is resolved. If the model is not loaded, it is cleared.
+        /// @param cacheFn The path of the cache file.
+        /// @param model The model to load.
+        bool load(OovStringRef const cacheFn, ModelData &model);
+
+        /// Save a resolved model and the file stamps to the cache file.
+        /// @param cacheFn The path of the cache file.
+        /// @param model The model to save.
+        OovStatusReturn save(OovStringRef const cacheFn, ModelData const &model);
+
+        /// Set the objects that an XMI file added to the model.
+        /// @param fileIndex The index of the file in the file stamps.
+        /// @param contents The objects that are moved from the file.
+        void setFileContents(size_t fileIndex, XmiFileContents &contents);
+
+        /// Erase the objects of the XMI files that were removed or changed
+        /// since the model was loaded, and get the files that must be
+        /// loaded to update the model. Types that are not in any other file
+        /// are also erased. This cache must have the current file stamps.
+        /// @param loadedFiles The files that the model was loaded from.
+        /// @param model The model to update.
+        /// @param changedFileIndices The returned indices of the files that
+        ///     are new or changed.
+        /// Returns false if the model was not changed, because the model
+        /// was not loaded, or because so many files changed that it is
+        /// better to load all files.
+        bool eraseChangedFiles(ModelCache const &loadedFiles, ModelData &model,
+            std::vector<size_t> &changedFileIndices);
+
+        size_t getNumFiles() const
+            { return mFileStamps.size(); }
+
+        void clear()
+            { mFileStamps.clear(); }
+
+    private:
+        struct FileStamp
+            {
+            FileStamp(std::string const &fileName, time_t modifyTime):
+                mFileName(fileName), mModifyTime(modifyTime)
+                {}
+            std::string mFileName;
+            time_t mModifyTime;
+            XmiFileContents mContents;
+            };
+        std::vector<FileStamp> mFileStamps;
+    };
+
+#endif /* MODELCACHE_H_ */
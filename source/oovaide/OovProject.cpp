@@ -13,6 +13,7 @@
 #include "BuildConfigReader.h"
 #include "DirList.h"
 #include "Xmi2Object.h"
+#include "ModelCache.h"
 #include "Debug.h"
 #include "OovError.h"
 
@@ -177,6 +178,18 @@ bool OovProject::clearAnalysis()
         logProj(" clearAnalysis");
         mProjectStatus.mAnalysisStatus = ProjectStatus::AS_UnLoaded;
         mModelData.clear();
+        mLoadedFiles.clear();
+        }
+    return started;
+    }
+
+bool OovProject::unloadAnalysis()
+    {
+    bool started = isProjectIdle();
+    if(started)
+        {
+        logProj(" unloadAnalysis");
+        mProjectStatus.mAnalysisStatus = ProjectStatus::AS_UnLoaded;
         }
     return started;
     }
@@ -216,58 +229,67 @@ void OovProject::processAnalysisFiles()
     {
     logProj("+processAnalysisFiles");
     mProjectStatus.mAnalysisStatus |= ProjectStatus::AS_Loading;
+    // The loaded files are only kept if the model is completely loaded.
+    ModelCache loadedFiles = std::move(mLoadedFiles);
+    mLoadedFiles.clear();
     std::vector<std::string> fileNames;
     BuildConfigReader buildConfig;
     OovStatus status = getDirListMatchExt(buildConfig.getAnalysisPath(),
         FilePath(".xmi", FP_File), fileNames);
     if(status.ok())
         {
-        int typeIndex = 0;
-        OovTaskStatusListenerId taskId = 0;
-        if(mStatusListener)
+        FilePath cacheFn(buildConfig.getAnalysisPath(), FP_Dir);
+        cacheFn.appendFile(Project::getAnalysisModelCacheFilename());
+        ModelCache cache;
+        OovStatus cacheStatus = cache.readFileStamps(fileNames);
+        bool useCache = cacheStatus.ok();
+        if(cacheStatus.needReport())
             {
-            taskId = mStatusListener->startTask("Loading files.", fileNames.size());
+            // The cache is optional, so just load the XMI files.
+            cacheStatus.reported();
             }
-        // The continueProcessingItem is from the ThreadedWorkBackgroundQueue,
-        // and is set false when stopAndWaitForCompletion() is called.
-        for(size_t i=0; i<fileNames.size() && continueProcessingItem(); i++)
+        std::vector<size_t> changedFileIndices;
+        bool saveCache = false;
+        // The type indices of loaded files keep increasing, so the model
+        // is loaded again before they reach the fragment indices.
+        if(useCache && XmiFilesLoader::getNextTypeIndex(mModelData) <
+                XmiFragmentTypeIndexBase / 2 &&
+                cache.eraseChangedFiles(loadedFiles, mModelData, changedFileIndices))
             {
-            OovString fileText = "File ";
-            fileText.appendInt(i);
-            fileText += ": ";
-            fileText += fileNames[i];
-            if(mStatusListener && !mStatusListener->updateProgressIteration(
-                    taskId, i, fileText))
+            saveCache = (changedFileIndices.size() > 0 ||
+                cache.getNumFiles() != loadedFiles.getNumFiles());
+            if(saveCache)
                 {
-                break;
-                }
-            File file;
-            OovStatus status = file.open(fileNames[i], "r");
-            if(status.ok())
-                {
-                loadXmiFile(file, mModelData, fileNames[i], typeIndex);
-                }
-            if(status.needReport())
-                {
-                OovString err = "Unable to read XMI file ";
-                err += fileNames[i];
-                status.report(ET_Error, err);
+                loadXmiFiles(fileNames, changedFileIndices, cache);
                 }
+    logProj(" processAnalysisFiles - updated");
             }
-    logProj(" processAnalysisFiles - loaded");
-        if(continueProcessingItem())
+        else if(useCache && cache.load(cacheFn, mModelData))
             {
-            if(mStatusListener)
+    logProj(" processAnalysisFiles - loaded cache");
+            }
+        else
+            {
+            mModelData.clear();
+            std::vector<size_t> fileIndices(fileNames.size());
+            for(size_t i=0; i<fileIndices.size(); i++)
                 {
-                taskId = mStatusListener->startTask("Resolving Model.", 100);
+                fileIndices[i] = i;
                 }
-            mModelData.resolveModelIds();
-    logProj(" processAnalysisFiles - resolved");
-            if(mStatusListener)
+            loadXmiFiles(fileNames, fileIndices, cache);
+            saveCache = true;
+            }
+        if(continueProcessingItem() && useCache)
+            {
+            if(saveCache)
                 {
-                mStatusListener->updateProgressIteration(taskId, 50, nullptr);
-                mStatusListener->endTask(taskId);
+                cacheStatus = cache.save(cacheFn, mModelData);
+                if(cacheStatus.needReport())
+                    {
+                    cacheStatus.report(ET_Error, "Unable to save model cache");
+                    }
                 }
+            mLoadedFiles = std::move(cache);
             }
         }
     if(status.needReport())
@@ -280,6 +302,54 @@ void OovProject::processAnalysisFiles()
     logProj("-processAnalysisFiles");
     }
 
+void OovProject::loadXmiFiles(std::vector<std::string> const &fileNames,
+        std::vector<size_t> const &fileIndices, ModelCache &files)
+    {
+    std::vector<std::string> loadFileNames;
+    loadFileNames.reserve(fileIndices.size());
+    for(auto const &fileIndex : fileIndices)
+        {
+        loadFileNames.push_back(fileNames[fileIndex]);
+        }
+    OovTaskStatusListenerId taskId = 0;
+    if(mStatusListener)
+        {
+        taskId = mStatusListener->startTask("Loading files.", loadFileNames.size());
+        }
+    // The files are parsed on multiple threads, and merged into the
+    // model in file name order.
+    XmiFilesLoader loader(mModelData);
+    loader.loadFiles(loadFileNames, [this, &loadFileNames, &fileIndices, &files,
+        taskId](size_t fileIndex, XmiFileContents &contents)
+        {
+        files.setFileContents(fileIndices[fileIndex], contents);
+        OovString fileText = "File ";
+        fileText.appendInt(fileIndex);
+        fileText += ": ";
+        fileText += loadFileNames[fileIndex];
+        // The continueProcessingItem is from the ThreadedWorkBackgroundQueue,
+        // and is set false when stopAndWaitForCompletion() is called.
+        return(continueProcessingItem() && (!mStatusListener ||
+            mStatusListener->updateProgressIteration(taskId, fileIndex,
+            fileText)));
+        }, XmiFilesLoader::getNumHardwareThreads());
+    logProj(" processAnalysisFiles - loaded");
+    if(continueProcessingItem())
+        {
+        if(mStatusListener)
+            {
+            taskId = mStatusListener->startTask("Resolving Model.", 100);
+            }
+        mModelData.resolveModelIds();
+    logProj(" processAnalysisFiles - resolved");
+        if(mStatusListener)
+            {
+            mStatusListener->updateProgressIteration(taskId, 50, nullptr);
+            mStatusListener->endTask(taskId);
+            }
+        }
+    }
+
 static OovString makeBuildConfigArgName(OovStringRef const baseName,
         OovStringRef const buildConfig)
     {
@@ -10,6 +10,7 @@
 
 #include "OovString.h"
 #include "ModelObjects.h"
+#include "ModelCache.h"
 #include "IncludeMap.h"
 #include "Project.h"
 #include "Options.h"
@@ -103,8 +104,15 @@ class OovProject:public ThreadedWorkBackgroundQueue<OovProject, ProjectBackgroun
         /// @return false if analysis is being loaded.
         bool clearAnalysis();
 
+        /// Indicates that the analysis is not loaded, but keeps the model
+        /// so that loadAnalysisFiles() only loads the XMI files that
+        /// changed. The model must not be used until it is loaded again.
+        /// @return false if analysis is being loaded.
+        bool unloadAnalysis();
+
         /// This loads the files on a backgroundThread. Use getStatus to see
-        /// when the loading is complete.
+        /// when the loading is complete. If the model is still loaded from
+        /// the XMI files, only the changed XMI files are loaded.
         /// @return false if analysis is being loaded.
         bool loadAnalysisFiles();
 
@@ -144,9 +152,18 @@ class OovProject:public ThreadedWorkBackgroundQueue<OovProject, ProjectBackgroun
         ModelData mModelData;
         IncDirDependencyMapReader mIncludeMap;
         OovBackgroundPipeProcess mBackgroundProc;
+        /// The XMI files that the model was loaded from. This is empty if
+        /// the model is not completely loaded.
+        ModelCache mLoadedFiles;
 
         // Called from ThreadedWorkBackgroundQueue through processItem.
         void processAnalysisFiles();
+        /// Load XMI files and resolve the model.
+        /// @param fileNames All of the XMI files.
+        /// @param fileIndices The indices of the files to load.
+        /// @param files Set to the objects that each file added to the model.
+        void loadXmiFiles(std::vector<std::string> const &fileNames,
+            std::vector<size_t> const &fileIndices, ModelCache &files);
         void loadIncludeMap();
     };
 
@@ -263,6 +263,12 @@ void oovGui::clearAnalysis()
     updateGuiForProjectChange();
     }
 
+void oovGui::unloadAnalysis()
+    {
+    mContexts.unloadAnalysis();
+    updateGuiForProjectChange();
+    }
+
 bool oovGui::canStartAnalysis()
     {
     bool success = mProject.isProjectIdle();
@@ -321,7 +327,7 @@ gboolean oovGui::onBackgroundIdle(gpointer data)
     bool didSomething = mWindowBuildListener.onBackgroundProcessIdle(complete);
     if(complete)
         {
-        clearAnalysis();
+        unloadAnalysis();
         mContexts.updateContextAfterAnalysisCompletes();
         didSomething = true;
         }
@@ -184,6 +184,7 @@ class oovGui:public OovErrorListener, private GlobalSettingsListener
         ProjectStatus const &getLastProjectStatus() const
             { return mLastProjectStatus; }
         void clearAnalysis();
+        void unloadAnalysis();
         bool canStartAnalysis();
     };
 
@@ -0,0 +1,91 @@
+// TestArchiveSymbols.cpp
+
+#include "TestCpp.h"
+#include "../../oovBuilder/ArchiveSymbols.h"
+#include <stdio.h>
+#include <algorithm>
+
+class ArchiveSymbolsUnitTest:public TestCppModule
+    {
+    public:
+        ArchiveSymbolsUnitTest():
+            TestCppModule("ArchiveSymbols")
+            {}
+    };
+
+static ArchiveSymbolsUnitTest gArchiveSymbolsUnitTest;
+
+// The archive was made with "ar rcD" from two objects compiled by gcc for
+// x86-64. The long object name uses the GNU long name table.
+//    archiveSymbolsFirst.o - defines firstData and firstFunc, uses secondFunc,
+//                            and has the static function firstLocal.
+//    second.o - defines secondFunc.
+static char const *ArchiveFn = "ArchiveSymbolsIn/libArchiveSymbols.a";
+
+static bool hasSymbol(OovStringVec const &syms, char const *name)
+    {
+    return(std::find(syms.begin(), syms.end(), OovString(name)) != syms.end());
+    }
+
+// Writes the first part of the archive to a file.
+static bool writeTruncatedArchive(char const *fn, size_t size)
+    {
+    bool success = false;
+    FILE *inFp = fopen(ArchiveFn, "rb");
+    if(inFp)
+        {
+        std::vector<char> buf(size);
+        size_t readSize = fread(&buf[0], 1, size, inFp);
+        fclose(inFp);
+        FILE *outFp = fopen(fn, "wb");
+        if(outFp)
+            {
+            success = (readSize == size &&
+                fwrite(&buf[0], 1, size, outFp) == size);
+            fclose(outFp);
+            }
+        }
+    return success;
+    }
+
+TEST_F(gArchiveSymbolsUnitTest, ArchiveSymbolsReadTest)
+    {
+    ArchiveSymbols syms;
+    EXPECT_EQ(syms.read(ArchiveFn), true);
+    EXPECT_EQ(syms.mDefinedSymbols.size() == 3, true);
+    EXPECT_EQ(hasSymbol(syms.mDefinedSymbols, "firstData"), true);
+    EXPECT_EQ(hasSymbol(syms.mDefinedSymbols, "firstFunc"), true);
+    EXPECT_EQ(hasSymbol(syms.mDefinedSymbols, "secondFunc"), true);
+    EXPECT_EQ(hasSymbol(syms.mDefinedSymbols, "firstLocal"), false);
+    EXPECT_EQ(syms.mUndefinedSymbols.size() == 1, true);
+    EXPECT_EQ(hasSymbol(syms.mUndefinedSymbols, "secondFunc"), true);
+    }
+
+// An archive that ends inside of an object must not be used, since some
+// symbols would be missing.
+TEST_F(gArchiveSymbolsUnitTest, ArchiveSymbolsTruncatedTest)
+    {
+    char const *fn = "TestArchiveSymbolsTruncated.a";
+    EXPECT_EQ(writeTruncatedArchive(fn, 1000), true);
+    ArchiveSymbols syms;
+    EXPECT_EQ(syms.read(fn), false);
+    EXPECT_EQ(syms.mDefinedSymbols.size() == 0, true);
+    EXPECT_EQ(syms.mUndefinedSymbols.size() == 0, true);
+    remove(fn);
+    }
+
+// Files that are not archives or ELF files must be read by the object
+// symbol tool.
+TEST_F(gArchiveSymbolsUnitTest, ArchiveSymbolsNotElfTest)
+    {
+    char const *fn = "TestArchiveSymbolsNotElf.lib";
+    FILE *fp = fopen(fn, "w");
+    if(fp)
+        {
+        fputs("This is not a library\n", fp);
+        fclose(fp);
+        }
+    ArchiveSymbols syms;
+    EXPECT_EQ(syms.read(fn), false);
+    remove(fn);
+    }
@@ -0,0 +1,119 @@
+// TestClassForceLayout.cpp
+
+#include "TestCpp.h"
+#include "../../oovaide/BLL/ClassForceLayout.h"
+
+class ClassForceLayoutUnitTest:public TestCppModule
+    {
+    public:
+        ClassForceLayoutUnitTest():
+            TestCppModule("ClassForceLayout")
+            {}
+    };
+
+static ClassForceLayoutUnitTest gClassForceLayoutUnitTest;
+
+class LayoutContinueListener:public OovTaskContinueListener
+    {
+    public:
+        virtual bool continueProcessingItem() const override
+            { return true; }
+    };
+
+static bool isOverlapping(std::vector<GraphPoint> const &positions,
+        std::vector<GraphSize> const &sizes)
+    {
+    bool overlap = false;
+    for(size_t n1=0; n1<positions.size(); n1++)
+        {
+        for(size_t n2=n1+1; n2<positions.size(); n2++)
+            {
+            GraphPoint const &p1 = positions[n1];
+            GraphPoint const &p2 = positions[n2];
+            if(p1.x < p2.x + sizes[n2].x && p2.x < p1.x + sizes[n1].x &&
+                p1.y < p2.y + sizes[n2].y && p2.y < p1.y + sizes[n1].y)
+                {
+                overlap = true;
+                }
+            }
+        }
+    return overlap;
+    }
+
+// None of the nodes have positions, so all nodes are placed.
+TEST_F(gClassForceLayoutUnitTest, ClassForceLayoutOverlapTest)
+    {
+    size_t const numNodes = 12;
+    std::vector<GraphPoint> positions(numNodes);
+    std::vector<GraphSize> sizes;
+    std::vector<bool> hasPositions(numNodes, false);
+    std::vector<std::pair<int, int>> connections;
+    for(size_t ni=0; ni<numNodes; ni++)
+        {
+        sizes.push_back(GraphSize(40 + static_cast<int>(ni % 4) * 20,
+            30 + static_cast<int>(ni % 3) * 15));
+        if(ni > 0)
+            {
+            connections.push_back(std::make_pair(static_cast<int>(ni/2),
+                static_cast<int>(ni)));
+            }
+        }
+    ClassForceLayout layout;
+    LayoutContinueListener contListener;
+    layout.initialize(positions, sizes, hasPositions, connections, 60);
+    layout.updatePositions(nullptr, contListener);
+    std::vector<GraphPoint> newPositions = layout.getPositions();
+    EXPECT_EQ(newPositions.size() == numNodes, true);
+    EXPECT_EQ(isOverlapping(newPositions, sizes), false);
+    bool allPositive = true;
+    for(auto const &pos : newPositions)
+        {
+        if(pos.x < 0 || pos.y < 0)
+            {
+            allPositive = false;
+            }
+        }
+    EXPECT_EQ(allPositive, true);
+    }
+
+// Some nodes have positions, and new nodes are connected to them. Check
+// that only the new nodes are moved, and that they do not overlap.
+TEST_F(gClassForceLayoutUnitTest, ClassForceLayoutFixedTest)
+    {
+    std::vector<GraphPoint> positions;
+    std::vector<GraphSize> sizes;
+    std::vector<bool> hasPositions;
+    for(int row=0; row<2; row++)
+        {
+        for(int col=0; col<3; col++)
+            {
+            positions.push_back(GraphPoint(200 + col * 120, 200 + row * 100));
+            sizes.push_back(GraphSize(80, 50));
+            hasPositions.push_back(true);
+            }
+        }
+    std::vector<std::pair<int, int>> connections = { {0, 1}, {1, 2}, {3, 4} };
+    for(int ni=0; ni<4; ni++)
+        {
+        positions.push_back(GraphPoint(0, 0));
+        sizes.push_back(GraphSize(60, 40));
+        hasPositions.push_back(false);
+        connections.push_back(std::make_pair(ni, 6 + ni));
+        }
+    ClassForceLayout layout;
+    LayoutContinueListener contListener;
+    layout.initialize(positions, sizes, hasPositions, connections, 60);
+    layout.updatePositions(nullptr, contListener);
+    std::vector<GraphPoint> newPositions = layout.getPositions();
+    EXPECT_EQ(newPositions.size() == positions.size(), true);
+    bool fixedSame = true;
+    for(size_t ni=0; ni<6; ni++)
+        {
+        if(!(newPositions[ni] == positions[ni]))
+            {
+            fixedSame = false;
+            }
+        }
+    EXPECT_EQ(fixedSame, true);
+    EXPECT_EQ(isOverlapping(newPositions, sizes), false);
+    }
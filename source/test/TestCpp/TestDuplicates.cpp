@@ -0,0 +1,258 @@
+// TestDuplicates.cpp
+
+#include "TestCpp.h"
+#include "../../oovaide/BLL/Duplicates.h"
+#include "../../oovCommon/Project.h"
+#include "../../oovCommon/FilePath.h"
+#include "../../oovCommon/OovError.h"
+#include "../../oovCppParser/DupHashFile.h"
+#include <stdio.h>
+#include <atomic>
+
+class DuplicatesUnitTest:public TestCppModule
+    {
+    public:
+        DuplicatesUnitTest():
+            TestCppModule("Duplicates")
+            {}
+    };
+
+static DuplicatesUnitTest gDuplicatesUnitTest;
+
+// Writes a text hash file into the dups directory of the project. Each hash
+// is on a separate line.
+static void writeHashFile(OovStringRef const projDir, OovStringRef const fn,
+        std::vector<unsigned> const &hashes)
+    {
+    FilePath path(projDir, FP_Dir);
+    path.appendDir(DupsDir);
+    OovStatus status = FileEnsurePathExists(path);
+    path.appendFile(fn);
+    FILE *fp = status.ok() ? fopen(path.getStr(), "w") : nullptr;
+    if(fp)
+        {
+        for(size_t i=0; i<hashes.size(); i++)
+            {
+            fprintf(fp, "%x %u\n", hashes[i], static_cast<unsigned>(i+1));
+            }
+        fclose(fp);
+        }
+    }
+
+// Counts the errors, such as hash files that cannot be read. The hash files
+// are read by many threads.
+class HashErrorListener:public OovErrorListener
+    {
+    public:
+        HashErrorListener():
+            mNumErrors(0)
+            {}
+        virtual void errorListener(OovStringRef str, OovErrorTypes et) override
+            {
+            if(et == ET_Error)
+                {
+                mNumErrors++;
+                }
+            fprintf(stderr, "%s", str.getStr());
+            }
+        std::atomic<int> mNumErrors;
+    };
+
+static HashErrorListener sHashErrorListener;
+
+static FilePath getHashFilePath(OovStringRef const projDir, OovStringRef const fn)
+    {
+    FilePath path(projDir, FP_Dir);
+    path.appendDir(DupsDir);
+    OovStatus status = FileEnsurePathExists(path);
+    if(status.needReport())
+        {
+        status.report(ET_Error, "Unable to make test dups directory");
+        }
+    path.appendFile(fn);
+    return path;
+    }
+
+// Writes a binary hash file in the same way as the parser. The statements
+// are a single function that starts at the line.
+static void writeBinaryHashFile(OovStringRef const projDir, OovStringRef const fn,
+        OovStringVec const &statements, unsigned int startLine)
+    {
+    DupHashFile file;
+    file.open(getHashFilePath(projDir, fn));
+    for(size_t i=0; i<statements.size(); i++)
+        {
+        file.append(statements[i], startLine + static_cast<unsigned int>(i));
+        }
+    file.appendBreak();
+    file.close();
+    }
+
+// Copies a file, but changes the size of the copy.
+static void copyResizedFile(OovStringRef const srcFn, OovStringRef const destFn,
+        size_t newSize)
+    {
+    std::vector<char> data(newSize, 0);
+    FILE *srcFp = fopen(srcFn.getStr(), "rb");
+    if(srcFp)
+        {
+        size_t readSize = fread(&data[0], 1, newSize, srcFp);
+        (void)readSize;     // The remainder is zero if the copy is larger.
+        fclose(srcFp);
+        }
+    FILE *destFp = fopen(destFn.getStr(), "wb");
+    if(destFp)
+        {
+        fwrite(&data[0], 1, newSize, destFp);
+        fclose(destFp);
+        }
+    }
+
+// Two files that have the same ten items in different places.
+// Check that a single duplicate is found.
+TEST_F(gDuplicatesUnitTest, DuplicatesTwoFilesTest)
+    {
+    std::vector<unsigned> hashes1 = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+    std::vector<unsigned> hashes2 = { 20, 21, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+    writeHashFile("TestDupsTwoFiles", "a_dcpp.hsh", hashes1);
+    writeHashFile("TestDupsTwoFiles", "b_dcpp.hsh", hashes2);
+    Project::setProjectDirectory("TestDupsTwoFiles");
+
+    DuplicateOptions options;
+    std::vector<DuplicateLineInfo> dupLineInfo;
+    EXPECT_EQ(getDuplicateLineInfo(options, dupLineInfo), true);
+    EXPECT_EQ(dupLineInfo.size() == 1, true);
+    if(dupLineInfo.size() == 1)
+        {
+        EXPECT_EQ(dupLineInfo[0].mTotalDupLines == 10, true);
+        // The order of the files depends on the directory list.
+        DuplicateLineInfo const &info = dupLineInfo[0];
+        int line1 = (info.mFile1 == "a.cpp") ? info.mFile1StartLine :
+            info.mFile2StartLine;
+        int line2 = (info.mFile1 == "a.cpp") ? info.mFile2StartLine :
+            info.mFile1StartLine;
+        EXPECT_EQ(line1 == 2, true);
+        EXPECT_EQ(line2 == 3, true);
+        }
+    }
+
+// Two files that start with the same items, then repeat the start of the
+// duplicate many times. Check that the repeated items do not prevent finding
+// the longer duplicate between the files.
+TEST_F(gDuplicatesUnitTest, DuplicatesRepeatedPrefixTest)
+    {
+    std::vector<unsigned> prefix = { 1, 2, 3, 4, 5 };
+    std::vector<unsigned> dupEnd = { 50, 51, 52, 53, 54, 55 };
+    std::vector<unsigned> hashes1 = prefix;
+    hashes1.insert(hashes1.end(), dupEnd.begin(), dupEnd.end());
+    std::vector<unsigned> hashes2 = hashes1;
+    for(unsigned i=0; i<10; i++)
+        {
+        hashes1.push_back(100 + i);
+        hashes1.insert(hashes1.end(), prefix.begin(), prefix.end());
+        hashes2.push_back(200 + i);
+        hashes2.insert(hashes2.end(), prefix.begin(), prefix.end());
+        }
+    writeHashFile("TestDupsRepeatedPrefix", "a_dcpp.hsh", hashes1);
+    writeHashFile("TestDupsRepeatedPrefix", "b_dcpp.hsh", hashes2);
+    Project::setProjectDirectory("TestDupsRepeatedPrefix");
+
+    DuplicateOptions options;
+    std::vector<DuplicateLineInfo> dupLineInfo;
+    EXPECT_EQ(getDuplicateLineInfo(options, dupLineInfo), true);
+    bool foundDup = false;
+    for(auto const &info : dupLineInfo)
+        {
+        if(info.mFile1 != info.mFile2 && info.mTotalDupLines == 11)
+            {
+            foundDup = (info.mFile1StartLine == 1 &&
+                info.mFile2StartLine == 1);
+            }
+        }
+    EXPECT_EQ(foundDup, true);
+    }
+
+// A file where every item is the same, so every place has the same hash
+// sequence. Check that the number of duplicates is not the square of the
+// number of items, and that it does not take long.
+TEST_F(gDuplicatesUnitTest, DuplicatesRepetitiveTest)
+    {
+    std::vector<unsigned> hashes(20000, 5);
+    writeHashFile("TestDupsRepetitive", "a_dcpp.hsh", hashes);
+    Project::setProjectDirectory("TestDupsRepetitive");
+
+    DuplicateOptions options;
+    std::vector<DuplicateLineInfo> dupLineInfo;
+    TestTime startTime;
+    startTime.getCurrentTime();
+    EXPECT_EQ(getDuplicateLineInfo(options, dupLineInfo), true);
+    TestTime endTime;
+    endTime.getCurrentTime();
+    EXPECT_EQ(dupLineInfo.size() > 0, true);
+    EXPECT_EQ(dupLineInfo.size() <= 8, true);
+    EXPECT_EQ(endTime.elapsedSecondsSinceStart(startTime) < 5, true);
+    func.mParentModule.addExtraDiagnostics("Repetitive dups seconds",
+        endTime.elapsedSecondsSinceStart(startTime));
+    }
+
+// Binary hash files written by the parser, and a file without any items.
+// Check that the files are read without errors and that the duplicate
+// has the line numbers that were written.
+TEST_F(gDuplicatesUnitTest, DuplicatesBinaryFileTest)
+    {
+    OovError::setListener(&sHashErrorListener);
+    sHashErrorListener.mNumErrors = 0;
+    OovStringVec statements = { "int a = 1", "int b = a", "b++", "a = b * 2",
+        "func(a, b)", "return a" };
+    writeBinaryHashFile("TestDupsBinary", "a_dcpp.hsh", statements, 10);
+    OovStringVec statements2 = statements;
+    statements2.insert(statements2.begin(), "int c = 5");
+    writeBinaryHashFile("TestDupsBinary", "b_dcpp.hsh", statements2, 19);
+    writeBinaryHashFile("TestDupsBinary", "c_dcpp.hsh", OovStringVec(), 1);
+    Project::setProjectDirectory("TestDupsBinary");
+
+    DuplicateOptions options;
+    std::vector<DuplicateLineInfo> dupLineInfo;
+    EXPECT_EQ(getDuplicateLineInfo(options, dupLineInfo), true);
+    EXPECT_EQ(sHashErrorListener.mNumErrors == 0, true);
+    EXPECT_EQ(dupLineInfo.size() == 1, true);
+    if(dupLineInfo.size() == 1)
+        {
+        DuplicateLineInfo const &info = dupLineInfo[0];
+        EXPECT_EQ(info.mTotalDupLines == 6, true);
+        int line1 = (info.mFile1 == "a.cpp") ? info.mFile1StartLine :
+            info.mFile2StartLine;
+        int line2 = (info.mFile1 == "a.cpp") ? info.mFile2StartLine :
+            info.mFile1StartLine;
+        EXPECT_EQ(line1 == 10, true);
+        EXPECT_EQ(line2 == 20, true);
+        }
+    }
+
+// Binary hash files where the size does not match the number of items.
+// Check that an error is reported for each file, and that the items are
+// not used.
+TEST_F(gDuplicatesUnitTest, DuplicatesBadBinaryFileTest)
+    {
+    OovError::setListener(&sHashErrorListener);
+    sHashErrorListener.mNumErrors = 0;
+    OovStringVec statements = { "int a = 1", "int b = a", "b++", "a = b * 2",
+        "func(a, b)", "return a" };
+    FilePath goodFn = getHashFilePath("TestDupsBadBinary", "a_dcpp.hsh");
+    writeBinaryHashFile("TestDupsBadBinary", "a_dcpp.hsh", statements, 10);
+    // The header, six items and a break.
+    size_t goodSize = DupsHashFileIdSize + 8 + 7 * (8 + 4);
+    copyResizedFile(goodFn, getHashFilePath("TestDupsBadBinary", "b_dcpp.hsh"),
+        goodSize - 4);
+    copyResizedFile(goodFn, getHashFilePath("TestDupsBadBinary", "c_dcpp.hsh"),
+        goodSize + 4);
+    copyResizedFile(goodFn, getHashFilePath("TestDupsBadBinary", "d_dcpp.hsh"),
+        DupsHashFileIdSize + 4);
+    Project::setProjectDirectory("TestDupsBadBinary");
+
+    DuplicateOptions options;
+    std::vector<DuplicateLineInfo> dupLineInfo;
+    EXPECT_EQ(getDuplicateLineInfo(options, dupLineInfo), true);
+    EXPECT_EQ(sHashErrorListener.mNumErrors == 3, true);
+    EXPECT_EQ(dupLineInfo.size() == 0, true);
+    }
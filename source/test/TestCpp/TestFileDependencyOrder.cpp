@@ -0,0 +1,60 @@
+// TestFileDependencyOrder.cpp
+
+#include "TestCpp.h"
+#include "../../oovBuilder/FileDependencyOrder.h"
+#include <algorithm>
+
+class FileDependencyOrderUnitTest:public TestCppModule
+    {
+    public:
+        FileDependencyOrderUnitTest():
+            TestCppModule("FileDependencyOrder")
+            {}
+    };
+
+static FileDependencyOrderUnitTest gFileDependencyOrderUnitTest;
+
+static size_t getPos(FileIndices const &order, size_t fileIndex)
+    {
+    return static_cast<size_t>(std::find(order.begin(), order.end(),
+        fileIndex) - order.begin());
+    }
+
+// Libraries 1 and 2 depend on each other. Library 0 uses 1, 2 uses 3, and
+// library 4 does not depend on any others.
+// Check that the clients are before the suppliers, that the cyclic group
+// is kept together, and that the order is stable.
+TEST_F(gFileDependencyOrderUnitTest, FileDependencyOrderCycleTest)
+    {
+    FileDependencies deps;
+    deps.addDependency(0, 1);
+    deps.addDependency(1, 2);
+    deps.addDependency(2, 1);
+    deps.addDependency(2, 3);
+    FileIndices order;
+    orderDependencies(5, deps, order);
+    EXPECT_EQ(order.size() == 5, true);
+    EXPECT_EQ(getPos(order, 0) < getPos(order, 1), true);
+    EXPECT_EQ(getPos(order, 0) < getPos(order, 2), true);
+    EXPECT_EQ(getPos(order, 1) < getPos(order, 3), true);
+    EXPECT_EQ(getPos(order, 2) < getPos(order, 3), true);
+    size_t pos1 = getPos(order, 1);
+    size_t pos2 = getPos(order, 2);
+    EXPECT_EQ(std::max(pos1, pos2) - std::min(pos1, pos2) == 1, true);
+    FileIndices expectedOrder = { 4, 0, 2, 1, 3 };
+    EXPECT_EQ(order == expectedOrder, true);
+    }
+
+// Every library is in a single cycle, and library 3 uses the cycle.
+TEST_F(gFileDependencyOrderUnitTest, FileDependencyOrderAllCycleTest)
+    {
+    FileDependencies deps;
+    deps.addDependency(0, 1);
+    deps.addDependency(1, 2);
+    deps.addDependency(2, 0);
+    deps.addDependency(3, 2);
+    FileIndices order;
+    orderDependencies(4, deps, order);
+    FileIndices expectedOrder = { 3, 2, 1, 0 };
+    EXPECT_EQ(order == expectedOrder, true);
+    }
@@ -0,0 +1,76 @@
+// TestGraphReachability.cpp
+
+#include "TestCpp.h"
+#include "../../oovaide/BLL/GraphReachability.h"
+
+class GraphReachabilityUnitTest:public TestCppModule
+    {
+    public:
+        GraphReachabilityUnitTest():
+            TestCppModule("GraphReachability")
+            {}
+    };
+
+static GraphReachabilityUnitTest gGraphReachabilityUnitTest;
+
+// A diamond where 0 uses 1 and 2, which both use 3, and 0 also uses 3.
+// Check that only the edge from 0 to 3 is implied.
+TEST_F(gGraphReachabilityUnitTest, GraphReachabilityDagTest)
+    {
+    std::vector<GraphEdge> edges = { GraphEdge(0, 1), GraphEdge(0, 2),
+        GraphEdge(1, 3), GraphEdge(2, 3), GraphEdge(0, 3) };
+    GraphReachability reach;
+    reach.build(5, edges);
+    EXPECT_EQ(reach.isReachable(0, 3), true);
+    EXPECT_EQ(reach.isReachable(1, 3), true);
+    EXPECT_EQ(reach.isReachable(3, 0), false);
+    EXPECT_EQ(reach.isReachable(1, 2), false);
+    EXPECT_EQ(reach.isReachable(0, 4), false);
+    EXPECT_EQ(reach.isReachable(4, 4), true);
+    EXPECT_EQ(reach.isImpliedEdge(0, 3), true);
+    EXPECT_EQ(reach.isImpliedEdge(0, 1), false);
+    EXPECT_EQ(reach.isImpliedEdge(0, 2), false);
+    EXPECT_EQ(reach.isImpliedEdge(1, 3), false);
+    }
+
+// A cycle of 1, 2 and 3, that is used by 0 and uses 4.
+// Check that the nodes in the cycle reach each other, and that the edges
+// in the cycle are not implied.
+TEST_F(gGraphReachabilityUnitTest, GraphReachabilityCycleTest)
+    {
+    std::vector<GraphEdge> edges = { GraphEdge(0, 1), GraphEdge(1, 2),
+        GraphEdge(2, 3), GraphEdge(3, 1), GraphEdge(3, 4), GraphEdge(0, 4) };
+    GraphReachability reach;
+    reach.build(5, edges);
+    EXPECT_EQ(reach.isReachable(1, 3), true);
+    EXPECT_EQ(reach.isReachable(3, 2), true);
+    EXPECT_EQ(reach.isReachable(0, 4), true);
+    EXPECT_EQ(reach.isReachable(4, 1), false);
+    EXPECT_EQ(reach.isReachable(1, 0), false);
+    EXPECT_EQ(reach.isImpliedEdge(1, 2), false);
+    EXPECT_EQ(reach.isImpliedEdge(3, 1), false);
+    EXPECT_EQ(reach.isImpliedEdge(0, 4), true);
+    EXPECT_EQ(reach.isImpliedEdge(3, 4), false);
+    }
+
+// A long chain where each node uses the next node.
+// Check that the search does not use recursion deep enough to overflow the
+// stack, and that only the edges that skip nodes are implied.
+TEST_F(gGraphReachabilityUnitTest, GraphReachabilityChainTest)
+    {
+    const size_t numNodes = 5000;
+    std::vector<GraphEdge> edges;
+    for(size_t i=0; i<numNodes-1; i++)
+        {
+        edges.push_back(GraphEdge(i, i+1));
+        }
+    edges.push_back(GraphEdge(0, numNodes-1));
+    GraphReachability reach;
+    reach.build(numNodes, edges);
+    EXPECT_EQ(reach.isReachable(0, numNodes-1), true);
+    EXPECT_EQ(reach.isReachable(numNodes-1, 0), false);
+    EXPECT_EQ(reach.isReachable(100, 200), true);
+    EXPECT_EQ(reach.isImpliedEdge(0, numNodes-1), true);
+    EXPECT_EQ(reach.isImpliedEdge(0, 1), false);
+    EXPECT_EQ(reach.isImpliedEdge(numNodes-2, numNodes-1), false);
+    }
@@ -0,0 +1,118 @@
+// TestIncludeMap.cpp
+
+#include "TestCpp.h"
+#include "../../oovCommon/IncludeMap.h"
+#include "../../oovCommon/FilePath.h"
+#include <stdio.h>
+#include <utime.h>
+#include <algorithm>
+
+class IncludeMapUnitTest:public TestCppModule
+    {
+    public:
+        IncludeMapUnitTest():
+            TestCppModule("IncludeMap")
+            {}
+    };
+
+static IncludeMapUnitTest gIncludeMapUnitTest;
+
+// Adds an includer to the map. The included files are pairs of the include
+// directory and the included file name.
+static void addIncluder(IncDirDependencyMapReader &incMap,
+        OovStringRef const includer, OovStringVec const &incPaths)
+    {
+    OovString val = "1;1";
+    for(auto const &incPath : incPaths)
+        {
+        val += ';';
+        val += incPath;
+        }
+    incMap.setNameValue(includer, val);
+    }
+
+static bool hasFile(OovStringVec const &files, OovStringRef const fn)
+    {
+    return(std::find(files.begin(), files.end(), fn.getStr()) != files.end());
+    }
+
+// A source includes x.h, which is in a cycle with y.h, and y.h includes z.h.
+// Check that every file in the cycle has the nested files of the cycle, and
+// that the cycle does not cause infinite recursion.
+TEST_F(gIncludeMapUnitTest, IncDirClosureCycleTest)
+    {
+    IncDirDependencyMapReader incMap;
+    addIncluder(incMap, "/p/a.cpp", { "/p/inc/", "x.h" });
+    addIncluder(incMap, "/p/inc/x.h", { "/p/inc/", "y.h" });
+    addIncluder(incMap, "/p/inc/y.h", { "/p/inc/", "x.h", "/p/other/", "z.h" });
+    IncDirDependencyClosure closure(incMap);
+
+    OovStringVec files;
+    closure.getNestedIncludeFiles("/p/a.cpp", files);
+    EXPECT_EQ(files.size() == 3, true);
+    EXPECT_EQ(hasFile(files, "/p/inc/x.h"), true);
+    EXPECT_EQ(hasFile(files, "/p/inc/y.h"), true);
+    EXPECT_EQ(hasFile(files, "/p/other/z.h"), true);
+
+    files.clear();
+    closure.getNestedIncludeFiles("/p/inc/y.h", files);
+    EXPECT_EQ(files.size() == 3, true);
+    EXPECT_EQ(hasFile(files, "/p/inc/y.h"), true);
+
+    files.clear();
+    closure.getNestedIncludeFiles("/p/other/z.h", files);
+    EXPECT_EQ(files.size() == 0, true);
+
+    OovStringVec dirs = closure.getNestedIncludeDirs("/p/inc/x.h");
+    EXPECT_EQ(dirs.size() == 2, true);
+    }
+
+static void writeFile(OovStringRef const fn, time_t fileTime)
+    {
+    FILE *fp = fopen(fn, "w");
+    if(fp)
+        {
+        fclose(fp);
+        }
+    struct utimbuf times;
+    times.actime = fileTime;
+    times.modtime = fileTime;
+    utime(fn, &times);
+    }
+
+// A source includes a header in one directory, which includes a header in
+// another directory. Check that the directory of the nested header is used,
+// and that the output is old when only the nested header changed.
+TEST_F(gIncludeMapUnitTest, IncDirClosureNestedDirTest)
+    {
+    OovStatus status = FileEnsurePathExists("TestIncMap/inc1/");
+    if(status.ok())
+        {
+        status = FileEnsurePathExists("TestIncMap/inc2/");
+        }
+    EXPECT_EQ(status.ok(), true);
+    time_t const oldTime = 1000000000;
+    writeFile("TestIncMap/a.cpp", oldTime);
+    writeFile("TestIncMap/inc1/b.h", oldTime);
+    writeFile("TestIncMap/inc2/c.h", oldTime);
+    writeFile("TestIncMap/a.o", oldTime + 10);
+
+    IncDirDependencyMapReader incMap;
+    addIncluder(incMap, "TestIncMap/a.cpp", { "TestIncMap/inc1/", "b.h" });
+    addIncluder(incMap, "TestIncMap/inc1/b.h", { "TestIncMap/inc2/", "c.h" });
+    IncDirDependencyClosure closure(incMap);
+    OovStringVec dirs = closure.getNestedIncludeDirs("TestIncMap/a.cpp");
+    EXPECT_EQ(dirs.size() == 2, true);
+    EXPECT_EQ(hasFile(dirs, "TestIncMap/inc2/"), true);
+    OovString newestFn;
+    EXPECT_EQ(closure.isOutputOld("TestIncMap/a.o", "TestIncMap/a.cpp",
+        newestFn), false);
+
+    // The closure only reads the file times once, so a new closure is
+    // needed for each build.
+    writeFile("TestIncMap/inc2/c.h", oldTime + 20);
+    IncDirDependencyClosure changedClosure(incMap);
+    EXPECT_EQ(changedClosure.isOutputOld("TestIncMap/a.o", "TestIncMap/a.cpp",
+        newestFn), true);
+    EXPECT_EQ(newestFn == "TestIncMap/inc2/c.h", true);
+    }
@@ -0,0 +1,106 @@
+// TestPrecompiledHeaders.cpp
+
+#include "TestCpp.h"
+#include "../../oovCppParser/PrecompiledHeaders.h"
+#include <stdio.h>
+
+class PrecompiledHeadersUnitTest:public TestCppModule
+    {
+    public:
+        PrecompiledHeadersUnitTest():
+            TestCppModule("PrecompiledHeaders")
+            {}
+    };
+
+static PrecompiledHeadersUnitTest gPrecompiledHeadersUnitTest;
+
+static OovStringVec getIncludes(char const *text)
+    {
+    char const *fn = "TestPchLeadingIncludes.h";
+    FILE *fp = fopen(fn, "w");
+    if(fp)
+        {
+        fputs(text, fp);
+        fclose(fp);
+        }
+    OovStringVec includes = PrecompiledHeaders::getLeadingIncludes(fn);
+    remove(fn);
+    return includes;
+    }
+
+// A header with an include guard. The local include stops the leading
+// includes.
+TEST_F(gPrecompiledHeadersUnitTest, PchLeadingIncludesGuardTest)
+    {
+    OovStringVec includes = getIncludes(
+        "#ifndef TEST_H\n"
+        "#define TEST_H\n"
+        "#include <vector>\n"
+        "# include <string>\n"
+        "#include \"local.h\"\n"
+        "#include <map>\n");
+    EXPECT_EQ(includes.size() == 2, true);
+    if(includes.size() == 2)
+        {
+        EXPECT_EQ(includes[0] == "<vector>", true);
+        EXPECT_EQ(includes[1] == "<string>", true);
+        }
+
+    // The includes are not used if the guard is not defined.
+    includes = getIncludes(
+        "#ifndef TEST_H\n"
+        "#include <vector>\n");
+    EXPECT_EQ(includes.size() == 0, true);
+
+    // The includes are not used if something else is defined.
+    includes = getIncludes(
+        "#ifndef TEST_H\n"
+        "#define OTHER\n"
+        "#include <vector>\n");
+    EXPECT_EQ(includes.size() == 0, true);
+
+    // A define after the includes stops the leading includes.
+    includes = getIncludes(
+        "#pragma once\n"
+        "#include <vector>\n"
+        "#define VAL 1\n"
+        "#include <string>\n");
+    EXPECT_EQ(includes.size() == 1, true);
+    }
+
+// Comments can be before or between the includes, but code in the same
+// line as a comment stops the leading includes.
+TEST_F(gPrecompiledHeadersUnitTest, PchLeadingIncludesCommentTest)
+    {
+    OovStringVec includes = getIncludes(
+        "/*\n"
+        " * Test.cpp\n"
+        " */\n"
+        "// A comment\n"
+        "\n"
+        "#include <vector>\n"
+        "/* A comment */\n"
+        "#include <string>\n"
+        "/* A comment */ int val;\n"
+        "#include <map>\n");
+    EXPECT_EQ(includes.size() == 2, true);
+
+    includes = getIncludes(
+        "/* A comment\n"
+        "  */ int val;\n"
+        "#include <vector>\n");
+    EXPECT_EQ(includes.size() == 0, true);
+    }
+
+// Lines that are longer than the read buffer must not be parsed as
+// multiple lines.
+TEST_F(gPrecompiledHeadersUnitTest, PchLeadingIncludesLongLineTest)
+    {
+    std::string text = "// ";
+    text.append(3000, 'x');
+    text += "\n#include <vector>\n/* ";
+    text.append(3000, 'y');
+    text += " */\n#include <string>\n";
+    OovStringVec includes = getIncludes(text.c_str());
+    EXPECT_EQ(includes.size() == 2, true);
+    }
@@ -4,6 +4,8 @@
 #include "../../oovCommon/OovThreadedBackgroundQueue.h"
 #include "../../oovCommon/OovThreadedWaitQueue.h"
 #include "../../oovCommon/OovProcess.h"     // For sleepMs
+#include <atomic>
+#include <string>
 
 class WaitQueueUnitTest:public TestCppModule
     {
@@ -93,6 +95,132 @@ TEST_F(gWaitQueueUnitTest, WaitThreadQueueEmptyTest)
     }
 
 
+class ThroughputWaitQueue:public ThreadedWorkWaitQueue<std::string,
+    class ThroughputWaitQueue>
+    {
+    public:
+        ThroughputWaitQueue():
+            mNumProcessed(0)
+            {}
+        bool processItem(std::string const &item)
+            {
+            mNumProcessed += (item.length() > 0);
+            return true;
+            }
+        std::atomic<int> mNumProcessed;
+    };
+
+static const int NumThroughputItems = 200000;
+static const int NumThroughputThreads = 4;
+
+// Returns the seconds to move the items through the list based queue
+// using the same threading as ThreadedWorkWaitQueue.
+static double listQueueThroughput(int &numProcessed)
+    {
+    OovThreadedWaitQueue<std::string> queue;
+    std::atomic<int> numPopped(0);
+    std::vector<std::thread> threads;
+    TestTime startTime;
+    startTime.getCurrentTime();
+    queue.initThreadSafeQueue();
+    for(int i=0; i<NumThroughputThreads; i++)
+        {
+        threads.push_back(std::thread([&queue, &numPopped]
+            {
+            std::string item;
+            while(queue.waitPop(item))
+                {
+                numPopped += (item.length() > 0);
+                }
+            }));
+        }
+    for(int i=0; i<NumThroughputItems; i++)
+        {
+        queue.waitPush("some/path/to/a/source/file.cpp");
+        }
+    queue.quitPops();
+    ThreadedWorkWaitPrivate::joinThreads(threads);
+    TestTime endTime;
+    endTime.getCurrentTime();
+    numProcessed = numPopped;
+    return endTime.elapsedSecondsSinceStart(startTime);
+    }
+
+// Returns the seconds to move the items through the ThreadedWorkWaitQueue.
+static double boundedQueueThroughput(size_t popBatchSize, int &numProcessed)
+    {
+    ThroughputWaitQueue queue;
+    TestTime startTime;
+    startTime.getCurrentTime();
+    queue.setupQueue(NumThroughputThreads, popBatchSize);
+    for(int i=0; i<NumThroughputItems; i++)
+        {
+        queue.addTask(std::string("some/path/to/a/source/file.cpp"));
+        }
+    queue.waitForCompletion();
+    TestTime endTime;
+    endTime.getCurrentTime();
+    numProcessed = queue.mNumProcessed;
+    return endTime.elapsedSecondsSinceStart(startTime);
+    }
+
+// Compare the enqueue/dequeue throughput of the list based queue to the
+// bounded queue that is used by ThreadedWorkWaitQueue. The times are
+// written to the diagnostics, and all items must be processed.
+TEST_F(gWaitQueueUnitTest, WaitThreadQueueThroughputTest)
+    {
+    int numProcessed = 0;
+    double listTime = listQueueThroughput(numProcessed);
+    EXPECT_EQ(numProcessed, NumThroughputItems);
+    double boundedTime = boundedQueueThroughput(1, numProcessed);
+    EXPECT_EQ(numProcessed, NumThroughputItems);
+    double batchTime = boundedQueueThroughput(16, numProcessed);
+    EXPECT_EQ(numProcessed, NumThroughputItems);
+    func.mParentModule.addExtraDiagnostics("List queue items/sec",
+        NumThroughputItems / listTime);
+    func.mParentModule.addExtraDiagnostics("Bounded queue items/sec",
+        NumThroughputItems / boundedTime);
+    func.mParentModule.addExtraDiagnostics("Bounded batch queue items/sec",
+        NumThroughputItems / batchTime);
+    }
+
+
+static void otherItemsWaitProc(OovBoundedWaitQueue<int> *queue,
+    std::atomic<size_t> const *otherItems, bool *gotItems,
+    std::atomic<bool> *waitDone)
+    {
+    std::vector<int> items;
+    *gotItems = queue->waitPopBatch(items, 8, otherItems);
+    *waitDone = true;
+    }
+
+// A worker waiting for a batch must stop waiting when another worker lists
+// items that can be taken, even though nothing is pushed onto the queue.
+TEST_F(gWaitQueueUnitTest, WaitThreadQueueOtherItemsTest)
+    {
+    OovBoundedWaitQueue<int> queue;
+    std::atomic<size_t> otherItems(0);
+    std::atomic<bool> waitDone(false);
+    bool gotItems = true;
+    std::thread worker(otherItemsWaitProc, &queue, &otherItems, &gotItems,
+        &waitDone);
+    sleepMs(100);
+    bool waitedForItems = !waitDone;
+    otherItems++;
+    queue.notifyOtherItems();
+    for(int i=0; i<50 && !waitDone; i++)
+        {
+        sleepMs(10);
+        }
+    bool stoppedWaiting = waitDone;
+    queue.quitPops();
+    worker.join();
+    EXPECT_EQ(waitedForItems, true);
+    EXPECT_EQ(stoppedWaiting, true);
+    EXPECT_EQ(gotItems, false);
+    EXPECT_EQ(queue.isQuitting(), true);
+    }
+
 class ThreadedBackgroundQueue:public ThreadedWorkBackgroundQueue<
     class ThreadedBackgroundQueue, int>
     {
@@ -141,3 +269,95 @@ TEST_F(gBackgroundQueueUnitTest, BackgroundThreadQueueStopTest)
     EXPECT_EQ(queue.isQueueBusy(), false);
     EXPECT_EQ(queue.mItems[0] + queue.mItems[1] == 1, true);
     }
+
+// Wait for completion with a timeout that is too short, and then wait for
+// completion without stopping. Check that the wait returns as soon as the
+// items are processed instead of polling.
+TEST_F(gBackgroundQueueUnitTest, BackgroundThreadQueueWaitTest)
+    {
+    ThreadedBackgroundQueue queue;
+
+    queue.addTask(0);
+    queue.addTask(1);
+    EXPECT_EQ(queue.waitForCompletion(50), false);
+    TestTime startTime;
+    startTime.getCurrentTime();
+    EXPECT_EQ(queue.waitForCompletion(), true);
+    TestTime endTime;
+    endTime.getCurrentTime();
+    EXPECT_EQ(queue.mItems[0] == 1, true);
+    EXPECT_EQ(queue.mItems[1] == 1, true);
+    // The items take 500 ms, and 50 ms of it is already done.
+    EXPECT_EQ(endTime.elapsedSecondsSinceStart(startTime) < 0.5, true);
+    EXPECT_EQ(queue.isQueueBusy(), false);
+    queue.addTask(2);
+    sleepMs(50);    // Wait for the task to get started.
+    EXPECT_EQ(queue.stopAndWaitForCompletion(50), false);
+    EXPECT_EQ(queue.stopAndWaitForCompletion(1000), true);
+    EXPECT_EQ(queue.mItems[2] == 1, true);
+    }
+
+class CancelBackgroundQueue:public ThreadedWorkBackgroundQueue<
+    class CancelBackgroundQueue, int>
+    {
+    public:
+        CancelBackgroundQueue(int uncheckedMs=200):
+            mProcessed{0}, mCancelled{false}, mUncheckedMs(uncheckedMs)
+            {}
+        void processItem(int item)
+            {
+            sleepMs(mUncheckedMs);  // Work that does not check for cancel.
+            for(int i=0; i<100 && continueProcessingItem(); i++)
+                {
+                sleepMs(10);
+                }
+            mCancelled[item] = !continueProcessingItem();
+            mProcessed[item]++;
+            }
+        int mProcessed[3];
+        bool mCancelled[3];
+        int mUncheckedMs;
+    };
+
+// Stop with a timeout while an item is running, and then add an item.
+// Check that the item that was running stays cancelled, and that the new
+// item is processed without being cancelled.
+TEST_F(gBackgroundQueueUnitTest, BackgroundThreadQueueCancelAddTest)
+    {
+    CancelBackgroundQueue queue;
+
+    queue.addTask(0);
+    sleepMs(50);    // Wait for the task to get started.
+    EXPECT_EQ(queue.stopAndWaitForCompletion(10), false);
+    queue.addTask(1);
+    EXPECT_EQ(queue.waitForCompletion(), true);
+    EXPECT_EQ(queue.mProcessed[0] == 1, true);
+    EXPECT_EQ(queue.mCancelled[0] == true, true);
+    EXPECT_EQ(queue.mProcessed[1] == 1, true);
+    EXPECT_EQ(queue.mCancelled[1] == false, true);
+    queue.stopAndWaitForCompletion();
+    }
+
+// Stop with a timeout while an item is running and other items are queued.
+// Check that the stop does not wait for the running item, and that the
+// queued items are not processed.
+TEST_F(gBackgroundQueueUnitTest, BackgroundThreadQueueStopTimeoutTest)
+    {
+    CancelBackgroundQueue queue(1000);
+
+    queue.addTask(0);
+    queue.addTask(1);
+    queue.addTask(2);
+    sleepMs(50);    // Wait for the first task to get started.
+    TestTime startTime;
+    startTime.getCurrentTime();
+    EXPECT_EQ(queue.stopAndWaitForCompletion(10), false);
+    TestTime endTime;
+    endTime.getCurrentTime();
+    EXPECT_EQ(endTime.elapsedSecondsSinceStart(startTime) < 0.5, true);
+    EXPECT_EQ(queue.stopAndWaitForCompletion(-1), true);
+    EXPECT_EQ(queue.mProcessed[0] == 1, true);
+    EXPECT_EQ(queue.mCancelled[0] == true, true);
+    EXPECT_EQ(queue.mProcessed[1] == 0, true);
+    EXPECT_EQ(queue.mProcessed[2] == 0, true);
+    }